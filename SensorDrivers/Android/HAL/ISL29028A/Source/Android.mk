@@ -7,14 +7,68 @@ LOCAL_PRELINK_MODULE := false
 
 LOCAL_MODULE_PATH := $(TARGET_OUT_SHARED_LIBRARIES)/hw
 
+# evdev events buffered per input node, must be a power of two
+LOCAL_CFLAGS += -DINPUT_EVENT_RING_SIZE=64
+
+# 1 to read each input node on a reader thread feeding a lock-free queue
+LOCAL_CFLAGS += -DSENSORS_READER_THREADS=0
+
+# 1 to timestamp events in CLOCK_BOOTTIME instead of CLOCK_MONOTONIC
+LOCAL_CFLAGS += -DSENSORS_CLOCK_BOOTTIME=0
+
+# 0 to build without the runtime counters of SensorMetrics
+LOCAL_CFLAGS += -DSENSORS_METRICS=1
+
+# 1 to record the raw input events into a capture file, e.g. on dogfood
+LOCAL_CFLAGS += -DSENSORS_CAPTURE=0
+
+# input device names of the parts fitted on the board, e.g.
+# "isl29028A rgbsensor_isl29124_f". Their sensors are listed even when
+# the driver probes after the HAL is opened. Empty lists every part whose
+# input device exists when the framework first asks.
+ISL_SENSORS_PARTS ?= isl29028A
+LOCAL_CFLAGS += -DSENSORS_PARTS=\"$(ISL_SENSORS_PARTS)\"
+
 # include any shared library dependencies
 LOCAL_SHARED_LIBRARIES := liblog libcutils libdl
 
 LOCAL_SRC_FILES := \
 			sensors.cpp \
 		 	SensorBase.cpp \
+			SensorInputDevice.cpp \
+			SensorEventFifo.cpp \
+			SensorEventQueue.cpp \
+			SensorReader.cpp \
+			SensorMetrics.cpp \
+			SensorCapture.cpp \
+			DirectChannel.cpp \
+			SysfsAttribute.cpp \
+			SensorParts.cpp \
 			ProximitySensor.cpp \
+			RgbSensor.cpp \
 			InputEventReader.cpp \
+			InputDeviceIndex.cpp \
 			LightSensor.cpp
 
+# kept for the host build below
+isl_sensors_src_files := $(LOCAL_SRC_FILES)
+isl_sensors_cflags := $(LOCAL_CFLAGS)
+
 include $(BUILD_SHARED_LIBRARY)
+
+# The same HAL for the build host, linked into the tools under tools/.
+# Driver attributes are written to plain files under SENSORS_SYSFS_ROOT.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libsensors_isl_host
+
+LOCAL_CFLAGS := $(isl_sensors_cflags)
+LOCAL_CFLAGS += -DSENSORS_SYSFS_ROOT=\"/tmp/isl_sysfs\"
+
+LOCAL_C_INCLUDES := hardware/libhardware/include
+
+LOCAL_SRC_FILES := $(isl_sensors_src_files)
+
+include $(BUILD_HOST_STATIC_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -0,0 +1,98 @@
+/* File         : DirectChannel.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <cutils/log.h>
+#include <cutils/native_handle.h>
+
+#include "DirectChannel.h"
+
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+
+/*****************************************************************************/
+
+DirectChannel::DirectChannel()
+: mRing(NULL),
+	mSize(0),
+	mMapSize(0),
+	mWritePos(0),
+	mCounter(1)
+{
+}
+
+DirectChannel::~DirectChannel()
+{
+	if (mRing)
+		munmap(mRing, mMapSize);
+}
+
+int DirectChannel::map(const struct sensors_direct_mem_t* mem)
+{
+	void* addr;
+
+	if (mem->type != SENSOR_DIRECT_MEM_TYPE_ASHMEM ||
+			mem->format != SENSOR_DIRECT_FMT_SENSORS_EVENT ||
+			mem->size < sizeof(sensors_event_t) ||
+			!mem->handle || mem->handle->numFds < 1)
+		return -EINVAL;
+
+	addr = mmap(NULL, mem->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			mem->handle->data[0], 0);
+	if (addr == MAP_FAILED) {
+		ALOGE("Couldn't map direct channel (%s)", strerror(errno));
+		return -errno;
+	}
+
+	mRing = (sensors_event_t*)addr;
+	mMapSize = mem->size;
+	mSize = mem->size / sizeof(sensors_event_t);
+	return 0;
+}
+
+void DirectChannel::write(const sensors_event_t* events, int count,
+		int32_t token)
+{
+	if (!mRing)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		sensors_event_t* const slot = &mRing[mWritePos];
+
+		/* everything but the counter, then the counter once it is all out */
+		memcpy(slot, &events[i], offsetof(sensors_event_t, reserved0));
+		memcpy(&slot->timestamp, &events[i].timestamp,
+				sizeof(sensors_event_t) -
+				offsetof(sensors_event_t, timestamp));
+		slot->sensor = token;
+		__sync_synchronize();
+		slot->reserved0 = mCounter++;
+		__sync_synchronize();
+
+		if (++mWritePos >= mSize)
+			mWritePos = 0;
+		/* zero tells the reader a slot was never written */
+		if (!mCounter)
+			mCounter = 1;
+	}
+}
+
+#endif  // SENSORS_DEVICE_API_VERSION_1_4
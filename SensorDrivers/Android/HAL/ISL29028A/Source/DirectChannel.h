@@ -0,0 +1,62 @@
+/* File         : DirectChannel.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_DIRECT_CHANNEL_H
+#define ANDROID_DIRECT_CHANNEL_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <hardware/sensors.h>
+
+/*****************************************************************************/
+
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+
+/*
+ * A direct report channel in a client supplied ashmem region.
+ *
+ * The region is used as a ring of sensors_event_t. Each slot is written
+ * with reserved0 last, set to a counter that starts at 1, so the client
+ * reads a slot only once its counter moves on; no lock is shared with
+ * the reader and no framework wakeup is involved.
+ */
+class DirectChannel
+{
+	sensors_event_t* mRing;
+	size_t mSize;
+	size_t mMapSize;
+	size_t mWritePos;
+	int32_t mCounter;
+
+	public:
+	DirectChannel();
+	~DirectChannel();
+
+	int map(const struct sensors_direct_mem_t* mem);
+	bool isMapped() const { return mRing != NULL; }
+
+	void write(const sensors_event_t* events, int count, int32_t token);
+};
+
+#endif  // SENSORS_DEVICE_API_VERSION_1_4
+
+/*****************************************************************************/
+
+#endif  // ANDROID_DIRECT_CHANNEL_H
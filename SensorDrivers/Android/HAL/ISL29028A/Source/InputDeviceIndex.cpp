@@ -0,0 +1,118 @@
+/* File         : InputDeviceIndex.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include <cutils/log.h>
+
+#include "InputDeviceIndex.h"
+
+#define INPUT_CLASS_PATH		"/sys/class/input"
+
+/*****************************************************************************/
+
+InputDeviceIndex::InputDeviceIndex()
+: mNumEntries(0),
+	mValid(false)
+{
+	pthread_mutex_init(&mLock, NULL);
+}
+
+InputDeviceIndex::~InputDeviceIndex() {
+	pthread_mutex_destroy(&mLock);
+}
+
+InputDeviceIndex& InputDeviceIndex::get()
+{
+	static InputDeviceIndex sIndex;
+	return sIndex;
+}
+
+void InputDeviceIndex::scan()
+{
+	DIR *dir;
+	struct dirent *de;
+
+	mNumEntries = 0;
+	dir = opendir(INPUT_CLASS_PATH);
+	if (dir == NULL) {
+		ALOGE("couldn't open %s (%s)", INPUT_CLASS_PATH, strerror(errno));
+		return;
+	}
+
+	while ((de = readdir(dir)) && mNumEntries < MAX_DEVICES) {
+		Entry& entry = mEntries[mNumEntries];
+		char path[PATH_MAX];
+		ssize_t n;
+		int fd;
+
+		if (strncmp(de->d_name, "event", 5) ||
+				strlen(de->d_name) >= sizeof(entry.node))
+			continue;
+
+		snprintf(path, sizeof(path), INPUT_CLASS_PATH "/%s/device/name",
+				de->d_name);
+		fd = open(path, O_RDONLY);
+		if (fd < 0)
+			continue;
+		n = read(fd, entry.name, sizeof(entry.name) - 1);
+		close(fd);
+		if (n <= 0)
+			continue;
+
+		/* sysfs terminates the name with a newline */
+		if (entry.name[n - 1] == '\n')
+			n--;
+		entry.name[n] = '\0';
+		strcpy(entry.node, de->d_name);
+		mNumEntries++;
+	}
+
+	closedir(dir);
+	mValid = true;
+}
+
+int InputDeviceIndex::find(const char* inputName, char* node, size_t size)
+{
+	int err = -ENOENT;
+
+	pthread_mutex_lock(&mLock);
+	if (!mValid)
+		scan();
+	for (int i = 0; i < mNumEntries; i++) {
+		if (!strcmp(mEntries[i].name, inputName)) {
+			if (strlcpy(node, mEntries[i].node, size) < size)
+				err = 0;
+			else
+				err = -ENAMETOOLONG;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mLock);
+	return err;
+}
+
+void InputDeviceIndex::invalidate()
+{
+	pthread_mutex_lock(&mLock);
+	mValid = false;
+	pthread_mutex_unlock(&mLock);
+}
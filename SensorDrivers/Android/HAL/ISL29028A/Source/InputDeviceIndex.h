@@ -0,0 +1,71 @@
+/* File         : InputDeviceIndex.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_INPUT_DEVICE_INDEX_H
+#define ANDROID_INPUT_DEVICE_INDEX_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+/*****************************************************************************/
+
+/*
+ * Name to event node map of the input devices on the board.
+ *
+ * Built in one pass over /sys/class/input/eventN/device/name, so no
+ * input node is opened to find a sensor. The index is shared by every
+ * SensorBase and built on the first lookup; invalidate() drops it so the
+ * next lookup rescans, e.g. after a device was added or removed.
+ */
+class InputDeviceIndex
+{
+	enum {
+		MAX_DEVICES = 32,
+		NAME_SIZE = 80,
+		NODE_SIZE = 16,
+	};
+
+	struct Entry {
+		char name[NAME_SIZE];
+		char node[NODE_SIZE];
+	};
+
+	Entry mEntries[MAX_DEVICES];
+	int mNumEntries;
+	bool mValid;
+	pthread_mutex_t mLock;
+
+	void scan();
+
+	public:
+	InputDeviceIndex();
+	~InputDeviceIndex();
+
+	static InputDeviceIndex& get();
+
+	/* copies the event node (e.g. "event3") of inputName into node */
+	int find(const char* inputName, char* node, size_t size);
+	void invalidate();
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_INPUT_DEVICE_INDEX_H
@@ -33,58 +33,66 @@
 
 /*****************************************************************************/
 
-struct input_event;
-
-InputEventCircularReader::InputEventCircularReader(size_t numEvents)
-: mBuffer(new input_event[numEvents * 2]),
-	mBufferEnd(mBuffer + numEvents),
-	mHead(mBuffer),
-	mCurr(mBuffer),
-	mFreeSpace(numEvents)
+InputEventCircularReader::InputEventCircularReader()
+: mHead(0),
+	mTail(0)
 {
 }
 
 InputEventCircularReader::~InputEventCircularReader()
 {
-	delete [] mBuffer;
 }
 
+/*
+ * Reads as many events as fit in the contiguous free span with a single
+ * read(). Returns the number of events read or a negative errno.
+ */
 ssize_t InputEventCircularReader::fill(int fd)
 {
-	size_t numEventsRead = 0;
-	if (mFreeSpace) {
-		const ssize_t nread = read(fd, mHead, mFreeSpace * sizeof(input_event));
-		if (nread<0 || nread % sizeof(input_event)) {
-			// we got a partial event!!
-			return nread<0 ? -errno : -EINVAL;
-		}
-
-		numEventsRead = nread / sizeof(input_event);
-		if (numEventsRead) {
-			mHead += numEventsRead;
-			mFreeSpace -= numEventsRead;
-			if (mHead > mBufferEnd) {
-				size_t s = mHead - mBufferEnd;
-				memcpy(mBuffer, mBufferEnd, s * sizeof(input_event));
-				mHead = mBuffer + s;
-			}
-		}
+	if (mHead == mTail)
+		mHead = mTail = 0;
+
+	size_t freeSpace = SIZE - (mHead - mTail);
+	if (!freeSpace)
+		return 0;
+
+	size_t head = mHead & MASK;
+	size_t span = SIZE - head;
+	if (span > freeSpace)
+		span = freeSpace;
+
+	const ssize_t nread = read(fd, &mBuffer[head], span * sizeof(input_event));
+	if (nread<0 && errno == EAGAIN) {
+		// non-blocking node with nothing queued
+		return 0;
+	}
+	if (nread<0 || nread % sizeof(input_event)) {
+		// we got a partial event!!
+		return nread<0 ? -errno : -EINVAL;
 	}
+
+	size_t numEventsRead = nread / sizeof(input_event);
+	mHead += numEventsRead;
 	return numEventsRead;
 }
 
-ssize_t InputEventCircularReader::readEvent(input_event const** events)
+/*
+ * Points events at the oldest unread event and returns how many events
+ * follow it contiguously in the buffer. A second call after consume()
+ * returns the part that wrapped around, if any.
+ */
+ssize_t InputEventCircularReader::readEvents(input_event const** events)
 {
-	*events = mCurr;
-	ssize_t available = (mBufferEnd - mBuffer) - mFreeSpace;
-	return available ? 1 : 0;
+	size_t tail = mTail & MASK;
+	size_t available = mHead - mTail;
+
+	if (available > SIZE - tail)
+		available = SIZE - tail;
+	*events = &mBuffer[tail];
+	return available;
 }
 
-void InputEventCircularReader::next()
+void InputEventCircularReader::consume(size_t count)
 {
-	mCurr++;
-	mFreeSpace++;
-	if (mCurr >= mBufferEnd) {
-		mCurr = mBuffer;
-	}
+	mTail += count;
 }
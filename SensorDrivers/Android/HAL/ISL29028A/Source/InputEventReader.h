@@ -23,24 +23,41 @@
 #include <sys/cdefs.h>
 #include <sys/types.h>
 
+#include <linux/input.h>
+
 /*****************************************************************************/
 
-struct input_event;
+/* Number of events buffered per input node, must be a power of two */
+#ifndef INPUT_EVENT_RING_SIZE
+#define INPUT_EVENT_RING_SIZE		64
+#endif
 
+/*
+ * mHead and mTail are free running counters, so the fill level is always
+ * mHead - mTail and a slot is found by masking. Both are rewound to zero
+ * whenever the ring runs empty, so the usual read-everything-then-drain
+ * cycle never wraps and fill() gets the whole buffer for one read().
+ */
 class InputEventCircularReader
 {
-	struct input_event* const mBuffer;
-	struct input_event* const mBufferEnd;
-	struct input_event* mHead;
-	struct input_event* mCurr;
-	ssize_t mFreeSpace;
+	enum {
+		SIZE = INPUT_EVENT_RING_SIZE,
+		MASK = SIZE - 1,
+	};
+	typedef char ring_size_must_be_a_power_of_two[(SIZE & MASK) ? -1 : 1];
+
+	struct input_event mBuffer[SIZE];
+	size_t mHead;
+	size_t mTail;
 
 	public:
-	InputEventCircularReader(size_t numEvents);
+	InputEventCircularReader();
 	~InputEventCircularReader();
 	ssize_t fill(int fd);
-	ssize_t readEvent(input_event const** events);
-	void next();
+	ssize_t readEvents(input_event const** events);
+	void consume(size_t count);
+	bool isEmpty() const { return mHead == mTail; }
+	void clear() { mHead = mTail = 0; }
 };
 
 /*****************************************************************************/
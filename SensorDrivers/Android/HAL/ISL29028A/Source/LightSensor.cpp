@@ -26,69 +26,28 @@
 
 #include "sensors.h"
 #include "LightSensor.h"
+#include "SensorMetrics.h"
 
-#define EVENT_TYPE_LIGHT		ABS_MISC
 /*****************************************************************************/
 
-enum input_device_name {
-	SENSOR_DEVICE,
-	SUPPORTED_LSENSOR_COUNT,
-};
-
-enum {
-	TYPE_ADC = 0,
-	TYPE_LUX,
-};
-
-static const char *data_device_name[] = {
-	[SENSOR_DEVICE]  = DEVICE_NAME				/* must be same as in register as sensor driver name */
-};
-
-static const char *input_sysfs_path_list[] = {
-	[SENSOR_DEVICE]  = "/sys/class/input/%s/device/"	/* Event generated path regarding the sensor driver */
-};
-
-static const char *input_sysfs_enable_list[] = {
-	[SENSOR_DEVICE]  = "enable"
-};
-
-static const int input_report_type[] = {
-	[SENSOR_DEVICE]  = TYPE_LUX
-};
-
-	LightSensor::LightSensor()
+	LightSensor::LightSensor(SensorInputDevice* input,
+		const struct isl_sensor_desc* desc, int handle)
 : SensorBase(NULL, NULL),
 	mEnabled(0),
-	mInputReader(4),
+	mInput(input),
+	mDesc(desc),
 	mHasPendingEvent(false),
-	sensor_index(-1)
+	mHasReported(false),
+	mReportedLight(0),
+	mReportedTimestamp(0)
 {
-	int i;
-	char *tok = NULL;
-
 	mPendingEvent.version = sizeof(sensors_event_t);
-	mPendingEvent.sensor = SENSORS_LIGHT_HANDLE;
+	mPendingEvent.sensor = handle;
 	mPendingEvent.type = SENSOR_TYPE_LIGHT;
 	memset(mPendingEvent.data, 0, sizeof(mPendingEvent.data));
 
-	for(i = 0; i < SUPPORTED_LSENSOR_COUNT; i++) {
-		data_name = data_device_name[i];
-
-		// data_fd is not initialized if data_name passed
-		// to SensorBase is NULL.
-		data_fd = openInput(data_name);
-		if (data_fd > 0) {
-			sensor_index = i;
-			break;
-		}
-	}
-
-	if (data_fd) {
-		snprintf(input_sysfs_path, sizeof(input_sysfs_path),
-				input_sysfs_path_list[i], input_name);
-		input_sysfs_path_len = strlen(input_sysfs_path);
-		enable(0, 1);
-	}
+	/* the node may only show up later, see SensorInputDevice::attach() */
+	input->addSensor(desc->ev_type, desc->ev_code, this);
 }
 
 LightSensor::~LightSensor() {
@@ -99,48 +58,26 @@ LightSensor::~LightSensor() {
 
 int LightSensor::setDelay(int32_t handle, int64_t ns)
 {
-	int fd;
-	strcpy(&input_sysfs_path[input_sysfs_path_len], "poll_delay");
-	fd = open(input_sysfs_path, O_RDWR);
-	if (fd >= 0) {
-		char buf[80];
-		sprintf(buf, "%lld", ns);
-		write(fd, buf, strlen(buf)+1);
-		close(fd);
-		return 0;
-	}
-	return -1;
+	/* the rate is shared with the proximity sensor on the same node */
+	return mInput->setSensorDelay(this, ns);
 }
 
 int LightSensor::enable(int32_t handle, int en)
 {
 	int flags = en ? 1 : 0;
 	if (flags != mEnabled) {
-		int fd;
-		if (sensor_index >= 0) {
-			strlcpy(&input_sysfs_path[input_sysfs_path_len],
-					input_sysfs_enable_list[sensor_index], sizeof(input_sysfs_path) - input_sysfs_path_len);
-		}
-		else
-			return -1;
 		/* sysfs path from where we can enable the sensor device driver */
-		fd = open(ALS_ENABLE_SYSPATH, O_RDWR);
-
-		if (fd >= 0) {
-			char buf[2];
-			int err;
-			buf[1] = 0;
-			if (flags) {
-				buf[0] = '1';
-			} else {
-				buf[0] = '0';
-			}
-			err = write(fd, buf, sizeof(buf));
-			close(fd);
-			mEnabled = flags;
-			return 0;
+		if (mDesc->enable_path) {
+			char path[PATH_MAX];
+			mInput->formatPath(mDesc->enable_path, path, sizeof(path));
+			mEnableAttr.setPath(path);
+			if (mEnableAttr.writeInt(flags) < 0)
+				return -1;
 		}
-		return -1;
+		mEnabled = flags;
+		/* the first sample after enabling always goes out */
+		mHasReported = false;
+		mInput->setSensorActive(this, flags);
 	}
 	return 0;
 }
@@ -156,59 +93,67 @@ int LightSensor::readEvents(sensors_event_t* data, int count)
 
 	if (mHasPendingEvent) {
 		mHasPendingEvent = false;
-		mPendingEvent.timestamp = getTimestamp();
 		*data = mPendingEvent;
 		return mEnabled ? 1 : 0;
 	}
 
-	ssize_t n = mInputReader.fill(data_fd);
-	if (n < 0)
-		return n;
-
-	int numEventReceived = 0;
-	input_event const* event;
-
-	while (count && mInputReader.readEvent(&event)) {
-		int type = event->type;
-		if (type == EV_ABS) {
-			if (event->code == EVENT_TYPE_LIGHT) {
-				mPendingEvent.light = convertEvent(event->value);
-			}
-		} else if (type == EV_SYN) {
-			mPendingEvent.timestamp = timevalToNano(event->time);
-			if (mEnabled) {
-				*data++ = mPendingEvent;
-				count--;
-				numEventReceived++;
-			}
-		} else {
-			ALOGE("LightSensor: unknown event (type=%d, code=%d)",
-					type, event->code);
-		}
-		mInputReader.next();
+	return 0;
+}
+
+void LightSensor::processEvent(int code, int value)
+{
+	if (code == mDesc->ev_code) {
+		mPendingEvent.light = convertEvent(value);
+	}
+}
+
+/* drops samples that barely moved or that come too soon after the last */
+bool LightSensor::isSignificant(int64_t timestamp) const
+{
+	if (!mHasReported)
+		return true;
+
+	if (timestamp - mReportedTimestamp <
+			int64_t(mDesc->min_interval_ms) * 1000000LL)
+		return false;
+
+	float delta = fabsf(mPendingEvent.light - mReportedLight);
+	return delta > mDesc->hyst_abs &&
+		delta > mDesc->hyst_rel * mReportedLight;
+}
+
+void LightSensor::syncEvent(int64_t timestamp)
+{
+	if (!mEnabled)
+		return;
+	if (!isSignificant(timestamp)) {
+		SensorMetrics::get().eventFiltered(mPendingEvent.sensor);
+		return;
 	}
 
-	return numEventReceived;
+	mPendingEvent.timestamp = timestamp;
+	mHasPendingEvent = true;
+	mHasReported = true;
+	mReportedLight = mPendingEvent.light;
+	mReportedTimestamp = timestamp;
 }
 
 float LightSensor::convertEvent(int value)
 {
 	float lux = 0;
 
-	if (sensor_index >= 0) {
-		if (input_report_type[sensor_index] == TYPE_ADC) {
-			// Convert adc value to lux assuming:
-			// I = 10 * log(Ev) uA
-			// R = 47kOhm
-			// Max adc value 4095 = 3.3V
-			// 1/4 of light reaches sensor
-			lux =  powf(10, value * (330.0f / 4095.0f / 47.0f)) * 4;
-		} else if (input_report_type[sensor_index] == TYPE_LUX) {
-			lux = value;
-		} else {
-			ALOGE("LightSensor: unknown report type\n");
-			lux = 0;
-		}
+	if (mDesc->report == ISL_REPORT_ADC) {
+		// Convert adc value to lux assuming:
+		// I = 10 * log(Ev) uA
+		// R = 47kOhm
+		// Max adc value 4095 = 3.3V
+		// 1/4 of light reaches sensor
+		lux =  powf(10, value * (330.0f / 4095.0f / 47.0f)) * 4;
+	} else if (mDesc->report == ISL_REPORT_LUX) {
+		lux = value * mDesc->scale;
+	} else {
+		ALOGE("LightSensor: unknown report type\n");
+		lux = 0;
 	}
 
 	return lux;
@@ -25,7 +25,9 @@
 #include <sys/types.h>
 
 #include "SensorBase.h"
-#include "InputEventReader.h"
+#include "SensorInputDevice.h"
+#include "SysfsAttribute.h"
+#include "SensorParts.h"
 
 /*****************************************************************************/
 
@@ -33,22 +35,31 @@ struct input_event;
 
 class LightSensor : public SensorBase {
 	int mEnabled;
-	InputEventCircularReader mInputReader;
+	SensorInputDevice* mInput;
+	const struct isl_sensor_desc* mDesc;
 	sensors_event_t mPendingEvent;
 	bool mHasPendingEvent;
-	char input_sysfs_path[PATH_MAX];
-	int input_sysfs_path_len;
-	int sensor_index;
+	SysfsAttribute mEnableAttr;
+
+	/* last value handed out, for the on-change filter */
+	bool mHasReported;
+	float mReportedLight;
+	int64_t mReportedTimestamp;
+
+	bool isSignificant(int64_t timestamp) const;
 
 	int setInitialState();
 
 	public:
-	LightSensor();
+	LightSensor(SensorInputDevice* input,
+			const struct isl_sensor_desc* desc, int handle);
 	virtual ~LightSensor();
 	virtual int readEvents(sensors_event_t* data, int count);
 	virtual bool hasPendingEvents() const;
 	virtual int setDelay(int32_t handle, int64_t ns);
 	virtual int enable(int32_t handle, int enabled);
+	virtual void processEvent(int code, int value);
+	virtual void syncEvent(int64_t timestamp);
 	virtual float convertEvent(int value);
 };
 
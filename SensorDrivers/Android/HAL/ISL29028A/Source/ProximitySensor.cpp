@@ -28,61 +28,24 @@
 #include "ProximitySensor.h"
 #include "sensors.h"
 
-#define EVENT_TYPE_PROXIMITY		ABS_DISTANCE
-
-#define PROXIMITY_THRESHOLD			5.0f
 /*****************************************************************************/
 
-enum input_device_name {
-	SENSOR_DEVICE,
-	SUPPORTED_PSENSOR_COUNT,
-};
-
-static const char *data_device_name[] = {
-	[SENSOR_DEVICE] = DEVICE_NAME,			/* must be same as in register as sensor driver name */
-
-};
-
-static const char *input_sysfs_path_list[] = {
-	[SENSOR_DEVICE]   = "/sys/class/input/%s/device/"	/* Event generated path regarding sensor driver */
-};
-
-static const char *input_sysfs_enable_list[] = {
-	[SENSOR_DEVICE]   = "enable"
-};
-
-
-	ProximitySensor::ProximitySensor()
+	ProximitySensor::ProximitySensor(SensorInputDevice* input,
+		const struct isl_sensor_desc* desc, int handle)
 : SensorBase(NULL, NULL),
 	mEnabled(0),
-	mInputReader(4),
+	mInput(input),
+	mDesc(desc),
 	mHasPendingEvent(false),
-	sensor_index(-1)
+	mHasFrameData(false)
 {
-	int i;
 	mPendingEvent.version = sizeof(sensors_event_t);
-	mPendingEvent.sensor = SENSORS_PROXIMITY_HANDLE;
+	mPendingEvent.sensor = handle;
 	mPendingEvent.type = SENSOR_TYPE_PROXIMITY;
 	memset(mPendingEvent.data, 0, sizeof(mPendingEvent.data));
 
-	for(i = 0; i < SUPPORTED_PSENSOR_COUNT; i++) {
-		data_name = data_device_name[i];
-
-		// data_fd is not initialized if data_name passed
-		// to SensorBase is NULL.
-		data_fd = openInput(data_name);
-		if (data_fd > 0) {
-			sensor_index = i;
-			break;
-		}
-	}
-
-	if (data_fd) {
-		snprintf(input_sysfs_path, sizeof(input_sysfs_path),
-				input_sysfs_path_list[i], input_name);
-		input_sysfs_path_len = strlen(input_sysfs_path);
-		enable(0, 1);
-	}
+	/* the node may only show up later, see SensorInputDevice::attach() */
+	input->addSensor(desc->ev_type, desc->ev_code, this);
 }
 
 ProximitySensor::~ProximitySensor() {
@@ -93,42 +56,37 @@ ProximitySensor::~ProximitySensor() {
 
 int ProximitySensor::setInitialState() {
 	struct input_absinfo absinfo;
-	if (!ioctl(data_fd, EVIOCGABS(EVENT_TYPE_PROXIMITY), &absinfo)) {
+	if (mDesc->ev_type == EV_ABS &&
+			!ioctl(mInput->getFd(), EVIOCGABS(mDesc->ev_code), &absinfo)) {
 		// make sure to report an event immediately
 		mHasPendingEvent = true;
 		mPendingEvent.distance = indexToValue(absinfo.value);
+		mPendingEvent.timestamp = getTimestamp();
 	}
 	return 0;
 }
 
+int ProximitySensor::setDelay(int32_t handle, int64_t ns)
+{
+	/* the rate is shared with the light sensor on the same node */
+	return mInput->setSensorDelay(this, ns);
+}
+
 int ProximitySensor::enable(int32_t handle, int en) {
 	int flags = en ? 1 : 0;
 	if (flags != mEnabled) {
-		int fd;
-		if (sensor_index >= 0) {
-			strlcpy(&input_sysfs_path[input_sysfs_path_len], input_sysfs_enable_list[sensor_index],
-					sizeof(input_sysfs_path) - input_sysfs_path_len);
-		} else
-			return -1;
-
-		/* sysfs path from where we can enable sensor device driver */
-		fd = open(PROX_ENABLE_SYSPATH, O_RDWR);
-
-		if (fd >= 0) {
-			char buf[2];
-			buf[1] = 0;
-			if (flags) {
-				buf[0] = '1';
-			} else {
-				buf[0] = '0';
-			}
-			write(fd, buf, sizeof(buf));
-			close(fd);
-			mEnabled = flags;
-			setInitialState();
-			return 0;
+		/* sysfs path from where we can enable sensor device driver,
+		 * left alone while the other variant of this sensor runs */
+		if (mDesc->enable_path && !mInput->isSharedActive(this)) {
+			char path[PATH_MAX];
+			mInput->formatPath(mDesc->enable_path, path, sizeof(path));
+			mEnableAttr.setPath(path);
+			if (mEnableAttr.writeInt(flags) < 0)
+				return -1;
 		}
-		return -1;
+		mEnabled = flags;
+		mInput->setSensorActive(this, flags);
+		setInitialState();
 	}
 	return 0;
 }
@@ -144,44 +102,39 @@ int ProximitySensor::readEvents(sensors_event_t* data, int count)
 
 	if (mHasPendingEvent) {
 		mHasPendingEvent = false;
-		mPendingEvent.timestamp = getTimestamp();
 		*data = mPendingEvent;
 		return mEnabled ? 1 : 0;
 	}
 
-	ssize_t n = mInputReader.fill(data_fd);
-	if (n < 0)
-		return n;
-
-	int numEventReceived = 0;
-	input_event const* event;
-
-	while (count && mInputReader.readEvent(&event)) {
-		int type = event->type;
-		if (type == EV_ABS) {
-			if (event->code == EVENT_TYPE_PROXIMITY) {
-				if (event->value != -1) {
-					// FIXME: not sure why we're getting -1 sometimes
-					mPendingEvent.distance = indexToValue(event->value);
-				}
-			}
-		} else if (type == EV_SYN) {
-			mPendingEvent.timestamp = timevalToNano(event->time);
-			if (mEnabled) {
-				*data++ = mPendingEvent;
-				count--;
-				numEventReceived++;
-			}
-		} else {
-			ALOGE("LightSensor: unknown event (type=%d, code=%d)",
-			type, event->code);
+	return 0;
+}
+
+void ProximitySensor::processEvent(int code, int value)
+{
+	if (code == mDesc->ev_code) {
+		if (value != -1) {
+			// FIXME: not sure why we're getting -1 sometimes
+			mPendingEvent.distance = indexToValue(value);
+			mHasFrameData = true;
 		}
-		mInputReader.next();
 	}
-	return numEventReceived;
+}
+
+/*
+ * Every sensor of the node sees every sync, but only a frame that
+ * carried a distance is an event. evdev already drops repeated values,
+ * so that is also an on-change filter.
+ */
+void ProximitySensor::syncEvent(int64_t timestamp)
+{
+	if (mEnabled && mHasFrameData) {
+		mPendingEvent.timestamp = timestamp;
+		mHasPendingEvent = true;
+	}
+	mHasFrameData = false;
 }
 
 float ProximitySensor::indexToValue(size_t index) const
 {
-	return index * PROXIMITY_THRESHOLD;
+	return index * mDesc->scale;
 }
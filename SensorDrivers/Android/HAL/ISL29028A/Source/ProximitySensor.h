@@ -24,7 +24,9 @@
 #include <sys/types.h>
 
 #include "SensorBase.h"
-#include "InputEventReader.h"
+#include "SensorInputDevice.h"
+#include "SysfsAttribute.h"
+#include "SensorParts.h"
 
 /*****************************************************************************/
 
@@ -32,22 +34,28 @@ struct input_event;
 
 class ProximitySensor : public SensorBase {
 	int mEnabled;
-	InputEventCircularReader mInputReader;
+	SensorInputDevice* mInput;
+	const struct isl_sensor_desc* mDesc;
 	sensors_event_t mPendingEvent;
 	bool mHasPendingEvent;
-	char input_sysfs_path[PATH_MAX];
-	int input_sysfs_path_len;
-	int sensor_index;
+	SysfsAttribute mEnableAttr;
+
+	/* the current frame carried a distance, see syncEvent() */
+	bool mHasFrameData;
 
 	int setInitialState();
 	float indexToValue(size_t index) const;
 
 	public:
-	ProximitySensor();
+	ProximitySensor(SensorInputDevice* input,
+			const struct isl_sensor_desc* desc, int handle);
 	virtual ~ProximitySensor();
 	virtual int readEvents(sensors_event_t* data, int count);
 	virtual bool hasPendingEvents() const;
+	virtual int setDelay(int32_t handle, int64_t ns);
 	virtual int enable(int32_t handle, int enabled);
+	virtual void processEvent(int code, int value);
+	virtual void syncEvent(int64_t timestamp);
 };
 
 /*****************************************************************************/
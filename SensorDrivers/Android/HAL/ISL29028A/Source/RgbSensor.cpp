@@ -0,0 +1,195 @@
+/* File         : RgbSensor.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+
+#include "sensors.h"
+#include "RgbSensor.h"
+
+/*****************************************************************************/
+
+enum { RANGE_LO = 0, RANGE_HI, RANGE_MAX };
+
+/*
+ * CCM_RangeLo/CCM_RangeHi and CCM_Gain of isl29124.c, 14-bit fixed point.
+ * Rows give X, Y and Z from R, G and B; the gain scales Y to lux at 16
+ * bits of ADC resolution, which is what the driver runs at.
+ */
+static const float sCcm[RANGE_MAX][3][3] = {
+	{
+		{ -393.0f,	13716.0f,	-6026.0f },
+		{ -3553.0f,	16383.0f,	-6471.0f },
+		{ -7543.0f,	5480.0f,	10138.0f },
+	},
+	{
+		{ -393.0f,	13716.0f,	-6026.0f },
+		{ -3553.0f,	16383.0f,	-6471.0f },
+		{ -7543.0f,	5480.0f,	10138.0f },
+	},
+};
+
+static const float sCcmGain[RANGE_MAX] = { 1616402.0f, 59136.0f };
+
+/* McCamy's epicentre, as in cal_cct() of the driver */
+#define CCT_XE				0.3320f
+#define CCT_YE				0.1858f
+
+/*****************************************************************************/
+
+	RgbSensor::RgbSensor(SensorInputDevice* input,
+		const struct isl_sensor_desc* desc, int handle)
+: SensorBase(NULL, NULL),
+	mEnabled(0),
+	mInput(input),
+	mDesc(desc),
+	mHasPendingEvent(false),
+	mRange(RANGE_LO)
+{
+	mPendingEvent.version = sizeof(sensors_event_t);
+	mPendingEvent.sensor = handle;
+	mPendingEvent.type = desc->type;
+	memset(mPendingEvent.data, 0, sizeof(mPendingEvent.data));
+	memset(mRgb, 0, sizeof(mRgb));
+
+	/* the node may only show up later, see SensorInputDevice::attach() */
+	input->addSensor(desc->ev_type, desc->ev_code, this);
+}
+
+RgbSensor::~RgbSensor() {
+	if (mEnabled) {
+		enable(0, 0);
+	}
+}
+
+/* picks up the channels of the last frame, no frame repeats unchanged axes */
+int RgbSensor::setInitialState()
+{
+	static const int codes[] = { ABS_R, ABS_G, ABS_B, ABS_MISC };
+	struct input_absinfo absinfo;
+
+	for (size_t i = 0; i < ARRAY_SIZE(codes); i++) {
+		if (!ioctl(mInput->getFd(), EVIOCGABS(codes[i]), &absinfo))
+			processEvent(codes[i], absinfo.value);
+	}
+	return 0;
+}
+
+int RgbSensor::setDelay(int32_t handle, int64_t ns)
+{
+	/* the rate is shared with the other sensors of the part */
+	return mInput->setSensorDelay(this, ns);
+}
+
+int RgbSensor::enable(int32_t handle, int en)
+{
+	int flags = en ? 1 : 0;
+	if (flags != mEnabled) {
+		/* the part runs while any of its sensors does */
+		if (mDesc->enable_path && !mInput->isSharedActive(this)) {
+			char path[PATH_MAX];
+			mInput->formatPath(mDesc->enable_path, path, sizeof(path));
+			mEnableAttr.setPath(path);
+			if (mEnableAttr.writeInt(flags) < 0)
+				return -1;
+		}
+		mEnabled = flags;
+		mInput->setSensorActive(this, flags);
+		if (flags)
+			setInitialState();
+	}
+	return 0;
+}
+
+bool RgbSensor::hasPendingEvents() const {
+	return mHasPendingEvent;
+}
+
+int RgbSensor::readEvents(sensors_event_t* data, int count)
+{
+	if (count < 1)
+		return -EINVAL;
+
+	if (mHasPendingEvent) {
+		mHasPendingEvent = false;
+		*data = mPendingEvent;
+		return mEnabled ? 1 : 0;
+	}
+
+	return 0;
+}
+
+void RgbSensor::processEvent(int code, int value)
+{
+	if (code == ABS_R)
+		mRgb[0] = value;
+	else if (code == ABS_G)
+		mRgb[1] = value;
+	else if (code == ABS_B)
+		mRgb[2] = value;
+	else if (code == ABS_MISC)
+		mRange = value ? RANGE_HI : RANGE_LO;
+}
+
+/* fills mPendingEvent from the channels, false if there is no colour */
+bool RgbSensor::computeEvent()
+{
+	const float (*ccm)[3] = sCcm[mRange];
+	const float r = mRgb[0], g = mRgb[1], b = mRgb[2];
+	float xyz[3];
+
+	for (int i = 0; i < 3; i++)
+		xyz[i] = ccm[i][0] * r + ccm[i][1] * g + ccm[i][2] * b;
+
+	if (mDesc->report == ISL_REPORT_RGB_LUX) {
+		float lux = xyz[1] / sCcmGain[mRange];
+		mPendingEvent.light = lux > 0 ? lux : 0;
+		return true;
+	}
+
+	// chromaticity is undefined in the dark
+	float sum = xyz[0] + xyz[1] + xyz[2];
+	if (sum <= 0)
+		return false;
+	float x = xyz[0] / sum;
+	float y = xyz[1] / sum;
+
+	if (mDesc->report == ISL_REPORT_RGB_XY) {
+		mPendingEvent.data[0] = x;
+		mPendingEvent.data[1] = y;
+		return true;
+	}
+
+	if (y == CCT_YE)
+		return false;
+	float n = (x - CCT_XE) / (y - CCT_YE);
+	float cct = ((-449.0f * n + 3525.0f) * n - 6823.0f) * n + 5520.0f;
+	mPendingEvent.data[0] = cct > 0 ? cct : 0;
+	return true;
+}
+
+void RgbSensor::syncEvent(int64_t timestamp)
+{
+	if (mEnabled && computeEvent()) {
+		mPendingEvent.timestamp = timestamp;
+		mHasPendingEvent = true;
+	}
+}
@@ -0,0 +1,72 @@
+/* File         : RgbSensor.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_RGB_SENSOR_H
+#define ANDROID_RGB_SENSOR_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include "SensorBase.h"
+#include "SensorInputDevice.h"
+#include "SysfsAttribute.h"
+#include "SensorParts.h"
+
+/*****************************************************************************/
+
+/*
+ * A sensor computed from the R, G and B channels of an RGB part, one of
+ * illuminance, correlated colour temperature or xy chromaticity as given
+ * by the report of its descriptor.
+ *
+ * The driver streams the raw channels and its sensing range (ABS_MISC,
+ * 1 for the high range) in one frame. On each EV_SYN the channels go
+ * through the colour correction matrix of the range, the same
+ * fixed-point CCM the driver uses for its sysfs reads, and the result is
+ * handed out. The sensors of a part share its enable.
+ */
+class RgbSensor : public SensorBase {
+	int mEnabled;
+	SensorInputDevice* mInput;
+	const struct isl_sensor_desc* mDesc;
+	sensors_event_t mPendingEvent;
+	bool mHasPendingEvent;
+	SysfsAttribute mEnableAttr;
+
+	int mRgb[3];
+	int mRange;
+
+	bool computeEvent();
+	int setInitialState();
+
+	public:
+	RgbSensor(SensorInputDevice* input,
+			const struct isl_sensor_desc* desc, int handle);
+	virtual ~RgbSensor();
+	virtual int readEvents(sensors_event_t* data, int count);
+	virtual bool hasPendingEvents() const;
+	virtual int setDelay(int32_t handle, int64_t ns);
+	virtual int enable(int32_t handle, int enabled);
+	virtual void processEvent(int code, int value);
+	virtual void syncEvent(int64_t timestamp);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_RGB_SENSOR_H
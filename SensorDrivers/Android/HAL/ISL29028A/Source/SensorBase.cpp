@@ -27,7 +27,9 @@
 
 #include <linux/input.h>
 
+#include "sensors.h"
 #include "SensorBase.h"
+#include "InputDeviceIndex.h"
 
 /*****************************************************************************/
 
@@ -36,8 +38,9 @@ SensorBase::SensorBase(
 		const char* dev_name,
 		const char* data_name)
 : dev_name(dev_name), data_name(data_name),
-	dev_fd(-1), data_fd(-1)
+	dev_fd(-1), data_fd(-1), clock_offset(0)
 {
+	input_name[0] = '\0';
 	if (data_name) {
 		data_fd = openInput(data_name);
 	}
@@ -83,14 +86,76 @@ bool SensorBase::hasPendingEvents() const {
 	return false;
 }
 
+void SensorBase::processEvent(int code, int value) {
+}
+
+void SensorBase::syncEvent(int64_t timestamp) {
+}
+
 int64_t SensorBase::getTimestamp() {
     struct timespec t;
     t.tv_sec = t.tv_nsec = 0;
-    clock_gettime(CLOCK_MONOTONIC, &t);
+    clock_gettime(SENSORS_CLOCK, &t);
     return int64_t(t.tv_sec)*1000000000LL + t.tv_nsec;
 }
 
+/*
+ * Has evdev stamp the events of fd in SENSORS_CLOCK, so event times need
+ * no conversion. Kernels without EVIOCSCLOCKID, or without the clock,
+ * keep CLOCK_REALTIME; the offset between the two is then taken once here
+ * and added to every event time. It goes stale if the wall clock is set,
+ * until the node is opened again.
+ */
+void SensorBase::setupClock(int fd) {
+    int clk = SENSORS_CLOCK;
+
+    clock_offset = 0;
+    if (!ioctl(fd, EVIOCSCLOCKID, &clk))
+        return;
+
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    clock_offset = getTimestamp() -
+            (int64_t(t.tv_sec)*1000000000LL + t.tv_nsec);
+    ALOGW("EVIOCSCLOCKID failed (%s), converting event times", strerror(errno));
+}
+
 int SensorBase::openInput(const char* inputName) {
+    int fd = findInput(inputName);
+    if (fd >= 0)
+        setupClock(fd);
+    return fd;
+}
+
+int SensorBase::findInput(const char* inputName) {
+    char node[PATH_MAX];
+    InputDeviceIndex& index = InputDeviceIndex::get();
+
+    // look the node up by name in sysfs, and only open that one
+    char devname[PATH_MAX];
+    if (!index.find(inputName, node, sizeof(node)) &&
+            snprintf(devname, sizeof(devname), "/dev/input/%s", node) <
+            int(sizeof(devname))) {
+        int fd = open(devname, O_RDONLY);
+        if (fd >= 0) {
+            char name[80];
+            if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), &name) < 1) {
+                name[0] = '\0';
+            }
+            if (!strcmp(name, inputName)) {
+                strcpy(input_name, node);
+                return fd;
+            }
+            close(fd);
+        }
+    }
+
+    // stale index or no sysfs, fall back to probing every node
+    index.invalidate();
+    return scanInput(inputName);
+}
+
+int SensorBase::scanInput(const char* inputName) {
     int fd = -1;
     const char *dirname = "/dev/input";
     char devname[PATH_MAX];
@@ -39,14 +39,24 @@ class SensorBase {
 		int		 dev_fd;
 		int		 data_fd;
 
+		/* SENSORS_CLOCK minus the clock of data_fd, 0 if evdev took it */
+		int64_t	 clock_offset;
+
 		int openInput(const char* inputName);
-		static int64_t getTimestamp();
+		int findInput(const char* inputName);
+		int scanInput(const char* inputName);
+		void setupClock(int fd);
 
 
 		static int64_t timevalToNano(timeval const& t) {
 			return t.tv_sec*1000000000LL + t.tv_usec*1000;
 		}
 
+		/* input event time in SENSORS_CLOCK */
+		int64_t eventTime(timeval const& t) const {
+			return timevalToNano(t) + clock_offset;
+		}
+
 		int open_device();
 		int close_device();
 
@@ -57,11 +67,17 @@ class SensorBase {
 
 		virtual ~SensorBase();
 
+		static int64_t getTimestamp();
+
 		virtual int readEvents(sensors_event_t* data, int count) = 0;
 		virtual bool hasPendingEvents() const;
 		virtual int getFd() const;
 		virtual int setDelay(int32_t handle, int64_t ns);
 		virtual int enable(int32_t handle, int enabled) = 0;
+
+		/* used when the input node is shared, see SensorInputDevice */
+		virtual void processEvent(int code, int value);
+		virtual void syncEvent(int64_t timestamp);
 };
 
 /*****************************************************************************/
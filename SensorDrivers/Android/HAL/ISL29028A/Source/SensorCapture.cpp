@@ -0,0 +1,359 @@
+/* File         : SensorCapture.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cutils/log.h>
+
+#include "sensors.h"
+#include "SensorBase.h"
+#include "SensorCapture.h"
+
+/* largest record, an ISL_CAPTURE_EVENT with a 10 byte varint */
+#define MAX_RECORD_SIZE			14
+
+/*****************************************************************************/
+
+static uint64_t zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/*
+ * Moves a capture that holds records to path.1, replacing the previous
+ * one there. An empty capture is left to be overwritten, so a service
+ * that restarts in a loop does not rotate the last real one away.
+ */
+static void rotate_capture(const char* path)
+{
+	struct isl_capture_header h;
+	char old[PATH_MAX];
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return;
+	ssize_t n = read(fd, &h, sizeof(h));
+	::close(fd);
+	if (n != sizeof(h) || h.magic != ISL_CAPTURE_MAGIC || !h.size)
+		return;
+
+	snprintf(old, sizeof(old), "%s.1", path);
+	if (rename(path, old) < 0)
+		ALOGE("couldn't keep %s as %s (%s)", path, old, strerror(errno));
+}
+
+/*****************************************************************************/
+
+SensorCaptureWriter::SensorCaptureWriter()
+: mBase(NULL),
+	mCapacity(0),
+	mPos(0),
+	mLastTime(0),
+	mFull(false)
+{
+	pthread_mutex_init(&mLock, NULL);
+}
+
+SensorCaptureWriter::~SensorCaptureWriter()
+{
+	if (mBase)
+		munmap(mBase, mCapacity);
+	pthread_mutex_destroy(&mLock);
+}
+
+SensorCaptureWriter& SensorCaptureWriter::get()
+{
+	static SensorCaptureWriter sWriter;
+	static pthread_once_t sOnce = PTHREAD_ONCE_INIT;
+	struct Open {
+		static void run() {
+			sWriter.open(SENSORS_CAPTURE_FILE, SENSORS_CAPTURE_SIZE,
+					SENSORS_CLOCK, SensorBase::getTimestamp());
+		}
+	};
+
+	if (SENSORS_CAPTURE)
+		pthread_once(&sOnce, Open::run);
+	return sWriter;
+}
+
+int SensorCaptureWriter::open(const char* path, size_t size, int clockId,
+		int64_t startTime)
+{
+	if (size < sizeof(struct isl_capture_header) + MAX_RECORD_SIZE)
+		return -EINVAL;
+
+	/* the previous session may have been cut short, keep it */
+	rotate_capture(path);
+
+	int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		ALOGE("couldn't create %s (%s)", path, strerror(errno));
+		return -errno;
+	}
+
+	/* allocate the blocks now, a full disk must not SIGBUS us later */
+	int err = posix_fallocate(fd, 0, size);
+	if (!err) {
+		mBase = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fd, 0);
+		if (mBase == MAP_FAILED) {
+			err = errno;
+			mBase = NULL;
+		}
+	}
+	::close(fd);
+	if (err) {
+		ALOGE("couldn't map %s (%s)", path, strerror(err));
+		return -err;
+	}
+
+	struct isl_capture_header* const h = header();
+	memset(h, 0, sizeof(*h));
+	h->magic = ISL_CAPTURE_MAGIC;
+	h->version = ISL_CAPTURE_VERSION;
+	h->clock_id = clockId;
+	h->header_size = sizeof(*h);
+	h->start_time = startTime;
+
+	mCapacity = size;
+	mPos = sizeof(*h);
+	mLastTime = startTime;
+	mFull = false;
+	return 0;
+}
+
+int SensorCaptureWriter::addDevice(const char* name)
+{
+	if (!mBase)
+		return -ENODEV;
+
+	pthread_mutex_lock(&mLock);
+	struct isl_capture_header* const h = header();
+	int device = -ENOMEM;
+	for (int i = 0; i < h->num_devices; i++) {
+		if (!strcmp(h->devices[i], name)) {
+			device = i;
+			break;
+		}
+	}
+	if (device < 0 && h->num_devices < ISL_CAPTURE_MAX_DEVICES) {
+		device = h->num_devices;
+		strlcpy(h->devices[device], name, ISL_CAPTURE_NAME_SIZE);
+		h->num_devices++;
+	}
+	pthread_mutex_unlock(&mLock);
+	return device;
+}
+
+void SensorCaptureWriter::putVarint(int64_t value)
+{
+	uint64_t v = zigzag(value);
+	while (v >= 0x80) {
+		putByte(uint8_t(v) | 0x80);
+		v >>= 7;
+	}
+	putByte(uint8_t(v));
+}
+
+void SensorCaptureWriter::write(int device, input_event const* events,
+		int count, int64_t clockOffset)
+{
+	if (!mBase || device < 0 || mFull)
+		return;
+
+	pthread_mutex_lock(&mLock);
+	for (int i = 0; i < count; i++) {
+		input_event const* const ev = &events[i];
+
+		if (mPos + MAX_RECORD_SIZE > mCapacity) {
+			ALOGW("sensor capture full, recording stopped");
+			mFull = true;
+			break;
+		}
+
+		if (ev->type == EV_SYN) {
+			int64_t time = ev->time.tv_sec * 1000000000LL +
+				ev->time.tv_usec * 1000LL + clockOffset;
+			putByte((device << 4) | ISL_CAPTURE_SYN);
+			putByte(ev->code);
+			putVarint((time - mLastTime) / 1000);
+			// keep whole us, so rounding never adds up
+			mLastTime += (time - mLastTime) / 1000 * 1000;
+		} else if (ev->type == EV_ABS && ev->code <= 0xFF) {
+			putByte((device << 4) | ISL_CAPTURE_ABS);
+			putByte(ev->code);
+			putVarint(ev->value);
+		} else {
+			putByte((device << 4) | ISL_CAPTURE_EVENT);
+			putByte(ev->type);
+			putByte(ev->code & 0xFF);
+			putByte(ev->code >> 8);
+			putVarint(ev->value);
+		}
+	}
+
+	// readers of a live capture only ever see whole records
+	__atomic_store_n(&header()->size, mPos - header()->header_size,
+			__ATOMIC_RELEASE);
+	pthread_mutex_unlock(&mLock);
+}
+
+/*****************************************************************************/
+
+SensorCaptureReader::SensorCaptureReader()
+: mFd(-1),
+	mBase(NULL),
+	mMapSize(0),
+	mPos(NULL),
+	mEnd(NULL),
+	mTime(0)
+{
+}
+
+SensorCaptureReader::~SensorCaptureReader()
+{
+	close();
+}
+
+int SensorCaptureReader::open(const char* path)
+{
+	struct stat st;
+
+	close();
+	mFd = ::open(path, O_RDONLY);
+	if (mFd < 0)
+		return -errno;
+	if (fstat(mFd, &st) < 0 ||
+			size_t(st.st_size) < sizeof(struct isl_capture_header)) {
+		close();
+		return -EINVAL;
+	}
+
+	void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, mFd, 0);
+	if (base == MAP_FAILED) {
+		int err = -errno;
+		close();
+		return err;
+	}
+	mBase = (const uint8_t*)base;
+	mMapSize = st.st_size;
+
+	const struct isl_capture_header* const h = header();
+	if (h->magic != ISL_CAPTURE_MAGIC || h->version != ISL_CAPTURE_VERSION ||
+			h->header_size < sizeof(*h) || h->header_size > mMapSize ||
+			h->num_devices > ISL_CAPTURE_MAX_DEVICES) {
+		close();
+		return -EINVAL;
+	}
+	rewind();
+	return 0;
+}
+
+void SensorCaptureReader::close()
+{
+	if (mBase)
+		munmap((void*)mBase, mMapSize);
+	if (mFd >= 0)
+		::close(mFd);
+	mFd = -1;
+	mBase = NULL;
+	mMapSize = 0;
+	mPos = mEnd = NULL;
+}
+
+void SensorCaptureReader::rewind()
+{
+	const struct isl_capture_header* const h = header();
+	uint64_t size = __atomic_load_n(&h->size, __ATOMIC_ACQUIRE);
+
+	if (size > mMapSize - h->header_size)
+		size = mMapSize - h->header_size;
+	mPos = mBase + h->header_size;
+	mEnd = mPos + size;
+	mTime = h->start_time;
+}
+
+bool SensorCaptureReader::getVarint(int64_t* value)
+{
+	uint64_t v = 0;
+
+	for (int shift = 0; shift < 64 && mPos < mEnd; shift += 7) {
+		uint8_t byte = *mPos++;
+		v |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			*value = unzigzag(v);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SensorCaptureReader::next(struct isl_capture_record* record)
+{
+	if (!mBase || mEnd - mPos < 2)
+		return false;
+
+	uint8_t tag = *mPos++;
+	int64_t value;
+
+	record->device = tag >> 4;
+	switch (tag & 0x0F) {
+	case ISL_CAPTURE_ABS:
+		record->type = EV_ABS;
+		record->code = *mPos++;
+		if (!getVarint(&value))
+			return false;
+		record->value = int32_t(value);
+		break;
+	case ISL_CAPTURE_SYN:
+		record->type = EV_SYN;
+		record->code = *mPos++;
+		if (!getVarint(&value))
+			return false;
+		mTime += value * 1000;
+		record->value = 0;
+		break;
+	case ISL_CAPTURE_EVENT:
+		if (mEnd - mPos < 3)
+			return false;
+		record->type = mPos[0];
+		record->code = mPos[1] | (mPos[2] << 8);
+		mPos += 3;
+		if (!getVarint(&value))
+			return false;
+		record->value = int32_t(value);
+		break;
+	default:
+		return false;
+	}
+
+	record->time = mTime;
+	return record->device < getNumDevices();
+}
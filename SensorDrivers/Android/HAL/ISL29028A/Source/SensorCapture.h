@@ -0,0 +1,159 @@
+/* File         : SensorCapture.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_CAPTURE_H
+#define ANDROID_SENSOR_CAPTURE_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <linux/input.h>
+
+/*****************************************************************************/
+
+/*
+ * Capture file of the raw input events of the sensor nodes.
+ *
+ * A fixed header names the devices, then records follow back to back
+ * until header.size bytes. Each record starts with a tag byte, the device
+ * index in the high nibble and the kind in the low one:
+ *
+ *  ISL_CAPTURE_ABS    code u8, value zigzag varint
+ *  ISL_CAPTURE_SYN    code u8, time delta zigzag varint
+ *  ISL_CAPTURE_EVENT  type u8, code u16 le, value zigzag varint
+ *
+ * The time of a SYN is the one of the previous SYN of any device, or
+ * header.start_time for the first, plus the delta in us. Evdev stamps a
+ * frame at its SYN, so the events before it carry no time of their own.
+ * Varints are LEB128, so a lux frame is usually 8 bytes or less.
+ */
+#define ISL_CAPTURE_MAGIC		0x50414349	/* "ICAP" */
+#define ISL_CAPTURE_VERSION		1
+#define ISL_CAPTURE_MAX_DEVICES		16
+#define ISL_CAPTURE_NAME_SIZE		32
+
+enum {
+	ISL_CAPTURE_ABS = 0,
+	ISL_CAPTURE_SYN,
+	ISL_CAPTURE_EVENT,
+};
+
+struct isl_capture_header {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	num_devices;
+	uint32_t	clock_id;	/* clock of the SYN times */
+	uint32_t	header_size;	/* records start here */
+	int64_t		start_time;	/* ns */
+	uint64_t	size;		/* bytes of complete records */
+	char		devices[ISL_CAPTURE_MAX_DEVICES][ISL_CAPTURE_NAME_SIZE];
+};
+
+/* One decoded record; time is that of the last SYN read, see above */
+struct isl_capture_record {
+	int		device;
+	int		type;
+	int		code;
+	int32_t		value;
+	int64_t		time;
+};
+
+/*
+ * Appends records to a capture file that is allocated up front and
+ * mapped, so recording costs no syscall per event. The header size is
+ * advanced after every batch, so a capture cut short by a crash still
+ * reads up to the last batch. open() first moves a capture with records
+ * to path.1, so that one survives the restart that follows. The file is
+ * never wrapped; once it is full recording stops.
+ */
+class SensorCaptureWriter
+{
+	pthread_mutex_t mLock;
+	uint8_t* mBase;
+	size_t mCapacity;
+	size_t mPos;
+	int64_t mLastTime;
+	bool mFull;
+
+	struct isl_capture_header* header() const {
+		return (struct isl_capture_header*)mBase;
+	}
+	void putByte(uint8_t byte) { mBase[mPos++] = byte; }
+	void putVarint(int64_t value);
+
+	public:
+	SensorCaptureWriter();
+	~SensorCaptureWriter();
+
+	/* the capture of the HAL, opened on first use if SENSORS_CAPTURE */
+	static SensorCaptureWriter& get();
+
+	int open(const char* path, size_t size, int clockId, int64_t startTime);
+	bool isOpen() const { return mBase != NULL; }
+
+	/* index of the device in the capture, negative if not capturing */
+	int addDevice(const char* name);
+
+	/* clockOffset is added to the event times, see SensorBase::eventTime() */
+	void write(int device, input_event const* events, int count,
+			int64_t clockOffset);
+};
+
+/*
+ * Iterates the records of a capture in place, over a read-only mapping
+ * of the file.
+ */
+class SensorCaptureReader
+{
+	int mFd;
+	const uint8_t* mBase;
+	size_t mMapSize;
+	const uint8_t* mPos;
+	const uint8_t* mEnd;
+	int64_t mTime;
+
+	const struct isl_capture_header* header() const {
+		return (const struct isl_capture_header*)mBase;
+	}
+	bool getVarint(int64_t* value);
+
+	public:
+	SensorCaptureReader();
+	~SensorCaptureReader();
+
+	int open(const char* path);
+	void close();
+
+	int getNumDevices() const { return header()->num_devices; }
+	const char* getDeviceName(int device) const {
+		return header()->devices[device];
+	}
+	int getClockId() const { return header()->clock_id; }
+
+	/* back to the first record */
+	void rewind();
+
+	/* false at the end of the capture or on a damaged record */
+	bool next(struct isl_capture_record* record);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_CAPTURE_H
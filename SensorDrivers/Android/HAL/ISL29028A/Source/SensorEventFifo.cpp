@@ -0,0 +1,66 @@
+/* File         : SensorEventFifo.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+
+#include "SensorEventFifo.h"
+
+/*****************************************************************************/
+
+SensorEventFifo::SensorEventFifo(size_t capacity)
+: mEvents(new sensors_event_t[capacity]),
+	mCapacity(capacity),
+	mHead(0),
+	mCount(0)
+{
+}
+
+SensorEventFifo::~SensorEventFifo()
+{
+	delete [] mEvents;
+}
+
+/* returns the number of events queued, which is less than count when full */
+int SensorEventFifo::push(sensors_event_t const* events, int count)
+{
+	int numEventQueued = 0;
+
+	while (count-- && mCount < mCapacity) {
+		size_t tail = mHead + mCount;
+		if (tail >= mCapacity)
+			tail -= mCapacity;
+		mEvents[tail] = *events++;
+		mCount++;
+		numEventQueued++;
+	}
+	return numEventQueued;
+}
+
+int SensorEventFifo::pop(sensors_event_t* data, int count)
+{
+	int numEventReceived = 0;
+
+	while (count-- && mCount) {
+		*data++ = mEvents[mHead];
+		if (++mHead == mCapacity)
+			mHead = 0;
+		mCount--;
+		numEventReceived++;
+	}
+	return numEventReceived;
+}
@@ -0,0 +1,57 @@
+/* File         : SensorEventFifo.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_EVENT_FIFO_H
+#define ANDROID_SENSOR_EVENT_FIFO_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <hardware/sensors.h>
+
+/*****************************************************************************/
+
+/*
+ * Bounded queue of sensors_event_t used to batch events inside the HAL
+ * until their max report latency expires or the queue fills up.
+ * Only touched from the poll thread, so it needs no locking.
+ */
+class SensorEventFifo
+{
+	sensors_event_t* const mEvents;
+	const size_t mCapacity;
+	size_t mHead;
+	size_t mCount;
+
+	public:
+	SensorEventFifo(size_t capacity);
+	~SensorEventFifo();
+
+	size_t size() const { return mCount; }
+	size_t space() const { return mCapacity - mCount; }
+	bool isEmpty() const { return mCount == 0; }
+	bool isFull() const { return mCount == mCapacity; }
+
+	int push(sensors_event_t const* events, int count);
+	int pop(sensors_event_t* data, int count);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_EVENT_FIFO_H
@@ -0,0 +1,79 @@
+/* File         : SensorEventQueue.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+
+#include "SensorEventQueue.h"
+
+/*****************************************************************************/
+
+SensorEventQueue::SensorEventQueue()
+: mEnqueuePos(0),
+	mDequeuePos(0)
+{
+	for (size_t i = 0; i < SIZE; i++)
+		mCells[i].seq = i;
+}
+
+SensorEventQueue::~SensorEventQueue()
+{
+}
+
+bool SensorEventQueue::push(sensors_event_t const* event)
+{
+	size_t pos = __atomic_load_n(&mEnqueuePos, __ATOMIC_RELAXED);
+	Cell* cell;
+
+	for (;;) {
+		cell = &mCells[pos & MASK];
+		size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0) {
+			// free, try to claim it
+			if (__atomic_compare_exchange_n(&mEnqueuePos, &pos, pos + 1,
+					true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0) {
+			// the consumer is a full lap behind
+			return false;
+		} else {
+			// another producer got there first
+			pos = __atomic_load_n(&mEnqueuePos, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->event = *event;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+int SensorEventQueue::pop(sensors_event_t* data, int count)
+{
+	int nb = 0;
+
+	while (nb < count) {
+		Cell* const cell = &mCells[mDequeuePos & MASK];
+		size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		if (seq != mDequeuePos + 1)
+			break;
+		data[nb++] = cell->event;
+		__atomic_store_n(&cell->seq, mDequeuePos + SIZE, __ATOMIC_RELEASE);
+		mDequeuePos++;
+	}
+	return nb;
+}
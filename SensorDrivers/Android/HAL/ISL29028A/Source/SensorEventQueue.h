@@ -0,0 +1,76 @@
+/* File         : SensorEventQueue.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_EVENT_QUEUE_H
+#define ANDROID_SENSOR_EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <hardware/sensors.h>
+
+/*****************************************************************************/
+
+/* Number of events the reader threads can queue, must be a power of two */
+#ifndef SENSORS_QUEUE_SIZE
+#define SENSORS_QUEUE_SIZE		256
+#endif
+
+/*
+ * Bounded lock-free queue of sensors_event_t, pushed by any number of
+ * reader threads and popped by the poll thread only.
+ *
+ * Every cell carries a sequence number. A producer claims the cell at
+ * mEnqueuePos with a compare-and-swap once its sequence says it is free,
+ * fills it and publishes it by moving the sequence on; the consumer
+ * takes a cell once its sequence says it is published and hands it back
+ * one lap later. Producers never wait on each other or on the consumer,
+ * a full queue makes push() fail instead.
+ */
+class SensorEventQueue
+{
+	enum {
+		SIZE = SENSORS_QUEUE_SIZE,
+		MASK = SIZE - 1,
+	};
+	typedef char queue_size_must_be_a_power_of_two[(SIZE & MASK) ? -1 : 1];
+
+	struct Cell {
+		size_t seq;
+		sensors_event_t event;
+	};
+
+	Cell mCells[SIZE];
+	size_t mEnqueuePos;
+	size_t mDequeuePos;
+
+	public:
+	SensorEventQueue();
+	~SensorEventQueue();
+
+	/* producer side, safe from any thread */
+	bool push(sensors_event_t const* event);
+
+	/* consumer side, poll thread only */
+	int pop(sensors_event_t* data, int count);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_EVENT_QUEUE_H
@@ -0,0 +1,287 @@
+/* File         : SensorInputDevice.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+
+#include <linux/input.h>
+
+#include "SensorInputDevice.h"
+#include "SensorMetrics.h"
+#include "SensorCapture.h"
+
+/*****************************************************************************/
+
+SensorInputDevice::SensorInputDevice(const struct isl_part_desc* part)
+: SensorBase(NULL, part->input_name),
+	mPart(part),
+	mNumSensors(0),
+	mDelay(0)
+{
+	pthread_mutex_init(&mLock, NULL);
+	mCaptureDevice = SensorCaptureWriter::get().addDevice(part->input_name);
+
+	if (data_fd >= 0)
+		setupInput();
+}
+
+SensorInputDevice::~SensorInputDevice() {
+	pthread_mutex_destroy(&mLock);
+}
+
+void SensorInputDevice::setupInput()
+{
+	char path[PATH_MAX];
+
+	/* readEvents() may be called for pending events with nothing queued */
+	fcntl(data_fd, F_SETFL, O_NONBLOCK);
+	if (mPart->delay_path) {
+		formatPath(mPart->delay_path, path, sizeof(path));
+		mDelayAttr.setPath(path);
+	}
+}
+
+/* paths of a part may name the event node with a %s */
+int SensorInputDevice::formatPath(const char* fmt, char* path, size_t size) const
+{
+	return snprintf(path, size, fmt, input_name);
+}
+
+int SensorInputDevice::attach()
+{
+	pthread_mutex_lock(&mLock);
+	if (data_fd >= 0) {
+		pthread_mutex_unlock(&mLock);
+		return 0;
+	}
+
+	data_fd = openInput(data_name);
+	if (data_fd < 0) {
+		pthread_mutex_unlock(&mLock);
+		return -ENODEV;
+	}
+	setupInput();
+
+	/* a freshly probed driver runs at its default rate */
+	mDelay = 0;
+	updateDelay();
+	pthread_mutex_unlock(&mLock);
+	return 0;
+}
+
+void SensorInputDevice::detach()
+{
+	pthread_mutex_lock(&mLock);
+	if (data_fd >= 0) {
+		close(data_fd);
+		data_fd = -1;
+		input_name[0] = '\0';
+		mInputReader.clear();
+		mDelayAttr.setPath("");
+	}
+	pthread_mutex_unlock(&mLock);
+}
+
+int SensorInputDevice::addSensor(int type, int code, SensorBase* sensor)
+{
+	if (mNumSensors >= MAX_SENSORS)
+		return -ENOMEM;
+
+	mSensors[mNumSensors] = sensor;
+	mSensorTypes[mNumSensors] = type;
+	mSensorCodes[mNumSensors] = code;
+	mSensorDelays[mNumSensors] = 0;
+	mSensorActive[mNumSensors] = false;
+	mNumSensors++;
+	return 0;
+}
+
+int SensorInputDevice::sensorIndex(SensorBase* sensor) const
+{
+	for (int i = 0; i < mNumSensors; i++) {
+		if (mSensors[i] == sensor)
+			return i;
+	}
+	return -EINVAL;
+}
+
+/* writes the shortest period requested by an active sensor, if it changed */
+int SensorInputDevice::updateDelay()
+{
+	int64_t delay = 0;
+
+	for (int i = 0; i < mNumSensors; i++) {
+		if (!mSensorActive[i] || !mSensorDelays[i])
+			continue;
+		if (!delay || mSensorDelays[i] < delay)
+			delay = mSensorDelays[i];
+	}
+
+	if (!delay || delay == mDelay || !mPart->delay_path)
+		return 0;
+	if (mDelayAttr.writeInt(delay / mPart->delay_unit) < 0)
+		return -1;
+	mDelay = delay;
+	return 0;
+}
+
+int SensorInputDevice::setSensorDelay(SensorBase* sensor, int64_t ns)
+{
+	int index = sensorIndex(sensor);
+	if (index < 0)
+		return index;
+
+	mSensorDelays[index] = ns;
+	return updateDelay();
+}
+
+int SensorInputDevice::setSensorActive(SensorBase* sensor, bool active)
+{
+	int index = sensorIndex(sensor);
+	if (index < 0)
+		return index;
+
+	mSensorActive[index] = active;
+	return updateDelay();
+}
+
+/*
+ * Whether another sensor reading the same event is active, e.g. the
+ * wake-up and the non-wake-up variant of one proximity sensor. They
+ * share the driver's enable, which must stay on while either runs.
+ */
+bool SensorInputDevice::isSharedActive(SensorBase* sensor) const
+{
+	int index = sensorIndex(sensor);
+	if (index < 0)
+		return false;
+
+	for (int i = 0; i < mNumSensors; i++) {
+		if (i != index && mSensorActive[i] &&
+				mSensorCodes[i] == mSensorCodes[index] &&
+				mSensorTypes[i] == mSensorTypes[index])
+			return true;
+	}
+	return false;
+}
+
+int SensorInputDevice::enable(int32_t handle, int enabled)
+{
+	/* enabling is done per logical sensor, never on the shared node */
+	return -EINVAL;
+}
+
+bool SensorInputDevice::hasPendingEvents() const
+{
+	pthread_mutex_lock(&mLock);
+	bool pending = !mInputReader.isEmpty();
+	for (int i = 0; !pending && i < mNumSensors; i++)
+		pending = mSensors[i]->hasPendingEvents();
+	pthread_mutex_unlock(&mLock);
+	return pending;
+}
+
+int SensorInputDevice::readPendingEvents(sensors_event_t* data, int count)
+{
+	int numEventReceived = 0;
+
+	for (int i = 0; count && i < mNumSensors; i++) {
+		if (mSensors[i]->hasPendingEvents()) {
+			int nb = mSensors[i]->readEvents(data, count);
+			if (nb < 0)
+				continue;
+			count -= nb;
+			data += nb;
+			numEventReceived += nb;
+		}
+	}
+	return numEventReceived;
+}
+
+void SensorInputDevice::processInputEvent(input_event const* event)
+{
+	int type = event->type;
+	if (type == EV_SYN) {
+		int64_t time = eventTime(event->time);
+		for (int i = 0; i < mNumSensors; i++)
+			mSensors[i]->syncEvent(time);
+	} else {
+		bool handled = false;
+		for (int i = 0; i < mNumSensors; i++) {
+			if (mSensorTypes[i] == type && (mSensorCodes[i] == event->code ||
+					mSensorCodes[i] == ISL_EV_CODE_ANY)) {
+				mSensors[i]->processEvent(event->code, event->value);
+				handled = true;
+			}
+		}
+		if (!handled)
+			ALOGE("SensorInputDevice: unknown event (type=%d, code=%d)",
+					type, event->code);
+	}
+}
+
+int SensorInputDevice::readEvents(sensors_event_t* data, int count)
+{
+	if (count < 1)
+		return -EINVAL;
+
+	pthread_mutex_lock(&mLock);
+	int n = readInputEvents(data, count);
+	pthread_mutex_unlock(&mLock);
+	return n;
+}
+
+/* readEvents() with mLock held */
+int SensorInputDevice::readInputEvents(sensors_event_t* data, int count)
+{
+	// events latched by the last frame that did not fit last time
+	int numEventReceived = readPendingEvents(data, count);
+	count -= numEventReceived;
+	data += numEventReceived;
+	if (!count)
+		return numEventReceived;
+
+	ssize_t n = mInputReader.fill(data_fd);
+	if (n < 0) {
+		SensorMetrics::get().readError(mPart);
+		return numEventReceived ? numEventReceived : n;
+	}
+
+	input_event const* events;
+	ssize_t available;
+
+	while (count && (available = mInputReader.readEvents(&events)) > 0) {
+		ssize_t i;
+		for (i = 0; count && i < available; i++) {
+			processInputEvent(&events[i]);
+			if (events[i].type == EV_SYN) {
+				int nb = readPendingEvents(data, count);
+				count -= nb;
+				data += nb;
+				numEventReceived += nb;
+			}
+		}
+		SensorCaptureWriter::get().write(mCaptureDevice, events, i,
+				clock_offset);
+		mInputReader.consume(i);
+	}
+
+	return numEventReceived;
+}
@@ -0,0 +1,118 @@
+/* File         : SensorInputDevice.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_INPUT_DEVICE_H
+#define ANDROID_SENSOR_INPUT_DEVICE_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include "SensorBase.h"
+#include "InputEventReader.h"
+#include "SysfsAttribute.h"
+#include "SensorParts.h"
+
+/*****************************************************************************/
+
+struct input_event;
+
+/*
+ * One evdev node shared by several logical sensors.
+ *
+ * Parts such as the ISL29028A report lux and proximity in the same frame,
+ * so the node is opened and read once here and every event is routed to
+ * the sensors registered for its type and code. On EV_SYN each registered
+ * sensor latches the frame timestamp and its event is handed out through
+ * readEvents().
+ *
+ * The node also has a single sampling rate. Each sensor files its own
+ * period and active state, and the device is polled at the shortest
+ * period asked for by an active sensor.
+ *
+ * The node may not exist yet when the HAL is opened, or may go away with
+ * the driver. Sensors register either way; attach() opens the node once
+ * it shows up and detach() closes it again.
+ *
+ * mLock guards the node and the state of its sensors. readEvents(),
+ * hasPendingEvents(), attach() and detach() take it themselves, since
+ * they run on the poll thread or a SensorReader. Control calls on the
+ * sensors (enable(), setDelay()) run on binder threads and call back
+ * into setSensorActive()/setSensorDelay(), so the caller holds it
+ * around them through lock()/unlock().
+ */
+class SensorInputDevice : public SensorBase {
+	enum {
+		MAX_SENSORS = 4,
+	};
+
+	InputEventCircularReader mInputReader;
+	const struct isl_part_desc* mPart;
+	SensorBase* mSensors[MAX_SENSORS];
+	int mSensorTypes[MAX_SENSORS];
+	int mSensorCodes[MAX_SENSORS];
+	int64_t mSensorDelays[MAX_SENSORS];
+	bool mSensorActive[MAX_SENSORS];
+	int mNumSensors;
+
+	SysfsAttribute mDelayAttr;
+	int64_t mDelay;
+
+	/* index in the capture file, negative if not capturing */
+	int mCaptureDevice;
+
+	mutable pthread_mutex_t mLock;
+
+	int sensorIndex(SensorBase* sensor) const;
+	int updateDelay();
+	void setupInput();
+	int readPendingEvents(sensors_event_t* data, int count);
+	int readInputEvents(sensors_event_t* data, int count);
+	void processInputEvent(input_event const* event);
+
+	public:
+	SensorInputDevice(const struct isl_part_desc* part);
+	virtual ~SensorInputDevice();
+
+	const char* getName() const { return data_name; }
+	const char* getInputName() const { return input_name; }
+
+	bool isAttached() const { return data_fd >= 0; }
+	int attach();
+	void detach();
+
+	const struct isl_part_desc* getPart() const { return mPart; }
+	int formatPath(const char* fmt, char* path, size_t size) const;
+
+	void lock() { pthread_mutex_lock(&mLock); }
+	void unlock() { pthread_mutex_unlock(&mLock); }
+
+	int addSensor(int type, int code, SensorBase* sensor);
+	int setSensorDelay(SensorBase* sensor, int64_t ns);
+	int setSensorActive(SensorBase* sensor, bool active);
+	bool isSharedActive(SensorBase* sensor) const;
+
+	virtual int readEvents(sensors_event_t* data, int count);
+	virtual bool hasPendingEvents() const;
+	virtual int enable(int32_t handle, int enabled);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_INPUT_DEVICE_H
@@ -0,0 +1,137 @@
+/* File         : SensorMetrics.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+
+#include "SensorBase.h"
+#include "SensorMetrics.h"
+
+/*****************************************************************************/
+
+SensorMetrics::SensorMetrics()
+{
+	memset(mSensors, 0, sizeof(mSensors));
+	memset(mReadErrors, 0, sizeof(mReadErrors));
+	mStartTime = SensorBase::getTimestamp();
+}
+
+SensorMetrics& SensorMetrics::get()
+{
+	static SensorMetrics sMetrics;
+	return sMetrics;
+}
+
+void SensorMetrics::eventRead(int handle)
+{
+	Counters* const counters = countersFor(handle);
+	if (counters)
+		add(&counters->read, 1);
+}
+
+void SensorMetrics::eventDelivered(int handle, int64_t latency)
+{
+	Counters* const counters = countersFor(handle);
+	if (!counters)
+		return;
+
+	add(&counters->delivered, 1);
+	if (latency < 0) {
+		add(&counters->early, 1);
+		return;
+	}
+
+	uint64_t us = uint64_t(latency) / 1000;
+	int bucket = us ? 63 - __builtin_clzll(us) : 0;
+	if (bucket >= LATENCY_BUCKETS)
+		bucket = LATENCY_BUCKETS - 1;
+	add(&counters->latency[bucket], 1);
+}
+
+void SensorMetrics::eventDirect(int handle)
+{
+	Counters* const counters = countersFor(handle);
+	if (counters)
+		add(&counters->direct, 1);
+}
+
+void SensorMetrics::eventDropped(int handle)
+{
+	Counters* const counters = countersFor(handle);
+	if (counters)
+		add(&counters->dropped, 1);
+}
+
+void SensorMetrics::eventFiltered(int handle)
+{
+	Counters* const counters = countersFor(handle);
+	if (counters)
+		add(&counters->filtered, 1);
+}
+
+void SensorMetrics::readError(const struct isl_part_desc* part)
+{
+	int index = part - isl_parts;
+	if (SENSORS_METRICS && index >= 0 && index < MAX_PARTS)
+		add(&mReadErrors[index], 1);
+}
+
+int SensorMetrics::dump(int fd, const struct sensor_t* list, int count)
+{
+	int64_t uptime = SensorBase::getTimestamp() - mStartTime;
+	double seconds = uptime > 0 ? uptime / 1e9 : 1.0;
+
+	dprintf(fd, "Intersil sensors HAL, %.1f s\n", uptime / 1e9);
+	for (int i = 0; i < count && i < ISL_MAX_SENSORS; i++) {
+		const Counters& c = mSensors[list[i].handle - 1];
+		uint64_t delivered = load(&c.delivered);
+
+		dprintf(fd, "\n%d %s\n", list[i].handle, list[i].name);
+		dprintf(fd, "  read %llu  delivered %llu (%.2f Hz)  direct %llu\n",
+				(unsigned long long)load(&c.read),
+				(unsigned long long)delivered, delivered / seconds,
+				(unsigned long long)load(&c.direct));
+		dprintf(fd, "  dropped %llu  filtered %llu  early %llu\n",
+				(unsigned long long)load(&c.dropped),
+				(unsigned long long)load(&c.filtered),
+				(unsigned long long)load(&c.early));
+		for (int b = 0; b < LATENCY_BUCKETS; b++) {
+			uint64_t n = load(&c.latency[b]);
+			if (!n)
+				continue;
+			if (b == LATENCY_BUCKETS - 1)
+				dprintf(fd, "  latency >= %llu us: %llu\n",
+						1ULL << b, (unsigned long long)n);
+			else
+				dprintf(fd, "  latency < %llu us: %llu\n",
+						2ULL << b, (unsigned long long)n);
+		}
+	}
+
+	dprintf(fd, "\n");
+	for (int i = 0; i < isl_num_parts && i < MAX_PARTS; i++) {
+		uint64_t n = load(&mReadErrors[i]);
+		if (n)
+			dprintf(fd, "%s: %llu read errors\n", isl_parts[i].input_name,
+					(unsigned long long)n);
+	}
+	return 0;
+}
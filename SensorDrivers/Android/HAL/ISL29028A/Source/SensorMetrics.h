@@ -0,0 +1,100 @@
+/* File         : SensorMetrics.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_METRICS_H
+#define ANDROID_SENSOR_METRICS_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include "sensors.h"
+#include "SensorParts.h"
+
+/*****************************************************************************/
+
+/*
+ * Runtime counters of the HAL, per sensor handle.
+ *
+ *  read       events read from the input nodes
+ *  delivered  events returned by poll()
+ *  direct     events written to a direct channel
+ *  dropped    events lost on a full reader queue
+ *  filtered   samples held back by the light on-change filter
+ *
+ * plus a log2 histogram of the delivery latency, from the evdev event
+ * time to the return of poll(), and the reads of an input node that
+ * failed or returned a partial event, per part. Every counter is bumped
+ * with a relaxed atomic add, so any thread may count without a lock;
+ * dump() reads them the same way and may see a sample half counted,
+ * which is fine for statistics.
+ */
+class SensorMetrics
+{
+	enum {
+		/* bucket n holds latencies of [2^n, 2^(n+1)) us, the last one the rest */
+		LATENCY_BUCKETS = 24,
+		MAX_PARTS = 8,
+	};
+
+	struct Counters {
+		uint64_t read;
+		uint64_t delivered;
+		uint64_t direct;
+		uint64_t dropped;
+		uint64_t filtered;
+		uint64_t early;		/* event time ahead of the poll clock */
+		uint64_t latency[LATENCY_BUCKETS];
+	};
+
+	Counters mSensors[ISL_MAX_SENSORS];
+	uint64_t mReadErrors[MAX_PARTS];
+	int64_t mStartTime;
+
+	static void add(uint64_t* counter, uint64_t n) {
+		__atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+	}
+	static uint64_t load(const uint64_t* counter) {
+		return __atomic_load_n(counter, __ATOMIC_RELAXED);
+	}
+
+	Counters* countersFor(int handle) {
+		if (!SENSORS_METRICS || handle < 1 || handle > ISL_MAX_SENSORS)
+			return NULL;
+		return &mSensors[handle - 1];
+	}
+
+	public:
+	SensorMetrics();
+
+	static SensorMetrics& get();
+
+	void eventRead(int handle);
+	void eventDelivered(int handle, int64_t latency);
+	void eventDirect(int handle);
+	void eventDropped(int handle);
+	void eventFiltered(int handle);
+	void readError(const struct isl_part_desc* part);
+
+	/* writes the counters of list[0..count) as text to fd */
+	int dump(int fd, const struct sensor_t* list, int count);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_METRICS_H
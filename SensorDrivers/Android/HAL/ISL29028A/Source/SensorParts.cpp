@@ -0,0 +1,134 @@
+/* File         : SensorParts.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <linux/input.h>
+
+#include <hardware/sensors.h>
+
+#include "sensors.h"
+#include "SensorParts.h"
+
+/*****************************************************************************/
+
+/*
+ * Every ISL driver in the kernel tree that reports through an input
+ * device. The isl29035, isl29038 and isl29125 drivers only export sysfs,
+ * so those parts are not served here. The isl29124 streams raw RGB; its
+ * sensors are computed from each frame in the HAL.
+ */
+const struct isl_part_desc isl_parts[] = {
+	{
+		"isl29028A",
+		"/sys/class/input/%s/device/poll_delay", 1,
+		2, {
+			{ "ISL29028A Proximity", SENSOR_TYPE_PROXIMITY,
+			  EV_ABS, ABS_DISTANCE,
+			  "/sys/intersil/isl29028A/prox_status", 0, 5.0f,
+			  15.0f, 15.0f, 0.35f, 0, 0 },
+			{ "ISL29028A Light", SENSOR_TYPE_LIGHT,
+			  EV_ABS, ABS_MISC,
+			  "/sys/intersil/isl29028A/als_status", ISL_REPORT_LUX, 1.0f,
+			  50000.0f, 1.0f, 0.35f, 0, SENSORS_FIFO_SIZE,
+			  1.0f, 0.05f, 0 },
+		},
+	},
+	{
+		"isl29023",
+		NULL, 0,
+		1, {
+			{ "ISL29023 Light", SENSOR_TYPE_LIGHT,
+			  EV_ABS, ABS_MISC,
+			  NULL, ISL_REPORT_LUX, 1.0f,
+			  64000.0f, 1.0f, 0.07f, 0, SENSORS_FIFO_SIZE,
+			  1.0f, 0.05f, 0 },
+		},
+	},
+	{
+		"isl29030",
+		NULL, 0,
+		2, {
+			{ "ISL29030 Proximity", SENSOR_TYPE_PROXIMITY,
+			  EV_ABS, ABS_DISTANCE,
+			  "/sys/class/input/%s/device/pmod", 0, 5.0f,
+			  15.0f, 15.0f, 0.35f, 0, 0 },
+			/* lux goes out as LED_MISC, not as an abs axis */
+			{ "ISL29030 Light", SENSOR_TYPE_LIGHT,
+			  EV_LED, LED_MISC,
+			  "/sys/class/input/%s/device/lmod", ISL_REPORT_LUX, 1.0f,
+			  16000.0f, 1.0f, 0.09f, 0, SENSORS_FIFO_SIZE,
+			  1.0f, 0.05f, 0 },
+		},
+	},
+	{
+		"isl29037_PROX",
+		NULL, 0,
+		1, {
+			{ "ISL29037 Proximity", SENSOR_TYPE_PROXIMITY,
+			  EV_ABS, ABS_DISTANCE,
+			  "/sys/kernel/isl29037/enable_prox", 0, 5.0f,
+			  15.0f, 15.0f, 0.35f, 0, 0 },
+		},
+	},
+	{
+		"isl29037_ALS",
+		NULL, 0,
+		1, {
+			{ "ISL29037 Light", SENSOR_TYPE_LIGHT,
+			  EV_ABS, ABS_MISC,
+			  "/sys/kernel/isl29037/enable_als", ISL_REPORT_LUX, 1.0f,
+			  16000.0f, 1.0f, 0.09f, 0, SENSORS_FIFO_SIZE,
+			  1.0f, 0.05f, 0 },
+		},
+	},
+	{
+		"isl29177",
+		NULL, 0,
+		1, {
+			{ "ISL29177 Proximity", SENSOR_TYPE_PROXIMITY,
+			  EV_ABS, ABS_DISTANCE,
+			  "/sys/kernel/isl29177/enable", 0, 5.0f,
+			  15.0f, 15.0f, 0.35f, 0, 0 },
+		},
+	},
+	{
+		/* poll_delay and sensor_enable live on the i2c device, in ms */
+		"rgbsensor_isl29124_f",
+		"/sys/class/input/%s/device/device/poll_delay", 1000000,
+		3, {
+			{ "ISL29124 Light", SENSOR_TYPE_LIGHT,
+			  EV_ABS, ISL_EV_CODE_ANY,
+			  "/sys/class/input/%s/device/device/sensor_enable",
+			  ISL_REPORT_RGB_LUX, 1.0f,
+			  10000.0f, 0.1f, 0.06f, 100000, 0,
+			  0.0f, 0.0f, 0, NULL },
+			{ "ISL29124 Color Temperature", SENSOR_TYPE_ISL_COLOR_TEMPERATURE,
+			  EV_ABS, ISL_EV_CODE_ANY,
+			  "/sys/class/input/%s/device/device/sensor_enable",
+			  ISL_REPORT_RGB_CCT, 1.0f,
+			  25000.0f, 1.0f, 0.06f, 100000, 0,
+			  0.0f, 0.0f, 0, "com.intersil.sensor.color_temperature" },
+			{ "ISL29124 Chromaticity", SENSOR_TYPE_ISL_CHROMATICITY,
+			  EV_ABS, ISL_EV_CODE_ANY,
+			  "/sys/class/input/%s/device/device/sensor_enable",
+			  ISL_REPORT_RGB_XY, 1.0f,
+			  1.0f, 0.0001f, 0.06f, 100000, 0,
+			  0.0f, 0.0f, 0, "com.intersil.sensor.chromaticity" },
+		},
+	},
+};
+
+const int isl_num_parts = ARRAY_SIZE(isl_parts);
@@ -0,0 +1,118 @@
+/* File         : SensorParts.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_PARTS_H
+#define ANDROID_SENSOR_PARTS_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+/*****************************************************************************/
+
+/* most logical sensors behind one input device */
+#define ISL_PART_MAX_SENSORS		3
+
+/* most logical sensors the HAL serves, one handle each */
+#define ISL_MAX_SENSORS			8
+
+/*
+ * How a sensor reports. LUX and ADC are light sensors, see
+ * LightSensor::convertEvent(); the RGB ones are computed from the
+ * colour channels of a frame, see RgbSensor.
+ */
+enum {
+	ISL_REPORT_LUX = 0,
+	ISL_REPORT_ADC,
+	ISL_REPORT_RGB_LUX,
+	ISL_REPORT_RGB_CCT,
+	ISL_REPORT_RGB_XY,
+};
+
+/* ev_code of a sensor that takes every code of its ev_type */
+#define ISL_EV_CODE_ANY			(-1)
+
+/*
+ * Colour channels of the isl29124 input device. The board header
+ * <linux/isl29124.h> defines them for the driver; build with the same
+ * values if they differ from these.
+ */
+#ifndef ABS_R
+#define ABS_R				ABS_RX
+#endif
+#ifndef ABS_G
+#define ABS_G				ABS_RY
+#endif
+#ifndef ABS_B
+#define ABS_B				ABS_RZ
+#endif
+
+#ifndef SENSOR_TYPE_DEVICE_PRIVATE_BASE
+#define SENSOR_TYPE_DEVICE_PRIVATE_BASE	0x10000
+#endif
+
+/* vendor types of the RGB sensors, named by isl_sensor_desc.string_type */
+#define SENSOR_TYPE_ISL_COLOR_TEMPERATURE	(SENSOR_TYPE_DEVICE_PRIVATE_BASE + 1)
+#define SENSOR_TYPE_ISL_CHROMATICITY		(SENSOR_TYPE_DEVICE_PRIVATE_BASE + 2)
+
+/*
+ * One logical sensor of a part. Paths may hold a %s, which is replaced
+ * by the event node (e.g. "event3") of the part's input device.
+ */
+struct isl_sensor_desc {
+	const char*	name;
+	int		type;		/* SENSOR_TYPE_*, or an ISL vendor type */
+	int		ev_type;	/* event carrying the sample */
+	int		ev_code;	/* or ISL_EV_CODE_ANY */
+	const char*	enable_path;	/* NULL if the driver is always on */
+	int		report;		/* ISL_REPORT_*, not for proximity */
+	float		scale;		/* input value to SI unit */
+	float		max_range;
+	float		resolution;
+	float		power;		/* mA */
+	int32_t		min_delay;	/* us, 0 for on-change */
+	uint32_t	fifo_max;	/* events batched in the HAL */
+
+	/*
+	 * On-change filter, light only. A sample is reported when it moved
+	 * from the last reported one by more than hyst_abs lux and more than
+	 * hyst_rel of that value, and no sooner than min_interval_ms after
+	 * it. All zero still drops samples that did not change at all.
+	 */
+	float		hyst_abs;
+	float		hyst_rel;
+	int32_t		min_interval_ms;
+
+	const char*	string_type;	/* vendor types only */
+};
+
+/* One kernel driver, that is one input device and the sensors behind it */
+struct isl_part_desc {
+	const char*	input_name;	/* input_dev->name of the driver */
+	const char*	delay_path;	/* NULL if the rate is fixed */
+	int64_t		delay_unit;	/* ns per unit of delay_path */
+	int		num_sensors;
+	struct isl_sensor_desc sensors[ISL_PART_MAX_SENSORS];
+};
+
+extern const struct isl_part_desc isl_parts[];
+extern const int isl_num_parts;
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_PARTS_H
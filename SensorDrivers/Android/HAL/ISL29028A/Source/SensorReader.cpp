@@ -0,0 +1,152 @@
+/* File         : SensorReader.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <cutils/log.h>
+
+#include "SensorReader.h"
+#include "SensorMetrics.h"
+
+/*****************************************************************************/
+
+SensorReader::SensorReader(SensorBase* sensor, SensorEventQueue* queue,
+		int notifyFd)
+: mSensor(sensor),
+	mQueue(queue),
+	mNotifyFd(notifyFd),
+	mRunning(false),
+	mExitPending(false),
+	mOverflow(false)
+{
+	mKickFd = eventfd(0, EFD_NONBLOCK);
+	ALOGE_IF(mKickFd<0, "error creating reader eventfd (%s)", strerror(errno));
+}
+
+SensorReader::~SensorReader()
+{
+	stop();
+	if (mKickFd >= 0)
+		close(mKickFd);
+}
+
+int SensorReader::start()
+{
+	if (mRunning)
+		return 0;
+	if (mKickFd < 0)
+		return -EINVAL;
+
+	mExitPending = false;
+	int err = pthread_create(&mThread, NULL, threadLoop, this);
+	if (err) {
+		ALOGE("error creating reader thread (%s)", strerror(err));
+		return -err;
+	}
+	mRunning = true;
+	return 0;
+}
+
+void SensorReader::stop()
+{
+	if (!mRunning)
+		return;
+
+	mExitPending = true;
+	kick();
+	pthread_join(mThread, NULL);
+	mRunning = false;
+}
+
+void SensorReader::kick()
+{
+	uint64_t kickMessage = 1;
+	int result = write(mKickFd, &kickMessage, sizeof(kickMessage));
+	ALOGE_IF(result<0, "error kicking reader (%s)", strerror(errno));
+}
+
+/* reads until the sensor has nothing left and queues what it got */
+void SensorReader::drain()
+{
+	sensors_event_t buffer[READ_CHUNK];
+	bool queued = false;
+	int n;
+
+	do {
+		n = mSensor->readEvents(buffer, READ_CHUNK);
+		for (int i = 0; i < n; i++) {
+			SensorMetrics::get().eventRead(buffer[i].sensor);
+			if (mQueue->push(&buffer[i])) {
+				queued = true;
+				mOverflow = false;
+				continue;
+			}
+			SensorMetrics::get().eventDropped(buffer[i].sensor);
+			if (!mOverflow) {
+				// the poll thread fell a full queue behind
+				ALOGW("sensor event queue full, dropping events");
+				mOverflow = true;
+			}
+		}
+	} while (n == READ_CHUNK || (n > 0 && mSensor->hasPendingEvents()));
+
+	if (queued) {
+		uint64_t notifyMessage = 1;
+		int result = write(mNotifyFd, &notifyMessage, sizeof(notifyMessage));
+		ALOGE_IF(result<0, "error notifying poll thread (%s)", strerror(errno));
+	}
+}
+
+void* SensorReader::threadLoop(void* arg)
+{
+	SensorReader* const reader = (SensorReader*)arg;
+	struct pollfd fds[2];
+
+	fds[0].fd = reader->mSensor->getFd();
+	fds[0].events = POLLIN;
+	fds[1].fd = reader->mKickFd;
+	fds[1].events = POLLIN;
+
+	while (!reader->mExitPending) {
+		fds[0].revents = fds[1].revents = 0;
+		int n = poll(fds, 2, -1);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			ALOGE("reader poll() failed (%s)", strerror(errno));
+			break;
+		}
+		if (fds[1].revents & POLLIN) {
+			uint64_t msg;
+			int result = read(reader->mKickFd, &msg, sizeof(msg));
+			ALOGE_IF(result<0, "error reading reader eventfd (%s)", strerror(errno));
+			if (reader->mExitPending)
+				break;
+		}
+		if ((fds[0].revents & POLLIN) || reader->mSensor->hasPendingEvents())
+			reader->drain();
+		if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+			// the node went away, hotplug detaches and stops us
+			fds[0].fd = -1;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,74 @@
+/* File         : SensorReader.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_READER_H
+#define ANDROID_SENSOR_READER_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include "SensorBase.h"
+#include "SensorEventQueue.h"
+
+/*****************************************************************************/
+
+/*
+ * A thread that reads one SensorBase and feeds its events into the
+ * shared SensorEventQueue, then signals the poll thread on notifyFd.
+ *
+ * The thread is the only one calling readEvents() on its sensor, so a
+ * slow node only ever holds up its own events. Binder threads still
+ * enable and pace the sensors meanwhile; the SensorInputDevice lock
+ * keeps that apart from the reads. kick() makes it drain events the
+ * sensor queued on its own, e.g. the initial proximity state set up by
+ * activate().
+ */
+class SensorReader
+{
+	enum {
+		READ_CHUNK = 16,
+	};
+
+	SensorBase* mSensor;
+	SensorEventQueue* mQueue;
+	int mNotifyFd;
+	int mKickFd;
+	pthread_t mThread;
+	bool mRunning;
+	volatile bool mExitPending;
+	bool mOverflow;
+
+	static void* threadLoop(void* arg);
+	void drain();
+
+	public:
+	SensorReader(SensorBase* sensor, SensorEventQueue* queue, int notifyFd);
+	~SensorReader();
+
+	SensorBase* getSensor() const { return mSensor; }
+
+	int start();
+	void stop();
+	void kick();
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SENSOR_READER_H
@@ -0,0 +1,113 @@
+/* File         : SysfsAttribute.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cutils/log.h>
+
+#include "SysfsAttribute.h"
+
+/*****************************************************************************/
+
+SysfsAttribute::SysfsAttribute()
+: mFd(-1)
+{
+	mPath[0] = '\0';
+}
+
+SysfsAttribute::~SysfsAttribute()
+{
+	if (mFd >= 0)
+		close(mFd);
+}
+
+void SysfsAttribute::setPath(const char* path)
+{
+	/* keep the open fd when the path did not change */
+	if (!strcmp(mPath, path))
+		return;
+	if (mFd >= 0) {
+		close(mFd);
+		mFd = -1;
+	}
+	strlcpy(mPath, path, sizeof(mPath));
+}
+
+#ifdef SENSORS_SYSFS_ROOT
+/*
+ * Host builds have no ISL drivers, so the attributes are plain files
+ * under SENSORS_SYSFS_ROOT, created on first use.
+ */
+static int openHostAttribute(const char* attr)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s%s", SENSORS_SYSFS_ROOT, attr);
+	for (char* p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+		*p = '\0';
+		mkdir(path, 0755);
+		*p = '/';
+	}
+	return open(path, O_WRONLY | O_CREAT, 0644);
+}
+#endif
+
+int SysfsAttribute::openAttribute()
+{
+	if (mFd < 0 && mPath[0]) {
+#ifdef SENSORS_SYSFS_ROOT
+		mFd = openHostAttribute(mPath);
+#else
+		mFd = open(mPath, O_WRONLY);
+#endif
+		ALOGE_IF(mFd<0, "Couldn't open %s (%s)", mPath, strerror(errno));
+	}
+	return mFd;
+}
+
+int SysfsAttribute::write(const char* buf, size_t len)
+{
+	if (openAttribute() < 0)
+		return -1;
+
+	if (pwrite(mFd, buf, len, 0) < 0) {
+		ALOGE("Couldn't write %s (%s)", mPath, strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+int SysfsAttribute::writeInt(int64_t value)
+{
+	char buf[24];
+	char* p = buf + sizeof(buf);
+	uint64_t v = value < 0 ? -(uint64_t)value : value;
+
+	/* format right to left, the kernel side parses with simple_strtoul */
+	do {
+		*--p = '0' + (v % 10);
+		v /= 10;
+	} while (v);
+	if (value < 0)
+		*--p = '-';
+
+	return write(p, buf + sizeof(buf) - p);
+}
@@ -0,0 +1,54 @@
+/* File         : SysfsAttribute.h
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SYSFS_ATTRIBUTE_H
+#define ANDROID_SYSFS_ATTRIBUTE_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+/*****************************************************************************/
+
+/*
+ * A sysfs control file that is opened on first use and then kept open.
+ * Every write goes out with pwrite() at offset 0, so activate/setDelay
+ * cost a single syscall instead of open/write/close and a path lookup.
+ */
+class SysfsAttribute
+{
+	char mPath[PATH_MAX];
+	int mFd;
+
+	int openAttribute();
+
+	public:
+	SysfsAttribute();
+	~SysfsAttribute();
+
+	void setPath(const char* path);
+	bool hasPath() const { return mPath[0] != '\0'; }
+
+	int write(const char* buf, size_t len);
+	int writeInt(int64_t value);
+};
+
+/*****************************************************************************/
+
+#endif  // ANDROID_SYSFS_ATTRIBUTE_H
@@ -22,53 +22,139 @@
 #include <errno.h>
 #include <dirent.h>
 #include <math.h>
-#include <poll.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <linux/input.h>
 #include <utils/Atomic.h>
 #include <utils/Log.h>
 
 #include "sensors.h"
+#include "SensorInputDevice.h"
+#include "InputDeviceIndex.h"
+#include "SensorEventFifo.h"
+#include "SensorEventQueue.h"
+#include "SensorReader.h"
+#include "SensorMetrics.h"
+#include "DirectChannel.h"
+#include "SensorParts.h"
 #include "LightSensor.h"
 #include "ProximitySensor.h"
+#include "RgbSensor.h"
 
 /*****************************************************************************/
 
-/* The SENSORS Module */
-static struct sensor_t sSensorList[] =
+/*
+ * The SENSORS Module
+ *
+ * The list is generated from isl_parts[] the first time it is asked for,
+ * with one entry per sensor of every part named in SENSORS_PARTS, and a
+ * wake-up variant of each proximity sensor after the non-wake-up one.
+ * A listed part whose driver has not probed yet is attached once its
+ * input device shows up. Without SENSORS_PARTS, only the parts whose
+ * input device exists at that point are listed.
+ * Handles are list index + 1, so a handle maps straight to its driver.
+ */
+static struct sensor_t sSensorList[ISL_MAX_SENSORS];
+static const struct isl_sensor_desc* sSensorDesc[ISL_MAX_SENSORS];
+static const struct isl_part_desc* sSensorPart[ISL_MAX_SENSORS];
+static bool sSensorWakeUp[ISL_MAX_SENSORS];
+static char sSensorNames[ISL_MAX_SENSORS][64];
+static int sSensorCount;
+static pthread_once_t sSensorListOnce = PTHREAD_ONCE_INIT;
+
+static void add_sensor(const struct isl_part_desc* part,
+		const struct isl_sensor_desc* desc, bool wakeUp)
 {
-	{
-	 "ISL Proximity",		/*   */
-	 "Intersil",
-	 1,
-	SENSORS_PROXIMITY_HANDLE, 
-	SENSOR_TYPE_PROXIMITY,
-	15.0f, 
-	15.0f, 
-	0.35f, 
-	0, 
-	1, 
-	0, 
-	{}
-	},
+	if (sSensorCount >= ISL_MAX_SENSORS) {
+		ALOGE("too many sensors, %s not listed", desc->name);
+		return;
+	}
+	struct sensor_t* sensor = &sSensorList[sSensorCount];
+	memset(sensor, 0, sizeof(*sensor));
+	sensor->name = desc->name;
+	sensor->vendor = "Intersil";
+	sensor->version = 1;
+	sensor->handle = sSensorCount + 1;
+	sensor->type = desc->type;
+	sensor->maxRange = desc->max_range;
+	sensor->resolution = desc->resolution;
+	sensor->power = desc->power;
+	sensor->minDelay = desc->min_delay;
+	sensor->fifoMaxEventCount = desc->fifo_max;
+#ifdef SENSORS_DEVICE_API_VERSION_1_3
+	sensor->stringType = desc->string_type;
+	if (desc->type == SENSOR_TYPE_PROXIMITY)
+		sensor->flags |= SENSOR_FLAG_ON_CHANGE_MODE;
+	/* LightSensor always filters on change, see isl_sensor_desc.hyst_abs */
+	if (desc->type == SENSOR_TYPE_LIGHT && desc->report < ISL_REPORT_RGB_LUX)
+		sensor->flags |= SENSOR_FLAG_ON_CHANGE_MODE;
+	if (wakeUp) {
+		snprintf(sSensorNames[sSensorCount], sizeof(sSensorNames[0]),
+				"%s Wake-up", desc->name);
+		sensor->name = sSensorNames[sSensorCount];
+		sensor->flags |= SENSOR_FLAG_WAKE_UP;
+		/* delivered in the poll() that woke us, never held back */
+		sensor->fifoMaxEventCount = 0;
+	}
+#endif
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	/*
+	 * direct report needs a rate the driver can be set to, and the
+	 * framework only takes it from continuous sensors
+	 */
+	if (part->delay_path && !wakeUp &&
+			!(sensor->flags & SENSOR_FLAG_MASK_REPORTING_MODE))
+		sensor->flags |= SENSOR_FLAG_DIRECT_CHANNEL_ASHMEM |
+			(SENSOR_DIRECT_RATE_NORMAL << SENSOR_FLAG_SHIFT_DIRECT_REPORT);
+#endif
+	sSensorDesc[sSensorCount] = desc;
+	sSensorPart[sSensorCount] = part;
+	sSensorWakeUp[sSensorCount] = wakeUp;
+	sSensorCount++;
+}
 
-	{
-	 "ISL Light", 
-	 "Intersil",
-	 1,
-	 SENSORS_LIGHT_HANDLE, 
-	 SENSOR_TYPE_LIGHT,
-	 50000.0f, 
-	 1.0f, 
-	 0.35f, 
-	 0, 
-	 1, 
-	 0, 
-	 {}
-	 },
-};
+/* whether SENSORS_PARTS names the part */
+static bool part_configured(const struct isl_part_desc* part)
+{
+	size_t len = strlen(part->input_name);
+
+	for (const char* p = SENSORS_PARTS; *p; ) {
+		p += strspn(p, " ,");
+		size_t n = strcspn(p, " ,");
+		if (n == len && !strncmp(p, part->input_name, len))
+			return true;
+		p += n;
+	}
+	return false;
+}
+
+static void build_sensor_list()
+{
+	InputDeviceIndex& index = InputDeviceIndex::get();
+	bool configured = SENSORS_PARTS[0] != '\0';
+	char node[PATH_MAX];
 
+	for (int i=0 ; i<isl_num_parts ; i++) {
+		const struct isl_part_desc* part = &isl_parts[i];
+		if (configured ? !part_configured(part) :
+				index.find(part->input_name, node, sizeof(node)) != 0)
+			continue;
+		for (int j=0 ; j<part->num_sensors ; j++) {
+			const struct isl_sensor_desc* desc = &part->sensors[j];
+			add_sensor(part, desc, false);
+#ifdef SENSORS_DEVICE_API_VERSION_1_3
+			/* proximity also comes as a wake-up sensor, e.g. for calls */
+			if (desc->type == SENSOR_TYPE_PROXIMITY)
+				add_sensor(part, desc, true);
+#endif
+		}
+	}
+	ALOGE_IF(!sSensorCount, "no Intersil sensor found");
+}
 
 static int open_sensors(const struct hw_module_t* module, const char* id,
 		struct hw_device_t** device);
@@ -76,10 +162,19 @@ static int open_sensors(const struct hw_module_t* module, const char* id,
 
 static int sensors__get_sensors_list(struct sensors_module_t* module, struct sensor_t const** list) 
 {
+	pthread_once(&sSensorListOnce, build_sensor_list);
 	*list = sSensorList;
-	return ARRAY_SIZE(sSensorList);
+	return sSensorCount;
 }
 
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+static int sensors__set_operation_mode(unsigned int mode)
+{
+	/* no data injection, only the normal mode */
+	return mode ? -EINVAL : 0;
+}
+#endif
+
 static struct hw_module_methods_t sensors_module_methods = {
 open: open_sensors
 };
@@ -95,137 +190,872 @@ tag: HARDWARE_MODULE_TAG,
      methods: &sensors_module_methods,
 	},
 get_sensors_list: sensors__get_sensors_list,
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+set_operation_mode: sensors__set_operation_mode,
+#endif
 };
 
 struct sensors_poll_context_t {
-	struct sensors_poll_device_t device; // must be first
+	struct sensors_poll_device_1 device; // must be first
 
 	sensors_poll_context_t();
 	~sensors_poll_context_t();
 	int activate(int handle, int enabled);
 	int setDelay(int handle, int64_t ns);
 	int pollEvents(sensors_event_t* data, int count);
+	int batch(int handle, int flags, int64_t period_ns, int64_t timeout);
+	int flush(int handle);
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	int registerDirectChannel(const struct sensors_direct_mem_t* mem,
+			int channel_handle);
+	int configDirectReport(int sensor_handle, int channel_handle,
+			int rate_level);
+#endif
 
 	private:
 	enum {
-		proximity,
-		light,
-		numSensorDrivers,
-		numFds,
+		MAX_POLLED_SENSORS = 8,
+		MAX_EPOLL_EVENTS = MAX_POLLED_SENSORS + 3,
+	};
+
+	/*
+	 * Every polled fd is registered with its SensorBase as the epoll
+	 * cookie, and with EPOLLWAKEUP if it serves a wake-up sensor; the
+	 * wake eventfd with a NULL cookie and the /dev/input inotify fd
+	 * with &mHotplugFd. The same inotify fd watches SENSORS_METRICS_DIR
+	 * on mMetricsWd for a dump request. mReady holds the sensors that
+	 * epoll reported or that still have events buffered; pollEvents()
+	 * only ever reads those.
+	 */
+	int mEpollFd;
+	int mWakeFd;
+	int mHotplugFd;
+	int mMetricsWd;
+	SensorBase* mPolled[MAX_POLLED_SENSORS];
+	int mNumPolled;
+	SensorBase* mReady[MAX_POLLED_SENSORS];
+	int mNumReady;
+
+	/*
+	 * With SENSORS_READER_THREADS, polled sensors are not in the epoll
+	 * set. Each gets a SensorReader, mReaders[i] for mPolled[i], which
+	 * pushes into mQueue and signals mQueueFd (epoll cookie &mQueueFd).
+	 */
+	SensorEventQueue mQueue;
+	int mQueueFd;
+	SensorReader* mReaders[MAX_POLLED_SENSORS];
+
+	/*
+	 * One SensorInputDevice per part, shared by the sensors of that part.
+	 * mSensors is indexed by handle - 1, in sSensorList order.
+	 */
+	SensorInputDevice* mInputDevices[ISL_MAX_SENSORS];
+	int mNumInputDevices;
+	SensorBase* mSensors[ISL_MAX_SENSORS];
+	int mNumSensors;
+
+	SensorInputDevice* inputDeviceFor(const struct isl_part_desc* part);
+
+	int addSensor(SensorBase* sensor);
+	bool servesWakeUp(SensorBase* input) const;
+	int removeSensor(SensorBase* sensor);
+	void markReady(SensorBase* sensor);
+	void handleHotplug();
+	void dumpMetrics();
+
+	/*
+	 * Batching state. The fifo and deadline belong to the poll thread,
+	 * the rest is written by batch()/flush() and guarded by mLock.
+	 */
+	SensorEventFifo mFifo;
+	int64_t mBatchDeadline;
+	pthread_mutex_t mLock;
+	int64_t mMaxReportLatency[ISL_MAX_SENSORS];
+	int mFlushPending[ISL_MAX_SENSORS];
+	bool mDrainFifo;
+
+	void sendWakeMessage();
+	int batchEvents(sensors_event_t* data, int count);
+	int routeEvents(sensors_event_t* data, int count);
+	int readBatchedEvents(sensors_event_t* data, int count);
+	bool batchDue();
+	int batchTimeout();
+
+	/*
+	 * Which sensors the framework activated and at which period, and
+	 * the enable and period that follow from that and from direct
+	 * report.
+	 */
+	bool mActivated[ISL_MAX_SENSORS];
+	int64_t mPeriodNs[ISL_MAX_SENSORS];
+	int updateEnable(int index);
+	int updatePeriod(int index);
+
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	enum {
+		MAX_DIRECT_CHANNELS = 4,
+		DIRECT_RATE_NORMAL_NS = 20000000,
 	};
 
-	static const size_t wake = numFds - 1;
-	static const char WAKE_MESSAGE = 'W';
-	struct pollfd mPollFds[numFds];
-	int mWritePipeFd;
-	SensorBase* mSensors[numSensorDrivers];
+	/*
+	 * Direct report state, written by registerDirectChannel() and
+	 * configDirectReport() and guarded by mLock. A sensor reports to at
+	 * most one channel. Its events only reach poll() as well if the
+	 * framework activated it too.
+	 */
+	DirectChannel* mChannels[MAX_DIRECT_CHANNELS];
+	int mDirectChannel[ISL_MAX_SENSORS];
+
+	int directEvents(sensors_event_t* data, int count);
+#endif
 
 	int handleToDriver(int handle) const {
-		switch (handle) {
-			case SENSORS_PROXIMITY_HANDLE:
-				return proximity;
-			case SENSORS_LIGHT_HANDLE:
-				return light;
-		}
-		return -EINVAL;
+		if (handle < 1 || handle > mNumSensors)
+			return -EINVAL;
+		return handle - 1;
+	}
+
+	int driverToHandle(int index) const {
+		return index + 1;
 	}
 };
 
 /*****************************************************************************/
 
 sensors_poll_context_t::sensors_poll_context_t()
+: mNumPolled(0),
+	mNumReady(0),
+	mNumInputDevices(0),
+	mNumSensors(0),
+	mFifo(SENSORS_FIFO_SIZE),
+	mBatchDeadline(INT64_MAX),
+	mDrainFifo(false)
 {
-	mSensors[light] = new LightSensor();
-	mPollFds[light].fd = mSensors[light]->getFd();
-	mPollFds[light].events = POLLIN;
-	mPollFds[light].revents = 0;
+	pthread_mutex_init(&mLock, NULL);
+	for (int i=0 ; i<ISL_MAX_SENSORS ; i++) {
+		mMaxReportLatency[i] = 0;
+		mFlushPending[i] = 0;
+		mActivated[i] = false;
+		mPeriodNs[i] = 0;
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+		mDirectChannel[i] = 0;
+#endif
+	}
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	for (int i=0 ; i<MAX_DIRECT_CHANNELS ; i++) {
+		mChannels[i] = NULL;
+	}
+#endif
+
+	mEpollFd = epoll_create(MAX_EPOLL_EVENTS);
+	ALOGE_IF(mEpollFd<0, "error creating epoll fd (%s)", strerror(errno));
+
+	mWakeFd = eventfd(0, EFD_NONBLOCK);
+	ALOGE_IF(mWakeFd<0, "error creating wake eventfd (%s)", strerror(errno));
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	int result = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFd, &ev);
+	ALOGE_IF(result<0, "error adding wake eventfd (%s)", strerror(errno));
+
+	pthread_once(&sSensorListOnce, build_sensor_list);
 
-	mSensors[proximity] = new ProximitySensor();
-	mPollFds[proximity].fd = mSensors[proximity]->getFd();
-	mPollFds[proximity].events = POLLIN;
-	mPollFds[proximity].revents = 0;
+	mQueueFd = -1;
+	if (SENSORS_READER_THREADS) {
+		mQueueFd = eventfd(0, EFD_NONBLOCK);
+		ev.data.ptr = &mQueueFd;
+		if (servesWakeUp(NULL))
+			ev.events |= EPOLLWAKEUP;
+		result = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mQueueFd, &ev);
+		ALOGE_IF(result<0, "error adding queue eventfd (%s)", strerror(errno));
+		ev.events = EPOLLIN;
+	}
+
+	/* attach input devices that are created after the HAL is opened */
+	mHotplugFd = inotify_init1(IN_NONBLOCK);
+	if (mHotplugFd >= 0 &&
+			inotify_add_watch(mHotplugFd, "/dev/input",
+				IN_CREATE | IN_ATTRIB | IN_DELETE) >= 0) {
+		ev.data.ptr = &mHotplugFd;
+		result = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mHotplugFd, &ev);
+		ALOGE_IF(result<0, "error adding hotplug fd (%s)", strerror(errno));
+	} else {
+		ALOGE("error watching /dev/input (%s)", strerror(errno));
+	}
 
-	int wakeFds[2];
-	int result = pipe(wakeFds);
-	ALOGE_IF(result<0, "error creating wake pipe (%s)", strerror(errno));
-	fcntl(wakeFds[0], F_SETFL, O_NONBLOCK);
-	fcntl(wakeFds[1], F_SETFL, O_NONBLOCK);
-	mWritePipeFd = wakeFds[1];
+	/* the directory is optional, without it there is just no dump */
+	mMetricsWd = -1;
+	if (SENSORS_METRICS && mHotplugFd >= 0)
+		mMetricsWd = inotify_add_watch(mHotplugFd, SENSORS_METRICS_DIR,
+				IN_CREATE | IN_MOVED_TO);
 
-	mPollFds[wake].fd = wakeFds[0];
-	mPollFds[wake].events = POLLIN;
-	mPollFds[wake].revents = 0;
+	for (int i=0 ; i<sSensorCount ; i++) {
+		SensorInputDevice* input = inputDeviceFor(sSensorPart[i]);
+		const struct isl_sensor_desc* desc = sSensorDesc[i];
+		if (desc->type == SENSOR_TYPE_PROXIMITY)
+			mSensors[i] = new ProximitySensor(input, desc, i + 1);
+		else if (desc->report >= ISL_REPORT_RGB_LUX)
+			mSensors[i] = new RgbSensor(input, desc, i + 1);
+		else
+			mSensors[i] = new LightSensor(input, desc, i + 1);
+		mNumSensors++;
+	}
+	for (int i=0 ; i<mNumInputDevices ; i++) {
+		if (mInputDevices[i]->isAttached())
+			addSensor(mInputDevices[i]);
+	}
 }
 
 sensors_poll_context_t::~sensors_poll_context_t() {
-	for (int i=0 ; i<numSensorDrivers ; i++) {
+	// readers go first, they call into the sensors
+	while (mNumPolled)
+		removeSensor(mPolled[0]);
+	for (int i=0 ; i<mNumSensors ; i++) {
 		delete mSensors[i];
 	}
-	close(mPollFds[wake].fd);
-	close(mWritePipeFd);
+	for (int i=0 ; i<mNumInputDevices ; i++) {
+		delete mInputDevices[i];
+	}
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	for (int i=0 ; i<MAX_DIRECT_CHANNELS ; i++) {
+		delete mChannels[i];
+	}
+#endif
+	if (mHotplugFd >= 0)
+		close(mHotplugFd);
+	if (mQueueFd >= 0)
+		close(mQueueFd);
+	close(mWakeFd);
+	close(mEpollFd);
+	pthread_mutex_destroy(&mLock);
+}
+
+SensorInputDevice* sensors_poll_context_t::inputDeviceFor(
+		const struct isl_part_desc* part)
+{
+	for (int i=0 ; i<mNumInputDevices ; i++) {
+		if (mInputDevices[i]->getPart() == part)
+			return mInputDevices[i];
+	}
+	SensorInputDevice* input = new SensorInputDevice(part);
+	mInputDevices[mNumInputDevices++] = input;
+	return input;
+}
+
+/*
+ * Adds or removes a readable sensor at runtime. Only called from the
+ * poll thread, which owns mPolled and mReady.
+ */
+int sensors_poll_context_t::addSensor(SensorBase* sensor)
+{
+	int fd = sensor->getFd();
+	if (fd < 0)
+		return -EINVAL;
+	if (mNumPolled >= MAX_POLLED_SENSORS)
+		return -ENOMEM;
+
+	if (SENSORS_READER_THREADS) {
+		SensorReader* reader = new SensorReader(sensor, &mQueue, mQueueFd);
+		int err = reader->start();
+		if (err < 0) {
+			delete reader;
+			return err;
+		}
+		mReaders[mNumPolled] = reader;
+		mPolled[mNumPolled++] = sensor;
+		return 0;
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	if (servesWakeUp(sensor))
+		ev.events |= EPOLLWAKEUP;
+	ev.data.ptr = sensor;
+	if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		ALOGE("error adding fd %d to epoll (%s)", fd, strerror(errno));
+		return -errno;
+	}
+	mPolled[mNumPolled++] = sensor;
+	if (sensor->hasPendingEvents())
+		markReady(sensor);
+	return 0;
+}
+
+/*
+ * Whether input reads a wake-up sensor, any input if NULL. Events on such
+ * a node hold a wakeup source from the moment they are queued until the
+ * next epoll_wait() on mEpollFd. pollEvents() therefore never calls it
+ * again once it has gathered events: they reach the framework, which
+ * takes its own wakelock for wake-up events, before the next poll()
+ * lets the wakeup source go.
+ */
+bool sensors_poll_context_t::servesWakeUp(SensorBase* input) const
+{
+	for (int i=0 ; i<sSensorCount ; i++) {
+		if (!sSensorWakeUp[i])
+			continue;
+		if (!input)
+			return true;
+		for (int j=0 ; j<mNumInputDevices ; j++) {
+			if (mInputDevices[j] == input &&
+					mInputDevices[j]->getPart() == sSensorPart[i])
+				return true;
+		}
+	}
+	return false;
+}
+
+int sensors_poll_context_t::removeSensor(SensorBase* sensor)
+{
+	if (!SENSORS_READER_THREADS)
+		epoll_ctl(mEpollFd, EPOLL_CTL_DEL, sensor->getFd(), NULL);
+
+	for (int i=0 ; i<mNumReady ; i++) {
+		if (mReady[i] == sensor) {
+			mReady[i] = mReady[--mNumReady];
+			break;
+		}
+	}
+	for (int i=0 ; i<mNumPolled ; i++) {
+		if (mPolled[i] == sensor) {
+			if (SENSORS_READER_THREADS) {
+				delete mReaders[i];
+				mReaders[i] = mReaders[mNumPolled - 1];
+			}
+			mPolled[i] = mPolled[--mNumPolled];
+			return 0;
+		}
+	}
+	return -EINVAL;
+}
+
+void sensors_poll_context_t::markReady(SensorBase* sensor)
+{
+	for (int i=0 ; i<mNumReady ; i++) {
+		if (mReady[i] == sensor)
+			return;
+	}
+	mReady[mNumReady++] = sensor;
+}
+
+/*
+ * Drains the inotify fd and attaches or detaches the shared input node.
+ * IN_ATTRIB is watched as well because ueventd creates the node before
+ * it fixes up the permissions, so the first open may fail. A trigger file
+ * created in SENSORS_METRICS_DIR dumps the counters instead.
+ */
+void sensors_poll_context_t::handleHotplug()
+{
+	char buf[sizeof(struct inotify_event) + NAME_MAX + 1];
+	bool changed = false;
+	ssize_t n;
+
+	while ((n = read(mHotplugFd, buf, sizeof(buf))) > 0) {
+		for (char* p = buf; p < buf + n; ) {
+			struct inotify_event* event = (struct inotify_event*)p;
+			p += sizeof(*event) + event->len;
+			if (event->wd == mMetricsWd) {
+				if (event->len && !strcmp(event->name, SENSORS_METRICS_TRIGGER))
+					dumpMetrics();
+				continue;
+			}
+			if (!event->len || strncmp(event->name, "event", 5))
+				continue;
+			for (int i=0 ; i<mNumInputDevices ; i++) {
+				SensorInputDevice* const input = mInputDevices[i];
+				if ((event->mask & IN_DELETE) && input->isAttached() &&
+						!strcmp(event->name, input->getInputName())) {
+					removeSensor(input);
+					input->detach();
+				}
+			}
+			changed = true;
+		}
+	}
+
+	if (!changed)
+		return;
+	InputDeviceIndex::get().invalidate();
+	for (int i=0 ; i<mNumInputDevices ; i++) {
+		SensorInputDevice* const input = mInputDevices[i];
+		if (!input->isAttached() && !input->attach()) {
+			ALOGI("attached input device %s", input->getInputName());
+			addSensor(input);
+		}
+	}
+}
+
+/* writes the counters to SENSORS_METRICS_FILE and consumes the request */
+void sensors_poll_context_t::dumpMetrics()
+{
+	int fd = open(SENSORS_METRICS_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		ALOGE("couldn't open %s (%s)", SENSORS_METRICS_FILE, strerror(errno));
+	} else {
+		SensorMetrics::get().dump(fd, sSensorList, sSensorCount);
+		close(fd);
+	}
+	unlink(SENSORS_METRICS_DIR "/" SENSORS_METRICS_TRIGGER);
+}
+
+void sensors_poll_context_t::sendWakeMessage() {
+	uint64_t wakeMessage = 1;
+	int result = write(mWakeFd, &wakeMessage, sizeof(wakeMessage));
+	ALOGE_IF(result<0, "error sending wake message (%s)", strerror(errno));
 }
 
 int sensors_poll_context_t::activate(int handle, int enabled) {
 	int index = handleToDriver(handle);
 	if (index < 0) return index;
-	int err =  mSensors[index]->enable(handle, enabled);
+	pthread_mutex_lock(&mLock);
+	mActivated[index] = enabled;
+	pthread_mutex_unlock(&mLock);
+	int err = updateEnable(index);
 	if (enabled && !err) {
-		const char wakeMessage(WAKE_MESSAGE);
-		int result = write(mWritePipeFd, &wakeMessage, 1);
-		ALOGE_IF(result<0, "error sending wake message (%s)", strerror(errno));
+		sendWakeMessage();
 	}
 	return err;
 }
 
+/* a sensor runs while the framework or a direct channel wants it */
+int sensors_poll_context_t::updateEnable(int index)
+{
+	pthread_mutex_lock(&mLock);
+	int enabled = mActivated[index];
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	if (mDirectChannel[index])
+		enabled = 1;
+#endif
+	pthread_mutex_unlock(&mLock);
+
+	// the reader of the node may be handing out events right now
+	SensorInputDevice* input = inputDeviceFor(sSensorPart[index]);
+	input->lock();
+	int err = mSensors[index]->enable(driverToHandle(index), enabled);
+	input->unlock();
+	return err;
+}
+
+/*
+ * The period the framework asked for, or the direct report rate while
+ * a channel takes the sensor if that is faster. 0 leaves the rate to
+ * the other sensors of the part.
+ */
+int sensors_poll_context_t::updatePeriod(int index)
+{
+	pthread_mutex_lock(&mLock);
+	int64_t ns = mPeriodNs[index];
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	if (mDirectChannel[index] && (!ns || ns > DIRECT_RATE_NORMAL_NS))
+		ns = DIRECT_RATE_NORMAL_NS;
+#endif
+	pthread_mutex_unlock(&mLock);
+
+	SensorInputDevice* input = inputDeviceFor(sSensorPart[index]);
+	input->lock();
+	int err = mSensors[index]->setDelay(driverToHandle(index), ns);
+	input->unlock();
+	return err;
+}
+
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+int sensors_poll_context_t::registerDirectChannel(
+		const struct sensors_direct_mem_t* mem, int channel_handle)
+{
+	if (mem) {
+		// only binder threads allocate, poll() never does
+		DirectChannel* channel = new DirectChannel();
+		int err = channel->map(mem);
+		if (err < 0) {
+			delete channel;
+			return err;
+		}
+
+		// the free slot is taken in the same critical section it is found
+		int i;
+		pthread_mutex_lock(&mLock);
+		for (i=0 ; i<MAX_DIRECT_CHANNELS && mChannels[i] ; i++)
+			;
+		if (i < MAX_DIRECT_CHANNELS)
+			mChannels[i] = channel;
+		pthread_mutex_unlock(&mLock);
+		if (i == MAX_DIRECT_CHANNELS) {
+			delete channel;
+			return -ENOMEM;
+		}
+		return i + 1;
+	}
+
+	if (channel_handle < 1 || channel_handle > MAX_DIRECT_CHANNELS)
+		return -EINVAL;
+
+	bool stopped[ISL_MAX_SENSORS];
+	pthread_mutex_lock(&mLock);
+	DirectChannel* channel = mChannels[channel_handle - 1];
+	mChannels[channel_handle - 1] = NULL;
+	for (int i=0 ; i<mNumSensors ; i++) {
+		stopped[i] = mDirectChannel[i] == channel_handle;
+		if (stopped[i])
+			mDirectChannel[i] = 0;
+	}
+	pthread_mutex_unlock(&mLock);
+
+	for (int i=0 ; i<mNumSensors ; i++) {
+		if (stopped[i]) {
+			updatePeriod(i);
+			updateEnable(i);
+		}
+	}
+	delete channel;
+	return 0;
+}
+
+int sensors_poll_context_t::configDirectReport(int sensor_handle,
+		int channel_handle, int rate_level)
+{
+	if (channel_handle < 1 || channel_handle > MAX_DIRECT_CHANNELS)
+		return -EINVAL;
+
+	// stop every sensor of the channel
+	if (sensor_handle == -1) {
+		if (rate_level != SENSOR_DIRECT_RATE_STOP)
+			return -EINVAL;
+		for (int i=0 ; i<mNumSensors ; i++) {
+			pthread_mutex_lock(&mLock);
+			bool stop = mDirectChannel[i] == channel_handle;
+			if (stop)
+				mDirectChannel[i] = 0;
+			pthread_mutex_unlock(&mLock);
+			if (stop) {
+				updatePeriod(i);
+				updateEnable(i);
+			}
+		}
+		return 0;
+	}
+
+	int index = handleToDriver(sensor_handle);
+	if (index < 0)
+		return index;
+	if (rate_level > int((sSensorList[index].flags &
+			SENSOR_FLAG_MASK_DIRECT_REPORT) >> SENSOR_FLAG_SHIFT_DIRECT_REPORT))
+		return -EINVAL;
+
+	pthread_mutex_lock(&mLock);
+	if (!mChannels[channel_handle - 1]) {
+		pthread_mutex_unlock(&mLock);
+		return -EINVAL;
+	}
+	if (rate_level == SENSOR_DIRECT_RATE_STOP) {
+		if (mDirectChannel[index] == channel_handle)
+			mDirectChannel[index] = 0;
+	} else {
+		mDirectChannel[index] = channel_handle;
+	}
+	pthread_mutex_unlock(&mLock);
+
+	// back to the framework's period once the channel lets go
+	updatePeriod(index);
+	int err = updateEnable(index);
+	if (err)
+		return err;
+	if (rate_level == SENSOR_DIRECT_RATE_STOP)
+		return 0;
+	sendWakeMessage();
+	// the sensor handle doubles as the report token
+	return sensor_handle;
+}
+
+/*
+ * Writes the events of sensors bound to a direct channel into it and
+ * compacts the rest. Returns the number of events left in data.
+ */
+int sensors_poll_context_t::directEvents(sensors_event_t* data, int count)
+{
+	int nb = 0;
+
+	pthread_mutex_lock(&mLock);
+	for (int i=0 ; i<count ; i++) {
+		int index = handleToDriver(data[i].sensor);
+		if (index >= 0 && mDirectChannel[index]) {
+			mChannels[mDirectChannel[index] - 1]->write(&data[i], 1,
+					data[i].sensor);
+			SensorMetrics::get().eventDirect(data[i].sensor);
+			if (!mActivated[index])
+				continue;
+		}
+		if (nb != i)
+			data[nb] = data[i];
+		nb++;
+	}
+	pthread_mutex_unlock(&mLock);
+	return nb;
+}
+#endif
+
 int sensors_poll_context_t::setDelay(int handle, int64_t ns) {
 
 	int index = handleToDriver(handle);
 	if (index < 0) return index;
-	return mSensors[index]->setDelay(handle, ns);
+	pthread_mutex_lock(&mLock);
+	mPeriodNs[index] = ns;
+	pthread_mutex_unlock(&mLock);
+	return updatePeriod(index);
+}
+
+int sensors_poll_context_t::batch(int handle, int flags, int64_t period_ns,
+		int64_t timeout) {
+	int index = handleToDriver(handle);
+	if (index < 0) return index;
+	if (period_ns < 0 || timeout < 0)
+		return -EINVAL;
+
+	// a dry run only checks the parameters, nothing is reprogrammed
+	if (flags & SENSORS_BATCH_DRY_RUN)
+		return 0;
+
+	pthread_mutex_lock(&mLock);
+	mPeriodNs[index] = period_ns;
+	pthread_mutex_unlock(&mLock);
+	int err = updatePeriod(index);
+
+	// wake-up events go out in the poll() that woke us, never batched
+	if (sSensorWakeUp[index])
+		timeout = 0;
+
+	pthread_mutex_lock(&mLock);
+	if (timeout < mMaxReportLatency[index]) {
+		// a shorter latency must not wait on the old deadline
+		mDrainFifo = true;
+	}
+	mMaxReportLatency[index] = timeout;
+	pthread_mutex_unlock(&mLock);
+	sendWakeMessage();
+	return err;
+}
+
+int sensors_poll_context_t::flush(int handle) {
+	int index = handleToDriver(handle);
+	if (index < 0) return index;
+
+	pthread_mutex_lock(&mLock);
+	mFlushPending[index]++;
+	pthread_mutex_unlock(&mLock);
+	sendWakeMessage();
+	return 0;
+}
+
+/*
+ * Hands events read from the sensors to direct channels and the batch
+ * fifo. Returns the number of events left in data for poll().
+ */
+int sensors_poll_context_t::routeEvents(sensors_event_t* data, int count)
+{
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	if (count > 0)
+		count = directEvents(data, count);
+#endif
+	if (count > 0)
+		count = batchEvents(data, count);
+	return count;
+}
+
+/*
+ * Moves the events of batching sensors from data into the fifo and
+ * compacts the rest. Returns the number of events left in data.
+ */
+int sensors_poll_context_t::batchEvents(sensors_event_t* data, int count)
+{
+	int64_t latency[ISL_MAX_SENSORS];
+	int64_t now = SensorBase::getTimestamp();
+	int nb = 0;
+
+	pthread_mutex_lock(&mLock);
+	memcpy(latency, mMaxReportLatency, sizeof(latency));
+	pthread_mutex_unlock(&mLock);
+
+	for (int i=0 ; i<count ; i++) {
+		int index = handleToDriver(data[i].sensor);
+		if (index >= 0 && latency[index] > 0 && mFifo.push(&data[i], 1)) {
+			if (now + latency[index] < mBatchDeadline)
+				mBatchDeadline = now + latency[index];
+			continue;
+		}
+		if (nb != i)
+			data[nb] = data[i];
+		nb++;
+	}
+	return nb;
+}
+
+/*
+ * Hands out the fifo once it is full, the earliest report latency has
+ * expired, or a flush was requested. Flush complete markers follow the
+ * events that were queued before them.
+ */
+int sensors_poll_context_t::readBatchedEvents(sensors_event_t* data, int count)
+{
+	int nb = 0;
+
+	if (!count || !batchDue())
+		return 0;
+
+	nb = mFifo.pop(data, count);
+	if (!mFifo.isEmpty())
+		return nb;
+
+	mBatchDeadline = INT64_MAX;
+	pthread_mutex_lock(&mLock);
+	mDrainFifo = false;
+	for (int i=0 ; i<mNumSensors ; i++) {
+		while (mFlushPending[i] && nb < count) {
+			sensors_event_t* const event = &data[nb++];
+			memset(event, 0, sizeof(*event));
+			event->version = META_DATA_VERSION;
+			event->type = SENSOR_TYPE_META_DATA;
+			event->meta_data.what = META_DATA_FLUSH_COMPLETE;
+			event->meta_data.sensor = driverToHandle(i);
+			mFlushPending[i]--;
+		}
+	}
+	pthread_mutex_unlock(&mLock);
+	return nb;
+}
+
+bool sensors_poll_context_t::batchDue()
+{
+	bool due = false;
+
+	pthread_mutex_lock(&mLock);
+	for (int i=0 ; i<mNumSensors ; i++) {
+		if (mFlushPending[i])
+			due = true;
+	}
+	if (mDrainFifo && !mFifo.isEmpty())
+		due = true;
+	pthread_mutex_unlock(&mLock);
+
+	if (!mFifo.isEmpty() && (mFifo.isFull() ||
+			SensorBase::getTimestamp() >= mBatchDeadline))
+		due = true;
+	return due;
+}
+
+/* epoll_wait() timeout in ms until the next batch is due, -1 if nothing is queued */
+int sensors_poll_context_t::batchTimeout()
+{
+	if (mFifo.isEmpty())
+		return -1;
+
+	int64_t left = mBatchDeadline - SensorBase::getTimestamp();
+	if (left <= 0)
+		return 0;
+	left = (left + 999999) / 1000000;
+	return left > INT_MAX ? INT_MAX : int(left);
 }
 
 int sensors_poll_context_t::pollEvents(sensors_event_t* data, int count)
 {
+	sensors_event_t* const first = data;
 	int nbEvents = 0;
 	int n = 0;
 
 	do {
-		// see if we have some leftover from the last poll()
-		for (int i=0 ; count && i<numSensorDrivers ; i++) {
-			SensorBase* const sensor(mSensors[i]);
-			if ((mPollFds[i].revents & POLLIN) || (sensor->hasPendingEvents())) {
-				int nb = sensor->readEvents(data, count);
-				if (nb < count) {
-					// no more data for this sensor
-					mPollFds[i].revents = 0;
-				}
+		// deliver what the batching sensors have queued, once it is due
+		int nb = readBatchedEvents(data, count);
+		count -= nb;
+		nbEvents += nb;
+		data += nb;
+
+		// take what the reader threads queued, same limit as below
+		if (SENSORS_READER_THREADS && count) {
+			int room = count < int(mFifo.space()) ? count : int(mFifo.space());
+			nb = routeEvents(data, mQueue.pop(data, room));
+			count -= nb;
+			nbEvents += nb;
+			data += nb;
+		}
+
+		// read the sensors that are ready, but never read more than
+		// the batch fifo could take if it all gets queued
+		for (int i=0 ; count && i<mNumReady ; ) {
+			int room = count < int(mFifo.space()) ? count : int(mFifo.space());
+			if (!room)
+				break;
+			SensorBase* const sensor(mReady[i]);
+			nb = sensor->readEvents(data, room);
+			if (nb < room && !sensor->hasPendingEvents()) {
+				// no more data for this sensor
+				mReady[i] = mReady[--mNumReady];
+			} else {
+				i++;
+			}
+			for (int j=0 ; j<nb ; j++)
+				SensorMetrics::get().eventRead(data[j].sensor);
+			if (nb > 0) {
+				nb = routeEvents(data, nb);
 				count -= nb;
 				nbEvents += nb;
 				data += nb;
 			}
 		}
 
-		if (count) {
-			// we still have some room, so try to see if we can get
-			// some events immediately or just wait if we don't have
-			// anything to return
+		if (count && !nbEvents) {
+			// nothing to return yet, so wait. Once events are gathered
+			// they go out first: another epoll_wait() would release the
+			// EPOLLWAKEUP source that holds them
+			struct epoll_event events[MAX_EPOLL_EVENTS];
 			do {
-				n = poll(mPollFds, numFds, nbEvents ? 0 : -1);
+				n = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS,
+						batchTimeout());
 			} while (n < 0 && errno == EINTR);
 			if (n<0) {
-				ALOGE("poll() failed (%s)", strerror(errno));
+				ALOGE("epoll_wait() failed (%s)", strerror(errno));
 				return -errno;
 			}
-			if (mPollFds[wake].revents & POLLIN) {
-				char msg;
-				int result = read(mPollFds[wake].fd, &msg, 1);
-				ALOGE_IF(result<0, "error reading from wake pipe (%s)", strerror(errno));
-				ALOGE_IF(msg != WAKE_MESSAGE, "unknown message on wake queue (0x%02x)", int(msg));
-				mPollFds[wake].revents = 0;
+			for (int i=0 ; i<n ; i++) {
+				if (events[i].data.ptr == &mHotplugFd) {
+					handleHotplug();
+					continue;
+				}
+				if (events[i].data.ptr == &mQueueFd) {
+					// the queue itself is drained at the top of the loop
+					uint64_t msg;
+					int result = read(mQueueFd, &msg, sizeof(msg));
+					ALOGE_IF(result<0, "error reading queue eventfd (%s)", strerror(errno));
+					continue;
+				}
+				SensorBase* const sensor = (SensorBase*)events[i].data.ptr;
+				if (sensor) {
+					markReady(sensor);
+					continue;
+				}
+				uint64_t msg;
+				int result = read(mWakeFd, &msg, sizeof(msg));
+				ALOGE_IF(result<0, "error reading from wake eventfd (%s)", strerror(errno));
+				// activate() may have queued an initial event
+				for (int j=0 ; j<mNumPolled ; j++) {
+					if (SENSORS_READER_THREADS)
+						mReaders[j]->kick();
+					else if (mPolled[j]->hasPendingEvents())
+						markReady(mPolled[j]);
+				}
 			}
 		}
-		// if we have events and space, go read them
-	} while (n && count);
+		// if epoll reported something, go read it
+	} while (!nbEvents && (n || batchDue()) && count);
+
+	if (SENSORS_METRICS && nbEvents) {
+		int64_t now = SensorBase::getTimestamp();
+		for (int i=0 ; i<nbEvents ; i++) {
+			if (first[i].type != SENSOR_TYPE_META_DATA)
+				SensorMetrics::get().eventDelivered(first[i].sensor,
+						now - first[i].timestamp);
+		}
+	}
 	return nbEvents;
 }
 
@@ -258,6 +1088,39 @@ static int poll__poll(struct sensors_poll_device_t *dev,
 	return ctx->pollEvents(data, count);
 }
 
+static int poll__batch(struct sensors_poll_device_1 *dev,
+		int handle, int flags, int64_t period_ns, int64_t timeout) {
+	sensors_poll_context_t *ctx = (sensors_poll_context_t *)dev;
+	return ctx->batch(handle, flags, period_ns, timeout);
+}
+
+static int poll__flush(struct sensors_poll_device_1 *dev,
+		int handle) {
+	sensors_poll_context_t *ctx = (sensors_poll_context_t *)dev;
+	return ctx->flush(handle);
+}
+
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+static int poll__inject_sensor_data(struct sensors_poll_device_1 *dev,
+		const sensors_event_t *data) {
+	return -EINVAL;
+}
+
+static int poll__register_direct_channel(struct sensors_poll_device_1 *dev,
+		const struct sensors_direct_mem_t* mem, int channel_handle) {
+	sensors_poll_context_t *ctx = (sensors_poll_context_t *)dev;
+	return ctx->registerDirectChannel(mem, channel_handle);
+}
+
+static int poll__config_direct_report(struct sensors_poll_device_1 *dev,
+		int sensor_handle, int channel_handle,
+		const struct sensors_direct_cfg_t *config) {
+	sensors_poll_context_t *ctx = (sensors_poll_context_t *)dev;
+	return ctx->configDirectReport(sensor_handle, channel_handle,
+			config->rate_level);
+}
+#endif
+
 /*****************************************************************************/
 
 /** Open a new instance of a sensor device using name */
@@ -267,15 +1130,26 @@ static int open_sensors(const struct hw_module_t* module, const char* id,
 	int status = -EINVAL;
 	sensors_poll_context_t *dev = new sensors_poll_context_t();
 
-	memset(&dev->device, 0, sizeof(sensors_poll_device_t));
+	memset(&dev->device, 0, sizeof(sensors_poll_device_1));
 
 	dev->device.common.tag = HARDWARE_DEVICE_TAG;
-	dev->device.common.version  = 0;
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	dev->device.common.version  = SENSORS_DEVICE_API_VERSION_1_4;
+#else
+	dev->device.common.version  = SENSORS_DEVICE_API_VERSION_1_1;
+#endif
 	dev->device.common.module   = const_cast<hw_module_t*>(module);
 	dev->device.common.close    = poll__close;
 	dev->device.activate	    = poll__activate;
 	dev->device.setDelay	    = poll__setDelay;
 	dev->device.poll	    = poll__poll;
+	dev->device.batch	    = poll__batch;
+	dev->device.flush	    = poll__flush;
+#ifdef SENSORS_DEVICE_API_VERSION_1_4
+	dev->device.inject_sensor_data = poll__inject_sensor_data;
+	dev->device.register_direct_channel = poll__register_direct_channel;
+	dev->device.config_direct_report = poll__config_direct_report;
+#endif
 
 	*device = &dev->device.common;
 	status = 0;
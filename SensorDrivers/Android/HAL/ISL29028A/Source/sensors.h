@@ -30,14 +30,59 @@
 
 __BEGIN_DECLS
 
-#define DEVICE_NAME		"isl29028A"
-#define PROX_ENABLE_SYSPATH	"/sys/intersil/isl29028A/prox_status"
-#define ALS_ENABLE_SYSPATH	"/sys/intersil/isl29028A/als_status"	
-
 /*****************************************************************************/
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
 
+/* events held back in the HAL while a sensor is batching */
+#define SENSORS_FIFO_SIZE			128
+
+/* read every input node on its own thread instead of inline in poll() */
+#ifndef SENSORS_READER_THREADS
+#define SENSORS_READER_THREADS			0
+#endif
+
+/*
+ * Clock of every event timestamp. CLOCK_MONOTONIC by default, 1 to stamp
+ * in CLOCK_BOOTTIME like SystemClock.elapsedRealtimeNanos(), which keeps
+ * counting while the device is suspended.
+ */
+#ifndef SENSORS_CLOCK_BOOTTIME
+#define SENSORS_CLOCK_BOOTTIME			0
+#endif
+
+#if SENSORS_CLOCK_BOOTTIME
+#define SENSORS_CLOCK				CLOCK_BOOTTIME
+#else
+#define SENSORS_CLOCK				CLOCK_MONOTONIC
+#endif
+
+/* count events, drops and delivery latency, see SensorMetrics */
+#ifndef SENSORS_METRICS
+#define SENSORS_METRICS				1
+#endif
+
+/* creating the trigger file in SENSORS_METRICS_DIR dumps the counters */
+#define SENSORS_METRICS_DIR			"/data/misc/sensors"
+#define SENSORS_METRICS_TRIGGER			"isl_metrics.dump"
+#define SENSORS_METRICS_FILE			SENSORS_METRICS_DIR "/isl_metrics.txt"
+
+/* record the raw input of every sensor node, see SensorCaptureWriter */
+#ifndef SENSORS_CAPTURE
+#define SENSORS_CAPTURE				0
+#endif
+
+/*
+ * Input device names of the parts on the board, separated by spaces or
+ * commas. Empty lists the parts found when the list is built instead.
+ */
+#ifndef SENSORS_PARTS
+#define SENSORS_PARTS				""
+#endif
+
+#define SENSORS_CAPTURE_FILE			SENSORS_METRICS_DIR "/isl_capture.bin"
+#define SENSORS_CAPTURE_SIZE			(4 * 1024 * 1024)
+
 #define SENSORS_ACCELERATION_HANDLE		0
 #define SENSORS_MAGNETIC_FIELD_HANDLE		1
 #define SENSORS_ORIENTATION_HANDLE		2
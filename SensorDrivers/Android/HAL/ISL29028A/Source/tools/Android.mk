@@ -0,0 +1,53 @@
+LOCAL_PATH := $(call my-dir)
+
+# Feeds captured, recorded or generated evdev frames into a uinput device
+# that looks like one of the ISL drivers. Needs write access to /dev/uinput.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := isl_replay
+
+LOCAL_C_INCLUDES := hardware/libhardware/include $(LOCAL_PATH)/..
+
+LOCAL_SRC_FILES := isl_replay.cpp
+
+# for SensorCaptureReader
+LOCAL_STATIC_LIBRARIES := libsensors_isl_host libcutils liblog
+
+LOCAL_LDLIBS := -lpthread
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# Polls the host build of the HAL and reports throughput and latency,
+# run it against isl_replay.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := isl_bench
+
+LOCAL_C_INCLUDES := hardware/libhardware/include $(LOCAL_PATH)/..
+
+LOCAL_SRC_FILES := isl_bench.cpp
+
+LOCAL_STATIC_LIBRARIES := libsensors_isl_host libcutils liblog
+
+LOCAL_LDLIBS := -lpthread -lrt
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# Drains evdev bursts from a pipe through the HAL ring and through the
+# reader it replaced, and reports events/s for both.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := isl_reader_bench
+
+LOCAL_C_INCLUDES := hardware/libhardware/include $(LOCAL_PATH)/..
+
+# the ring size has to match the one libsensors_isl_host was built with
+LOCAL_CFLAGS := $(isl_sensors_cflags)
+
+LOCAL_SRC_FILES := isl_reader_bench.cpp
+
+LOCAL_STATIC_LIBRARIES := libsensors_isl_host libcutils liblog
+
+LOCAL_LDLIBS := -lrt
+
+include $(BUILD_HOST_EXECUTABLE)
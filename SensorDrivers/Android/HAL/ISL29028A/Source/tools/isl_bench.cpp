@@ -0,0 +1,216 @@
+/* File         : isl_bench.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * isl_bench - opens the HAL like the framework does, activates every
+ * sensor at the requested period and polls for a while, then reports
+ *
+ *  - events per second returned by poll()
+ *  - latency percentiles from the event time to the return of poll()
+ *  - syscalls per event, counted for the whole process through the
+ *    raw_syscalls:sys_enter tracepoint where perf events allow it
+ *
+ * Run it against isl_replay on a host, or on a board with the parts.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <hardware/hardware.h>
+#include <hardware/sensors.h>
+
+#include "sensors.h"
+
+extern struct sensors_module_t HAL_MODULE_INFO_SYM;
+
+/*****************************************************************************/
+
+#define MAX_SAMPLES			(1 << 22)
+#define POLL_EVENTS			64
+
+static int64_t sLatency[MAX_SAMPLES];
+static volatile int sNumSamples;
+static volatile bool sStop;
+
+static int64_t now_ns()
+{
+	struct timespec t;
+	clock_gettime(SENSORS_CLOCK, &t);
+	return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+/*
+ * A counter of every syscall entered by this process and the threads it
+ * starts from here on, such as the HAL reader threads. It starts out
+ * disabled; -1 if tracepoints are not accessible.
+ */
+static int open_syscall_counter()
+{
+	static const char* const paths[] = {
+		"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+		"/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+	};
+	char buf[32];
+	int fd = -1;
+
+	for (size_t i = 0; fd < 0 && i < sizeof(paths) / sizeof(paths[0]); i++)
+		fd = open(paths[i], O_RDONLY);
+	if (fd < 0)
+		return -1;
+	ssize_t n = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (n <= 0)
+		return -1;
+	buf[n] = '\0';
+
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_TRACEPOINT;
+	attr.config = strtoull(buf, NULL, 10);
+	attr.inherit = 1;
+	attr.disabled = 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t read_counter(int fd)
+{
+	uint64_t count = 0;
+	if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+		return 0;
+	return count;
+}
+
+static void* poll_thread(void* arg)
+{
+	sensors_poll_device_1_t* dev = (sensors_poll_device_1_t*)arg;
+	sensors_event_t buffer[POLL_EVENTS];
+
+	while (!sStop) {
+		int n = dev->poll(&dev->v0, buffer, POLL_EVENTS);
+		int64_t now = now_ns();
+		if (n < 0) {
+			fprintf(stderr, "poll failed (%s)\n", strerror(-n));
+			break;
+		}
+		for (int i = 0; i < n; i++) {
+			int index = sNumSamples;
+			if (buffer[i].type == SENSOR_TYPE_META_DATA ||
+					index == MAX_SAMPLES)
+				continue;
+			sLatency[index] = now - buffer[i].timestamp;
+			__atomic_store_n(&sNumSamples, index + 1, __ATOMIC_RELEASE);
+		}
+	}
+	return NULL;
+}
+
+static int compare_latency(const void* a, const void* b)
+{
+	int64_t d = *(const int64_t*)a - *(const int64_t*)b;
+	return d < 0 ? -1 : d > 0;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: isl_bench [-t seconds] [-p period_ms]\n"
+		"  -t  seconds to poll, default 10\n"
+		"  -p  sampling period asked of every sensor, default 10\n");
+}
+
+int main(int argc, char** argv)
+{
+	int seconds = 10;
+	int period = 10;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:p:")) != -1) {
+		switch (opt) {
+		case 't': seconds = atoi(optarg); break;
+		case 'p': period = atoi(optarg); break;
+		default: usage(); return 1;
+		}
+	}
+
+	int counter = open_syscall_counter();
+
+	struct hw_module_t* module = &HAL_MODULE_INFO_SYM.common;
+	struct hw_device_t* device;
+	int err = module->methods->open(module, SENSORS_HARDWARE_POLL, &device);
+	if (err) {
+		fprintf(stderr, "couldn't open the HAL (%s)\n", strerror(-err));
+		return 1;
+	}
+	sensors_poll_device_1_t* dev = (sensors_poll_device_1_t*)device;
+
+	struct sensor_t const* list;
+	int count = HAL_MODULE_INFO_SYM.get_sensors_list(&HAL_MODULE_INFO_SYM, &list);
+	if (count <= 0) {
+		fprintf(stderr, "no sensors, is isl_replay running?\n");
+		return 1;
+	}
+	for (int i = 0; i < count; i++) {
+		dev->setDelay(&dev->v0, list[i].handle, period * 1000000LL);
+		err = dev->activate(&dev->v0, list[i].handle, 1);
+		printf("%d %s%s\n", list[i].handle, list[i].name,
+				err ? " (activate failed)" : "");
+	}
+
+	if (counter >= 0)
+		ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+
+	pthread_t thread;
+	int64_t start = now_ns();
+	pthread_create(&thread, NULL, poll_thread, dev);
+	sleep(seconds);
+	sStop = true;
+
+	// poll() may block for good once the replay ends, so no join
+	int n = __atomic_load_n(&sNumSamples, __ATOMIC_ACQUIRE);
+	double elapsed = (now_ns() - start) / 1e9;
+	uint64_t syscalls = read_counter(counter);
+
+	printf("\n%d events in %.3f s, %.0f events/s\n", n, elapsed, n / elapsed);
+	if (!n)
+		return 1;
+
+	qsort(sLatency, n, sizeof(sLatency[0]), compare_latency);
+	static const double percentiles[] = { 50, 90, 99, 99.9, 100 };
+	for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+		int index = (int)(percentiles[i] / 100 * (n - 1));
+		printf("latency p%-5g %8.1f us\n", percentiles[i],
+				sLatency[index] / 1000.0);
+	}
+
+	if (counter >= 0)
+		printf("%.2f syscalls per event\n", (double)syscalls / n);
+	else
+		printf("syscalls per event: no tracepoint access, "
+				"try perf_event_paranoid -1 or strace -c -f\n");
+	_exit(0);
+}
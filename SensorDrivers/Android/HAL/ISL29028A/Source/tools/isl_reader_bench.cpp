@@ -0,0 +1,285 @@
+/* File         : isl_reader_bench.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * isl_reader_bench - drains bursts of evdev frames from a pipe through
+ *
+ *  - the InputEventCircularReader ring of the HAL, with one read() per
+ *    fill and bulk readEvents()/consume()
+ *  - the reader it replaced, copied below as LegacyEventReader, sized
+ *    to the 4 events the old HAL asked for and drained one readEvent()
+ *    and next() per event
+ *
+ * and reports events per second and read() calls per event for both.
+ * Only the drain is timed, writing the burst into the pipe is not.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+
+#include "sensors.h"
+#include "InputEventReader.h"
+
+/*****************************************************************************/
+
+#define LEGACY_NUM_EVENTS		4
+
+/* one frame as the ISL drivers send it: two values and a sync */
+#define EVENTS_PER_FRAME		3
+
+/*
+ * The InputEventCircularReader of the original HAL: a buffer of twice
+ * numEvents where fill() copies whatever ran past the end back to the
+ * start, and events are handed out one at a time.
+ */
+class LegacyEventReader
+{
+	struct input_event* const mBuffer;
+	struct input_event* const mBufferEnd;
+	struct input_event* mHead;
+	struct input_event* mCurr;
+	ssize_t mFreeSpace;
+
+	public:
+	LegacyEventReader(size_t numEvents);
+	~LegacyEventReader();
+	ssize_t fill(int fd);
+	ssize_t readEvent(input_event const** events);
+	void next();
+};
+
+LegacyEventReader::LegacyEventReader(size_t numEvents)
+: mBuffer(new input_event[numEvents * 2]),
+	mBufferEnd(mBuffer + numEvents),
+	mHead(mBuffer),
+	mCurr(mBuffer),
+	mFreeSpace(numEvents)
+{
+}
+
+LegacyEventReader::~LegacyEventReader()
+{
+	delete [] mBuffer;
+}
+
+ssize_t LegacyEventReader::fill(int fd)
+{
+	size_t numEventsRead = 0;
+	if (mFreeSpace) {
+		const ssize_t nread = read(fd, mHead, mFreeSpace * sizeof(input_event));
+		if (nread<0 || nread % sizeof(input_event)) {
+			// we got a partial event!!
+			return nread<0 ? -errno : -EINVAL;
+		}
+
+		numEventsRead = nread / sizeof(input_event);
+		if (numEventsRead) {
+			mHead += numEventsRead;
+			mFreeSpace -= numEventsRead;
+			if (mHead > mBufferEnd) {
+				size_t s = mHead - mBufferEnd;
+				memcpy(mBuffer, mBufferEnd, s * sizeof(input_event));
+				mHead = mBuffer + s;
+			}
+		}
+	}
+	return numEventsRead;
+}
+
+ssize_t LegacyEventReader::readEvent(input_event const** events)
+{
+	*events = mCurr;
+	ssize_t available = (mBufferEnd - mBuffer) - mFreeSpace;
+	return available ? 1 : 0;
+}
+
+void LegacyEventReader::next()
+{
+	mCurr++;
+	mFreeSpace++;
+	if (mCurr >= mBufferEnd) {
+		mCurr = mBuffer;
+	}
+}
+
+/*****************************************************************************/
+
+struct result {
+	int64_t events;
+	int64_t reads;
+	int64_t ns;
+	int64_t sum;
+};
+
+static int64_t now_ns()
+{
+	struct timespec t;
+	clock_gettime(SENSORS_CLOCK, &t);
+	return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static void make_burst(struct input_event* burst, int frames)
+{
+	memset(burst, 0, frames * EVENTS_PER_FRAME * sizeof(burst[0]));
+	for (int i=0 ; i<frames ; i++) {
+		struct input_event* e = &burst[i * EVENTS_PER_FRAME];
+		e[0].type = EV_ABS;
+		e[0].code = ABS_MISC;
+		e[0].value = i;
+		e[1].type = EV_ABS;
+		e[1].code = ABS_DISTANCE;
+		e[1].value = i & 1;
+		e[2].type = EV_SYN;
+		e[2].code = SYN_REPORT;
+	}
+}
+
+/* the old per-event loop of the SensorBase readEvents() */
+static int64_t drain_legacy(LegacyEventReader& reader, int fd, struct result* r)
+{
+	input_event const* event;
+	int64_t sum = 0;
+	ssize_t n;
+
+	while ((n = reader.fill(fd)) > 0) {
+		r->reads++;
+		while (reader.readEvent(&event)) {
+			sum += event->type == EV_ABS ? event->value : 1;
+			r->events++;
+			reader.next();
+		}
+	}
+	if (n < 0 && n != -EAGAIN)
+		fprintf(stderr, "legacy fill failed (%s)\n", strerror(-n));
+	return sum;
+}
+
+static int64_t drain_ring(InputEventCircularReader& reader, int fd,
+		struct result* r)
+{
+	input_event const* events;
+	int64_t sum = 0;
+	ssize_t n;
+
+	while ((n = reader.fill(fd)) > 0) {
+		r->reads++;
+		ssize_t count;
+		while ((count = reader.readEvents(&events)) > 0) {
+			for (ssize_t i=0 ; i<count ; i++)
+				sum += events[i].type == EV_ABS ? events[i].value : 1;
+			r->events += count;
+			reader.consume(count);
+		}
+	}
+	if (n < 0)
+		fprintf(stderr, "ring fill failed (%s)\n", strerror(-n));
+	return sum;
+}
+
+static int run(bool legacy, int fds[2], struct input_event const* burst,
+		size_t size, int64_t duration, struct result* r)
+{
+	LegacyEventReader legacyReader(LEGACY_NUM_EVENTS);
+	InputEventCircularReader ring;
+	int64_t end = now_ns() + duration;
+
+	memset(r, 0, sizeof(*r));
+	while (now_ns() < end) {
+		if (write(fds[1], burst, size) != (ssize_t)size) {
+			fprintf(stderr, "couldn't write a burst (%s)\n", strerror(errno));
+			return -1;
+		}
+		int64_t start = now_ns();
+		r->sum += legacy ? drain_legacy(legacyReader, fds[0], r)
+				: drain_ring(ring, fds[0], r);
+		r->ns += now_ns() - start;
+		// the empty read that ended the drain
+		r->reads++;
+	}
+	return 0;
+}
+
+static void report(const char* name, struct result const* r)
+{
+	printf("%-8s %12lld events %14.0f events/s %6.3f reads/event\n", name,
+			(long long)r->events, r->events * 1e9 / r->ns,
+			(double)r->reads / r->events);
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: isl_reader_bench [-t seconds] [-f frames]\n"
+		"  -t  seconds per reader, default 5\n"
+		"  -f  frames per burst written to the pipe, default 16\n");
+}
+
+int main(int argc, char** argv)
+{
+	int seconds = 5;
+	int frames = 16;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:f:")) != -1) {
+		switch (opt) {
+		case 't': seconds = atoi(optarg); break;
+		case 'f': frames = atoi(optarg); break;
+		default: usage(); return 1;
+		}
+	}
+
+	// a whole burst has to fit the default 64KiB of a pipe
+	size_t size = frames * EVENTS_PER_FRAME * sizeof(struct input_event);
+	if (seconds <= 0 || frames <= 0 || size > 65536) {
+		usage();
+		return 1;
+	}
+
+	int fds[2];
+	if (pipe(fds) < 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) < 0) {
+		fprintf(stderr, "couldn't set up the pipe (%s)\n", strerror(errno));
+		return 1;
+	}
+
+	struct input_event* burst = new input_event[frames * EVENTS_PER_FRAME];
+	make_burst(burst, frames);
+
+	struct result legacy, ring;
+	int64_t duration = seconds * 1000000000LL;
+	if (run(true, fds, burst, size, duration, &legacy) ||
+			run(false, fds, burst, size, duration, &ring))
+		return 1;
+
+	printf("%d frames of %d events per burst\n", frames, EVENTS_PER_FRAME);
+	report("legacy", &legacy);
+	report("ring", &ring);
+	if (legacy.sum / legacy.events != ring.sum / ring.events)
+		printf("warning: the readers saw different events\n");
+	printf("speedup  %.2fx\n", (ring.events * 1e9 / ring.ns) /
+			(legacy.events * 1e9 / legacy.ns));
+
+	delete [] burst;
+	return 0;
+}
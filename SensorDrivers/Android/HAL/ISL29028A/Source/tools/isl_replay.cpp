@@ -0,0 +1,390 @@
+/* File         : isl_replay.cpp
+ * Ver          : 1.0
+ *
+ * Copyright (C) 2013 Intersil Corporation
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * isl_replay - plays evdev frames through a uinput device named like an
+ * ISL driver, so the HAL can be run on a host or on a board without the
+ * part.
+ *
+ * The trace is either a capture recorded by the HAL, see SensorCapture.h,
+ * or the output of "getevent -t", with or without the device column, e.g.
+ *
+ *	[   1234.567890] /dev/input/event3: 0003 0028 000001f4
+ *
+ * A capture holds several devices; the one named with -n is played, the
+ * first one by default. -d prints a capture in the getevent format.
+ *
+ * Frames keep their recorded spacing divided by the speed factor. With
+ * -g a trace of changing lux and proximity frames is generated instead;
+ * the input core drops abs values that did not change, so every frame
+ * carries a new value.
+ */
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+#include "SensorCapture.h"
+
+/*****************************************************************************/
+
+#define MAX_FRAME_EVENTS		64
+
+struct trace_event {
+	int64_t		time;		/* ns from the start of the trace */
+	uint16_t	type;
+	uint16_t	code;
+	int32_t		value;
+};
+
+static struct trace_event* sEvents;
+static int sNumEvents;
+static int sMaxEvents;
+
+static int add_event(int64_t time, int type, int code, int value)
+{
+	if (sNumEvents == sMaxEvents) {
+		int max = sMaxEvents ? sMaxEvents * 2 : 4096;
+		struct trace_event* events = (struct trace_event*)
+			realloc(sEvents, max * sizeof(*events));
+		if (!events)
+			return -ENOMEM;
+		sEvents = events;
+		sMaxEvents = max;
+	}
+
+	struct trace_event* ev = &sEvents[sNumEvents++];
+	ev->time = time;
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+	return 0;
+}
+
+/* one "[ sec.usec] [device:] type code value" line, all hex but the time */
+static int parse_line(const char* line, int64_t* time, int* type, int* code,
+		int* value)
+{
+	const char* p = strchr(line, '[');
+	if (!p)
+		return -EINVAL;
+
+	char* end;
+	double t = strtod(p + 1, &end);
+	p = strchr(end, ']');
+	if (!p)
+		return -EINVAL;
+	p++;
+
+	/* skip the device column of multi-device captures */
+	const char* colon = strchr(p, ':');
+	if (colon)
+		p = colon + 1;
+
+	unsigned int ty, co, va;
+	if (sscanf(p, "%x %x %x", &ty, &co, &va) != 3)
+		return -EINVAL;
+
+	*time = (int64_t)(t * 1e9);
+	*type = ty;
+	*code = co;
+	*value = (int32_t)va;
+	return 0;
+}
+
+static int load_trace(FILE* file)
+{
+	char line[256];
+	int64_t first = -1;
+
+	while (fgets(line, sizeof(line), file)) {
+		int64_t time;
+		int type, code, value;
+
+		if (parse_line(line, &time, &type, &code, &value))
+			continue;
+		if (first < 0)
+			first = time;
+		if (add_event(time - first, type, code, value))
+			return -ENOMEM;
+	}
+	return sNumEvents ? 0 : -ENODATA;
+}
+
+/*
+ * The events of one device of a capture. Evdev stamps a frame at its SYN,
+ * so the events of a frame are held until then.
+ */
+static int load_capture(SensorCaptureReader* reader, const char* name)
+{
+	struct isl_capture_record rec;
+	int64_t first = -1;
+	int device = -1;
+	int pending = 0;
+
+	for (int i = 0; i < reader->getNumDevices(); i++) {
+		if (!name || !strcmp(reader->getDeviceName(i), name)) {
+			device = i;
+			break;
+		}
+	}
+	if (device < 0)
+		return -ENODEV;
+
+	while (reader->next(&rec)) {
+		if (rec.device != device)
+			continue;
+		if (add_event(0, rec.type, rec.code, rec.value))
+			return -ENOMEM;
+		pending++;
+		if (rec.type != EV_SYN)
+			continue;
+		if (first < 0)
+			first = rec.time;
+		for (int i = sNumEvents - pending; i < sNumEvents; i++)
+			sEvents[i].time = rec.time - first;
+		pending = 0;
+	}
+	// a frame cut short by the end of the capture is not played
+	sNumEvents -= pending;
+	return sNumEvents ? 0 : -ENODATA;
+}
+
+/* prints every record of a capture like getevent -t */
+static void dump_capture(SensorCaptureReader* reader)
+{
+	struct isl_capture_record rec;
+
+	while (reader->next(&rec)) {
+		printf("[%6lld.%06lld] %s: %04x %04x %08x\n",
+				(long long)(rec.time / 1000000000LL),
+				(long long)(rec.time % 1000000000LL / 1000),
+				reader->getDeviceName(rec.device),
+				rec.type, rec.code, (unsigned int)rec.value);
+	}
+}
+
+/* frames of an isl29028A at rate Hz: lux every frame, proximity every tenth */
+static int generate_trace(int frames, int rate)
+{
+	for (int i = 0; i < frames; i++) {
+		int64_t time = (int64_t)i * 1000000000LL / rate;
+
+		if (add_event(time, EV_ABS, ABS_MISC, 100 + i % 400))
+			return -ENOMEM;
+		if (i % 10 == 0 &&
+				add_event(time, EV_ABS, ABS_DISTANCE, (i / 10) & 1))
+			return -ENOMEM;
+		if (add_event(time, EV_SYN, SYN_REPORT, 0))
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+/* a uinput device with every event type and code the trace uses */
+static int create_device(const char* name)
+{
+	struct uinput_user_dev dev;
+	int fd;
+
+	fd = open("/dev/uinput", O_WRONLY);
+	if (fd < 0) {
+		fprintf(stderr, "couldn't open /dev/uinput (%s)\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&dev, 0, sizeof(dev));
+	strncpy(dev.name, name, UINPUT_MAX_NAME_SIZE - 1);
+	dev.id.bustype = BUS_VIRTUAL;
+
+	ioctl(fd, UI_SET_EVBIT, EV_SYN);
+	for (int i = 0; i < sNumEvents; i++) {
+		const struct trace_event* ev = &sEvents[i];
+
+		ioctl(fd, UI_SET_EVBIT, ev->type);
+		switch (ev->type) {
+		case EV_ABS:
+			ioctl(fd, UI_SET_ABSBIT, ev->code);
+			dev.absmin[ev->code] = 0;
+			dev.absmax[ev->code] = 0xFFFF;
+			break;
+		case EV_REL:
+			ioctl(fd, UI_SET_RELBIT, ev->code);
+			break;
+		case EV_MSC:
+			ioctl(fd, UI_SET_MSCBIT, ev->code);
+			break;
+		case EV_LED:
+			ioctl(fd, UI_SET_LEDBIT, ev->code);
+			break;
+		}
+	}
+
+	if (write(fd, &dev, sizeof(dev)) != sizeof(dev) ||
+			ioctl(fd, UI_DEV_CREATE) < 0) {
+		fprintf(stderr, "couldn't create %s (%s)\n", name, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int64_t now_ns()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static void sleep_until(int64_t ns)
+{
+	struct timespec t;
+	t.tv_sec = ns / 1000000000LL;
+	t.tv_nsec = ns % 1000000000LL;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+		;
+}
+
+/* writes each frame with one write(), at its time in the trace / speed */
+static int replay(int fd, double speed)
+{
+	struct input_event frame[MAX_FRAME_EVENTS];
+	int64_t start = now_ns();
+	int n = 0;
+
+	for (int i = 0; i < sNumEvents; i++) {
+		const struct trace_event* ev = &sEvents[i];
+
+		if (!n)
+			sleep_until(start + (int64_t)(ev->time / speed));
+
+		memset(&frame[n], 0, sizeof(frame[n]));
+		frame[n].type = ev->type;
+		frame[n].code = ev->code;
+		frame[n].value = ev->value;
+		n++;
+
+		if (ev->type == EV_SYN || n == MAX_FRAME_EVENTS) {
+			ssize_t size = n * sizeof(frame[0]);
+			if (write(fd, frame, size) != size) {
+				fprintf(stderr, "write failed (%s)\n", strerror(errno));
+				return -1;
+			}
+			n = 0;
+		}
+	}
+	return 0;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: isl_replay [-n name] [-s speed] [-l loops] [-w seconds]\n"
+		"                  [trace | -g frames [-r rate]]\n"
+		"       isl_replay -d capture\n"
+		"  -n  input device name, default isl29028A or the first of a capture\n"
+		"  -d  print a capture as getevent -t text\n"
+		"  -s  playback speed, 1 to 1000, default 1\n"
+		"  -l  times to play the trace, default 1\n"
+		"  -w  seconds to wait after creating the device, default 1\n"
+		"  -g  generate this many isl29028A frames instead of a trace\n"
+		"  -r  rate of generated frames in Hz, default 100\n");
+}
+
+int main(int argc, char** argv)
+{
+	const char* name = NULL;
+	bool dump = false;
+	double speed = 1;
+	int loops = 1;
+	int wait = 1;
+	int frames = 0;
+	int rate = 100;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:ds:l:w:g:r:")) != -1) {
+		switch (opt) {
+		case 'n': name = optarg; break;
+		case 'd': dump = true; break;
+		case 's': speed = atof(optarg); break;
+		case 'l': loops = atoi(optarg); break;
+		case 'w': wait = atoi(optarg); break;
+		case 'g': frames = atoi(optarg); break;
+		case 'r': rate = atoi(optarg); break;
+		default: usage(); return 1;
+		}
+	}
+	if (speed < 1 || speed > 1000 || rate < 1 || (!frames && optind >= argc)) {
+		usage();
+		return 1;
+	}
+
+	int err;
+	SensorCaptureReader reader;
+	if (frames) {
+		err = generate_trace(frames, rate);
+	} else if (!reader.open(argv[optind])) {
+		if (dump) {
+			dump_capture(&reader);
+			return 0;
+		}
+		if (!name && reader.getNumDevices())
+			name = reader.getDeviceName(0);
+		err = load_capture(&reader, name);
+	} else if (dump) {
+		fprintf(stderr, "%s is not a capture\n", argv[optind]);
+		return 1;
+	} else {
+		FILE* file = strcmp(argv[optind], "-") ? fopen(argv[optind], "r") : stdin;
+		if (!file) {
+			fprintf(stderr, "couldn't open %s (%s)\n", argv[optind],
+					strerror(errno));
+			return 1;
+		}
+		err = load_trace(file);
+		fclose(file);
+	}
+	if (err) {
+		fprintf(stderr, "no events to play (%s)\n", strerror(-err));
+		return 1;
+	}
+
+	int fd = create_device(name ? name : "isl29028A");
+	if (fd < 0)
+		return 1;
+	sleep(wait);
+
+	int64_t start = now_ns();
+	for (int i = 0; i < loops && !err; i++)
+		err = replay(fd, speed);
+	double seconds = (now_ns() - start) / 1e9;
+	printf("%d events in %.3f s, %.0f events/s\n", sNumEvents * loops,
+			seconds, sNumEvents * loops / seconds);
+
+	ioctl(fd, UI_DEV_DESTROY);
+	close(fd);
+	free(sEvents);
+	return err ? 1 : 0;
+}
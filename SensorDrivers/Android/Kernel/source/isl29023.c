@@ -24,6 +24,7 @@
 #include <linux/hrtimer.h>
 #include <linux/input.h>
 #include <linux/input/isl29023.h>
+#include <linux/input/isl_core.h>
 #include <linux/slab.h>
 #include <linux/sysfs.h>
 #include <linux/delay.h>
@@ -49,6 +50,7 @@
  *                        in the driver probe
  *  @ als_poll_delay   - Timer interval of high resolution timer
  *  @ client            - Reference to I2C slave (sensor device) 
+ *  @ regmap            - Cached register map of the sensor, see isl_core
  *  @ isl29023_kobj     - Kernel object used as parent node for sysfs entry
  *  @ mutex             - Provides mutex based synchronization for userspace
  *                        access to driver sysfs files
@@ -65,6 +67,7 @@ struct isl29023_drv_data {
 	struct hrtimer *timer;
 	ktime_t als_poll_delay;
 	struct i2c_client *client;
+	struct regmap *regmap;
 	struct kobject *isl29023_kobj;
 	struct mutex mutex;
 	struct work_struct work;
@@ -149,9 +152,22 @@ struct isl29023_drv_data drv_data;
 
 MODULE_DEVICE_TABLE(i2c, isl_device_ids);
 
+/* COMMAND1_REG holds the interrupt flag, DATA_LSB/MSB the conversion */
+static const struct regmap_range isl29023_volatile_ranges[] = {
+	ISL_CORE_RANGE(COMMAND1_REG, COMMAND1_REG),
+	ISL_CORE_RANGE(DATA_LSB, DATA_MSB),
+};
+
+static const struct isl_core_desc isl29023_core_desc = {
+	.name			= "isl29023",
+	.max_register		= INTR_HT_MSB,
+	.volatile_ranges	= isl29023_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29023_volatile_ranges),
+};
+
 /** @function: isl_read_field
  *  @desc    : read function for reading a particular bit field in a particular register
- *             from isl29023 sensor registers over I2C interface
+ *             from isl29023 sensor registers through the cached register map
  *  @args
  *  reg      : register to read from (0x00h to 0x08h)
  *  mask     : specific bit or group of continuous bits to read from
@@ -165,28 +181,18 @@ MODULE_DEVICE_TABLE(i2c, isl_device_ids);
  */
 static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *val)
 {
-	unsigned char byte;
-	unsigned char i;
+	int ret;
 
-	byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-	if(mask == ISL_FULL_MASK) {
-		*val = byte;
-	} else {
-		byte &= mask;
+	ret = isl_core_read_field(drv_data.regmap, reg, mask);
+	if(ret < 0) return -1;
 
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;
-
-		if( i > 7 ) return -1;
-
-		*val = (byte >> i);
-	}
+	*val = ret;
 	return 0;
 }
 
 /** @function: isl_read_field16
  *  @desc    : read function for reading a particular 16 bit field 
- *             from isl29023 sensor registers over I2C interface
+ *             from isl29023 sensor registers through the cached register map
  *  @args
  *  reg      : register to read from (0x03h to 0x08h)
  *  mask     : specific bit or group of continuous bits to read from
@@ -196,20 +202,19 @@ static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *
  */
 static int32_t isl_read_field16(unsigned char reg, unsigned int *buf)
 {
-	unsigned char reg_h;
-	unsigned char reg_l;
+	int ret;
 
-	isl_read_field(reg, ISL_FULL_MASK, &reg_l);
-	isl_read_field(reg + 1, ISL_FULL_MASK, &reg_h);
+	ret = isl_core_read16(drv_data.regmap, reg);
+	if(ret < 0) return -1;
 
-	*buf = (reg_h << 8) | reg_l;
+	*buf = ret;
 	return 0;
 }
 
 
 /** @function: isl_write_field
  *  @desc    : write function for writing a particular bit field in a particular register
- *             to isl29023 sensor registers over I2C interface
+ *             to isl29023 sensor registers through the cached register map
  *  @args
  *  reg      : register to write to (0x00h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to write to
@@ -223,29 +228,14 @@ static int32_t isl_read_field16(unsigned char reg, unsigned int *buf)
  */
 static int isl_write_field(unsigned char reg, unsigned char mask, unsigned char val)
 {
-	unsigned char byte;
-	unsigned char i = 0;
-
-	if(mask == ISL_FULL_MASK) {
-		i2c_smbus_write_byte_data(drv_data.client, reg, val);
-	} else {
-		byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-		byte &= (~mask);
-
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;
-
-		if(i > 7) return -1;
-
-		byte |= (val << i);
-		i2c_smbus_write_byte_data(drv_data.client, reg, byte);
-	}
+	if(isl_core_write_field(drv_data.regmap, reg, mask, val) < 0)
+		return -1;
 	return 0;
 }
 
 /** @function: isl_write_field16
  *  @desc    : write function for writing a particular 16 bit data in a particular register
- *             to isl29023 sensor registers over I2C interface
+ *             to isl29023 sensor registers through the cached register map
  *  @args
  *  reg      : register to write to (0x03h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to write to
@@ -255,14 +245,9 @@ static int isl_write_field(unsigned char reg, unsigned char mask, unsigned char
  */
 static int isl_write_field16(unsigned char reg, unsigned int val)
 {
-	unsigned char reg_l;
-	unsigned char reg_h;
-
-	reg_l =(unsigned char) (ISL_LSB_MASK & val);
-	reg_h =(unsigned char) ((ISL_MSB_MASK & val) >> 8);
-	isl_write_field(reg, ISL_FULL_MASK, reg_l);
-	isl_write_field(reg+1, ISL_FULL_MASK, reg_h);
-	DEBUG("In %s :: REG_L = %d REG_H = %d\n",__func__,reg_l,reg_h);
+	if(isl_core_write16(drv_data.regmap, reg, val) < 0)
+		return -1;
+	DEBUG("In %s :: REG_L = %d REG_H = %d\n",__func__,val & ISL_LSB_MASK,(val & ISL_MSB_MASK) >> 8);
 	return 0;
 }
 
@@ -820,6 +805,10 @@ static int isl29023_probe(struct i2c_client *client, const struct i2c_device_id
 	drv_data.client = client;
 	drv_data.pdata = pdata;
 
+	drv_data.regmap = isl_core_init(client, &isl29023_core_desc);
+	if(IS_ERR(drv_data.regmap))
+		return PTR_ERR(drv_data.regmap);
+
 	/* Initialize the sensor driver */
 	isl29023_initialize();
 #ifdef ISL29023_INTERRUPT_MODE
@@ -33,12 +33,16 @@
 #include <linux/slab.h>
 #include <linux/gpio.h>
 #include <linux/interrupt.h>
-#include <linux/input-polldev.h>
+#include <linux/input.h>
+#include <linux/workqueue.h>
 #include <linux/kobject.h>
 #include <linux/sysfs.h>
 #include <linux/irq.h>
 #include <linux/isl29028A.h>
+#include <linux/input/isl_core.h>
+#include <linux/input/isl_iio.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
 
 #ifndef _PRINTK_H_
 #include <linux/printk.h>
@@ -50,20 +54,35 @@
 static struct isl29028A_data {
 /* mutex lock for critical sections */
 	struct mutex lock;
-	struct input_polled_dev *input_poll_dev;
-	struct work_struct work;
+	struct input_dev *input;
+	/* polls the data while they are not reported from the interrupt */
+	struct delayed_work poll_work;
+	unsigned int poll_interval;	/* ms */
+	uchar opened;
 	struct kset *isl_kset;
 	struct kobject *isl_kobj;
 	uchar last_mod;
+	uchar enabled;
+	/* IIO front end, NULL if it could not be registered */
+	struct iio_dev *iio;
 #ifdef ISL29028A_INTERRUPT_MODE
 	uint16_t persist_flag;
 	int32_t irq_num;
+	struct isl_core_latency latency;
+	/* report from the interrupt and stop polling for proximity */
+	uchar event_mode;
+	/* proximity window set from sysfs, and the last state reported */
+	uchar prox_lt;
+	uchar prox_ht;
+	uchar prox_near;
 #endif
 
 }isl_data;
 
 //* Global i2c client data */
 static struct i2c_client *isl_client;
+/* Cached register map of the device, see isl_core */
+static struct regmap *isl_regmap;
 
 /* Device Id table containing list of devices sharing this driver */
 static struct i2c_device_id isl_device_table[] = {
@@ -71,6 +90,20 @@ static struct i2c_device_id isl_device_table[] = {
 	{}
 };
 
+/* interrupt flags in CONFIG_REG_2, conversion data and the test registers */
+static const struct regmap_range isl29028A_volatile_ranges[] = {
+	ISL_CORE_RANGE(CONFIG_REG_2, CONFIG_REG_2),
+	ISL_CORE_RANGE(ISL_PROX_DATA, ISL_ALSIR_DT2),
+	ISL_CORE_RANGE(CONFIG_REG_TEST1, CONFIG_REG_TEST2),
+};
+
+static const struct isl_core_desc isl29028A_core_desc = {
+	.name			= "isl29028A",
+	.max_register		= CONFIG_REG_TEST2,
+	.volatile_ranges	= isl29028A_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29028A_volatile_ranges),
+};
+
 
 
 /*
@@ -83,23 +116,159 @@ static struct i2c_device_id isl_device_table[] = {
  *
  */
 
-static int32_t isl29028A_i2c_read_word16(struct i2c_client *client,
-				 	uchar reg_addr,	uint32_t *buf)
+static int32_t isl29028A_i2c_read_word16(uchar reg_addr, uint32_t *buf)
 {
-	int16_t reg_h;
-	int16_t reg_l;
-	
-	reg_l = i2c_smbus_read_byte_data(client, reg_addr);
-	if (reg_l < 0) 
+	int ret;
+
+	ret = isl_core_read16(isl_regmap, reg_addr);
+	if (ret < 0)
 		return -1;
-	reg_h = i2c_smbus_read_byte_data(client, reg_addr + 1);
-	if (reg_h < 0) 
+	*buf = ret;
+	return 0;
+}
+
+/*
+ * @fn          isl29028A_read_data
+ *
+ * @brief       This function reads the proximity and ALS/IR data of one
+ *		sample in a single burst from ISL_PROX_DATA to ISL_ALSIR_DT2
+ *
+ * @return      Returns 0 on success otherwise returns an error (-1)
+ *
+ */
+
+static int32_t isl29028A_read_data(uint32_t *prox, uint32_t *als)
+{
+	u8 dat[ISL_ALSIR_DT2 - ISL_PROX_DATA + 1];
+
+	if(isl_core_read_block(isl_regmap, ISL_PROX_DATA, dat, sizeof(dat)) < 0)
 		return -1;
-	*buf = (reg_h << 8) | reg_l;
+	*prox = dat[0];
+	*als = (dat[ISL_ALSIR_DT2 - ISL_PROX_DATA] << 8) |
+			dat[ISL_ALSIR_DT1 - ISL_PROX_DATA];
+	return 0;
+}
+
+/*
+ * ALSIR data holds ALS or IR counts as set by the sensing mode, so the
+ * light and IR channels take turns; the one not selected reads 0. The
+ * mode comes from the register cache, not the bus.
+ */
+static int isl29028A_iio_read_sample(struct i2c_client *client, u16 *vals)
+{
+	uint32_t prox, als;
+	int32_t ret, mode;
+
+	mutex_lock(&isl_data.lock);
+	mode = isl_core_read(isl_regmap, CONFIG_REG_1);
+	ret = isl29028A_read_data(&prox, &als);
+	mutex_unlock(&isl_data.lock);
+	if(mode < 0 || ret < 0)
+		return -EIO;
+
+	if((mode & ISL_OP_MODE_IR_SENSING) == ISL_OP_MODE_IR_SENSING){
+		vals[0] = 0;
+		vals[1] = als & 0x0fff;
+	} else {
+		vals[0] = als & 0x0fff;
+		vals[1] = 0;
+	}
+	vals[2] = prox;
+	return 0;
+}
+
+static const struct iio_chan_spec isl29028A_iio_channels[] = {
+	ISL_IIO_CHANNEL(IIO_LIGHT, 0, 0, 12),
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_IR, 1, 12),
+	ISL_IIO_CHANNEL(IIO_PROXIMITY, 0, 2, 8),
+	IIO_CHAN_SOFT_TIMESTAMP(3),
+};
+
+static const struct isl_iio_desc isl29028A_iio_desc = {
+	.name			= "isl29028A",
+	.channels		= isl29028A_iio_channels,
+	.num_channels		= ARRAY_SIZE(isl29028A_iio_channels),
+	.default_period_ms	= ISL_POLL_INTERVAL_DEF_MS,
+	.read_sample		= isl29028A_iio_read_sample,
+};
+
+/*
+ * @fn          isl_events_armed
+ *
+ * @brief       This function tells whether polling is suspended, which
+ *              is the case in event mode with only proximity running.
+ *              ALS keeps polling, its window is too coarse to report
+ *              from.
+ *
+ * @return      Returns 1 if polling is suspended otherwise 0
+ *
+ */
+
+static int isl_events_armed(void)
+{
+#ifdef ISL29028A_INTERRUPT_MODE
+	return isl_data.event_mode && isl_data.enabled == ISL_PROX_ACTIVE;
+#else
 	return 0;
+#endif
+}
+
+/*
+ * @fn          isl_start_polling
+ *
+ * @brief       This function queues the next poll of an open input device
+ *              with a function enabled. With events armed that poll
+ *              reports the initial state and does not queue another.
+ *              The caller holds isl_data.lock
+ *
+ * @return      void
+ *
+ */
+
+static void isl_start_polling(void)
+{
+	if(isl_data.opened && isl_data.enabled)
+		queue_delayed_work(system_freezable_wq, &isl_data.poll_work,
+				msecs_to_jiffies(isl_data.poll_interval));
 }
 
 #ifdef ISL29028A_INTERRUPT_MODE
+/*
+ * @fn          isl_arm_prox
+ *
+ * @brief       This function writes the proximity interrupt window. In
+ *              event mode only the threshold of the next near/far
+ *              transition is armed so the part interrupts once per
+ *              transition, otherwise the window set from sysfs is used.
+ *              The caller holds isl_data.lock
+ *
+ * @return      Returns 0 on success otherwise returns an error (-1)
+ *
+ */
+
+static int isl_arm_prox(uint32_t prox)
+{
+	uchar lt = isl_data.prox_lt;
+	uchar ht = isl_data.prox_ht;
+
+	if(isl_data.event_mode){
+		if(prox >= ht)
+			isl_data.prox_near = 1;
+		else if(prox <= lt)
+			isl_data.prox_near = 0;
+		if(isl_data.prox_near)
+			ht = 0xFF;
+		else
+			lt = 0;
+	}
+	/* nothing reaches the bus unless the window moves */
+	if(isl_core_update(isl_regmap, ISL_PROX_LT_BYTE, 0xFF, lt) < 0)
+		return -1;
+	if(isl_core_update(isl_regmap, ISL_PROX_HT_BYTE, 0xFF, ht) < 0)
+		return -1;
+	return 0;
+}
+
 /*
  * @fn          show_prox_low_thres
  *
@@ -116,16 +285,10 @@ static ssize_t show_prox_low_thres(struct kobject *kobj,
 {
 	int16_t ret;
 	mutex_lock(&isl_data.lock);
-
-	ret = i2c_smbus_read_byte_data(isl_client, ISL_PROX_LT_BYTE);
-	if(ret < 0)
-		goto err_out;
+	/* the register holds the armed window in event mode */
+	ret = isl_data.prox_lt;
 	mutex_unlock(&isl_data.lock);
 	return sprintf(buf,"%d", ret);
-err_out:
-	__dbg_read_err("%s", __func__);
-	mutex_unlock(&isl_data.lock);
-	return -1;
 }
 
 /*
@@ -151,8 +314,9 @@ static ssize_t store_prox_low_thres(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
 	}
-	if (i2c_smbus_write_byte_data(isl_client, 
-				    ISL_PROX_LT_BYTE, reg) < 0){
+	isl_data.prox_lt = reg;
+	/* keep the near/far state */
+	if (isl_arm_prox(isl_data.prox_near ? 0xFF : 0) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}	
@@ -180,12 +344,7 @@ static ssize_t show_prox_high_thres(struct kobject *kobj,
         bytes_r r_byte;
 
         mutex_lock(&isl_data.lock);
-        r_byte = i2c_smbus_read_byte_data(isl_client, ISL_PROX_HT_BYTE);
-        if(r_byte < 0){
-		__dbg_read_err("%s", __func__);
-                mutex_unlock(&isl_data.lock);
-                return -1;
-        }
+        r_byte = isl_data.prox_ht;
         mutex_unlock(&isl_data.lock);
         return sprintf(buf, "%d", r_byte);
 }
@@ -212,8 +371,9 @@ static ssize_t store_prox_high_thres(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
         }
-        if(i2c_smbus_write_byte_data(isl_client, ISL_PROX_HT_BYTE, 
-						    reg) < 0){
+        isl_data.prox_ht = reg;
+        /* keep the near/far state */
+        if(isl_arm_prox(isl_data.prox_near ? 0xFF : 0) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
         }
@@ -241,7 +401,7 @@ static ssize_t show_alsir_low_thres(struct kobject *kobj,
 	uint32_t reg;
 
 	mutex_lock(&isl_data.lock);
-	if( isl29028A_i2c_read_word16(isl_client, ISL_ALSIR_TH1, &reg) < 0){
+	if( isl29028A_i2c_read_word16(ISL_ALSIR_TH1, &reg) < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
 		return -1;
@@ -277,7 +437,7 @@ static ssize_t store_alsir_low_thres(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
 	}
-	ret = i2c_smbus_read_byte_data(isl_client, ISL_ALSIR_TH2);
+	ret = isl_core_read(isl_regmap, ISL_ALSIR_TH2);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -288,13 +448,13 @@ static ssize_t store_alsir_low_thres(struct kobject *kobj,
 	reg_h = (ret & 0xF0) | reg_h;
 	
 	/* Write Low byte threshold at 0x05h */
-	ret = i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH1, reg_l);		
+	ret = isl_core_write(isl_regmap, ISL_ALSIR_TH1, reg_l);		
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
 	}
 	/* Write high byte threshold at 0x06h retaining upper nibble */
-	ret = i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH2, reg_h);		
+	ret = isl_core_write(isl_regmap, ISL_ALSIR_TH2, reg_h);		
 	if(ret < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
@@ -324,7 +484,7 @@ static ssize_t show_alsir_high_thres(struct kobject *kobj,
 	unsigned int reg;
 
 	mutex_lock(&isl_data.lock);
-	if(isl29028A_i2c_read_word16(isl_client, ISL_ALSIR_TH2, &reg) < 0){
+	if(isl29028A_i2c_read_word16(ISL_ALSIR_TH2, &reg) < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
 		return -1;
@@ -360,7 +520,7 @@ static ssize_t store_alsir_high_thres(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
 	}
-	ret = i2c_smbus_read_byte_data(isl_client, ISL_ALSIR_TH2);
+	ret = isl_core_read(isl_regmap, ISL_ALSIR_TH2);
         if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -372,12 +532,12 @@ static ssize_t store_alsir_high_thres(struct kobject *kobj,
 	reg_l = (ret & 0x0f) | reg_l;
 
         /* Write Low byte threshold at 0x05h */
-        if(i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH2, reg_l) < 0){
+        if(isl_core_write(isl_regmap, ISL_ALSIR_TH2, reg_l) < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
         }
         /* Write high byte threshold at 0x06h retaining upper nibble */
-        if(i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH3, reg_h) < 0){
+        if(isl_core_write(isl_regmap, ISL_ALSIR_TH3, reg_h) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
         }
@@ -406,7 +566,7 @@ static ssize_t show_intr_perst(struct kobject *kobj,
 {
 	int8_t reg, als_persist, prox_persist;
 	mutex_lock(&isl_data.lock);
-	reg = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_2);
+	reg = isl_core_read(isl_regmap, CONFIG_REG_2);
 	if(reg < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -499,7 +659,7 @@ static ssize_t store_intr_perst(struct kobject *kobj,
                         }
                         break;
 	}
-	reg = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_2);
+	reg = isl_core_read(isl_regmap, CONFIG_REG_2);
         if (reg < 0) {
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -509,7 +669,7 @@ static ssize_t store_intr_perst(struct kobject *kobj,
 	else 
 		reg = (reg & 0x61) | intr_persist;		/* ALS SENSING MODE */
 
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_2, reg) < 0){
+        if(isl_core_write(isl_regmap, CONFIG_REG_2, reg) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
         }
@@ -540,7 +700,7 @@ static ssize_t show_alsir_range(struct kobject *kobj,
 	short int ret;    
 
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);	
+	ret = isl_core_read(isl_regmap, CONFIG_REG_1);	
         if (ret < 0) {
 		__dbg_read_err("%s", __func__);
                 mutex_unlock(&isl_data.lock);
@@ -564,14 +724,7 @@ static ssize_t show_alsir_range(struct kobject *kobj,
 
 static int isl_set_sensing_range(short int val)	//// This function is used in store_alsir_range
 {
-	short int ret;
-
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
-	if(ret < 0)
-		return -1;
-	val = (ret & 0xfd) | val;	
-	ret = i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, val);
-	if(ret < 0)
+	if(isl_core_update(isl_regmap, CONFIG_REG_1, ISL_ALS_HIGH_RANGE, val) < 0)
 		return -1;
 	return 0;
 
@@ -632,7 +785,7 @@ static ssize_t show_prox_data(struct kobject *kobj,
 {
 	short int ret;
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, ISL_PROX_DATA);
+	ret = isl_core_read(isl_regmap, ISL_PROX_DATA);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -660,7 +813,7 @@ static ssize_t show_als_data(struct kobject *kobj,
 	unsigned int reg;
 
 	mutex_lock(&isl_data.lock);	
-	if(isl29028A_i2c_read_word16(isl_client, ISL_ALSIR_DT1, &reg) < 0){
+	if(isl29028A_i2c_read_word16(ISL_ALSIR_DT1, &reg) < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
 		return -1;
@@ -686,7 +839,7 @@ static ssize_t show_ir_data(struct kobject *kobj,
 	
         unsigned int reg;                                                         
         mutex_lock(&isl_data.lock); 
-        if(isl29028A_i2c_read_word16(isl_client, ISL_ALSIR_DT1, &reg) < 0){
+        if(isl29028A_i2c_read_word16(ISL_ALSIR_DT1, &reg) < 0){
 		__dbg_read_err("%s", __func__);
                 mutex_unlock(&isl_data.lock);
                 return -1;                                                          
@@ -712,7 +865,7 @@ static ssize_t show_mode(struct kobject *kobj,
 	short int mode;
 
 	mutex_lock(&isl_data.lock);
-	mode = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);	
+	mode = isl_core_read(isl_regmap, CONFIG_REG_1);	
 	if(mode < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -732,12 +885,7 @@ static ssize_t show_mode(struct kobject *kobj,
 
 static int set_sensing_mode(uint16_t mode)
 {
-	short int reg;
-	reg = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
-	if(reg < 0)
-		return -1;
-	reg = (reg & 0x7A) | mode;
-	if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, reg) < 0) 
+	if(isl_core_update(isl_regmap, CONFIG_REG_1, 0x85, mode) < 0) 
 		return -1;
 	return 0;
 }
@@ -778,6 +926,9 @@ static ssize_t store_mode(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
 	}
+	/* set_sensing_mode() leaves exactly one function running */
+	isl_data.enabled = (mode == ISL_OP_MODE_PROX) ? ISL_PROX_ACTIVE : ISL_ALS_ACTIVE;
+	isl_start_polling();
 	mutex_unlock(&isl_data.lock);
 	return strlen(buf);
 err_out:
@@ -801,7 +952,7 @@ static ssize_t show_prox_status(struct kobject *kobj,
 {
 	int ret;
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_1);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -822,7 +973,7 @@ static ssize_t show_als_status(struct kobject *kobj,
 {
 	int ret;
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_1);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -837,6 +988,123 @@ static ssize_t show_als_status(struct kobject *kobj,
 	mutex_unlock(&isl_data.lock);
 	return strlen(buf);
 }
+
+/*
+ * @fn          isl_set_enable
+ *
+ * @brief       This function turns one of the ALS / proximity functions
+ *              on or off in CONFIG_REG_1. The device is in power down
+ *              whenever neither function is enabled.
+ *              The caller holds isl_data.lock
+ *
+ * @return      Returns 0 on success otherwise returns an error (-1)
+ *
+ */
+
+static int isl_set_enable(uchar sensor, int en)
+{
+	uchar enabled;
+	short int reg;
+
+	enabled = en ? (isl_data.enabled | sensor) : (isl_data.enabled & ~sensor);
+	if(enabled == isl_data.enabled)
+		return 0;
+
+	reg = 0;
+	if(enabled & ISL_ALS_ACTIVE)
+		reg |= ISL_OP_MODE_ALS_SENSING;
+	if(enabled & ISL_PROX_ACTIVE)
+		reg |= ISL_OP_MODE_PROX;
+	if(isl_core_update(isl_regmap, CONFIG_REG_1,
+			ISL_OP_MODE_PROX | ISL_OP_MODE_ALS_SENSING, reg) < 0)
+		return -1;
+
+	isl_data.enabled = enabled;
+	isl_start_polling();
+	return 0;
+}
+
+/*
+ * @fn          isl_parse_enable
+ *
+ * @brief       This function parses a status value written to sysfs,
+ *              valid values are 1 / 0 / enable / disable
+ *
+ * @return      Returns 1 or 0 on success otherwise returns an error (-1)
+ *
+ */
+
+static int isl_parse_enable(const char *buf)
+{
+	if(!strncmp(buf, "enable", 6) || buf[0] == '1')
+		return 1;
+	if(!strncmp(buf, "disable", 7) || buf[0] == '0')
+		return 0;
+	return -1;
+}
+
+/*
+ * @fn          store_prox_status
+ *
+ * @brief       This function enables or disables proximity sensing
+ *
+ * @return      Returns the length of data buffer on success
+ *              otherwise returns an error (-1)
+ *
+ */
+
+static ssize_t store_prox_status(struct kobject *kobj,
+			 struct kobj_attribute *attr, const char *buf,
+						 size_t count)
+{
+	int en;
+
+	en = isl_parse_enable(buf);
+	if(en < 0){
+		__dbg_invl_err("%s", __func__);
+		return -1;
+	}
+	mutex_lock(&isl_data.lock);
+	if(isl_set_enable(ISL_PROX_ACTIVE, en) < 0){
+		__dbg_write_err("%s", __func__);
+		mutex_unlock(&isl_data.lock);
+		return -1;
+	}
+	mutex_unlock(&isl_data.lock);
+	return strlen(buf);
+}
+
+/*
+ * @fn          store_als_status
+ *
+ * @brief       This function enables or disables ALS sensing
+ *
+ * @return      Returns the length of data buffer on success
+ *              otherwise returns an error (-1)
+ *
+ */
+
+static ssize_t store_als_status(struct kobject *kobj,
+			 struct kobj_attribute *attr, const char *buf,
+						 size_t count)
+{
+	int en;
+
+	en = isl_parse_enable(buf);
+	if(en < 0){
+		__dbg_invl_err("%s", __func__);
+		return -1;
+	}
+	mutex_lock(&isl_data.lock);
+	if(isl_set_enable(ISL_ALS_ACTIVE, en) < 0){
+		__dbg_write_err("%s", __func__);
+		mutex_unlock(&isl_data.lock);
+		return -1;
+	}
+	mutex_unlock(&isl_data.lock);
+	return strlen(buf);
+}
+
 /*
  * @fn          show_ir_current
  *
@@ -855,7 +1123,7 @@ static ssize_t show_ir_current(struct kobject *kobj,
 	unsigned short int val;
 	
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_1);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&isl_data.lock);
@@ -888,7 +1156,6 @@ static ssize_t store_ir_current(struct kobject *kobj,
                          struct kobj_attribute *attr, const char *buf,
                                                  size_t count)
 {
-	short int ret;
 	unsigned int val;
         mutex_lock(&isl_data.lock);
 	val = simple_strtoul(buf, NULL, 10);
@@ -901,13 +1168,7 @@ static ssize_t store_ir_current(struct kobject *kobj,
 		mutex_unlock(&isl_data.lock);
 		return -1;
 	}
-       	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1); 
-	if(ret < 0){
-		__dbg_read_err("%s", __func__);
-		goto err_out;
-	}
-	val = (ret & 0xf7) | val;
-	if (i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, val) < 0){
+	if (isl_core_update(isl_regmap, CONFIG_REG_1, ISL_PROX_DR_220mA, val) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}
@@ -919,12 +1180,47 @@ err_out:
 	
 }
 
+/*
+ * Proximity sleep settings of CONFIG_REG_1, longest first. The ALS of
+ * this part converts back to back and has no sleep setting of its own.
+ */
+static const struct {
+	uint32_t sleep_us;
+	uchar reg;
+} isl_prox_sleep_table[] = {
+	{ 800000, ISL_PROX_SLP_800ms },
+	{ 400000, ISL_PROX_SLP_400ms },
+	{ 200000, ISL_PROX_SLP_200ms },
+	{ 100000, ISL_PROX_SLP_100ms },
+	{ 75000, ISL_PROX_SLP_75ms },
+	{ 50000, ISL_PROX_SLP_50ms },
+	{ 12500, ISL_PROX_SLP_12500us },
+	{ 0, ISL_PROX_SLP_0ms },
+};
+
+/*
+ * @fn          isl_set_prox_sleep
+ *
+ * @brief       This function writes the proximity sleep bits of
+ *              CONFIG_REG_1, the caller holds isl_data.lock
+ *
+ * @return      Returns 0 on success otherwise returns an error (-1)
+ *
+ */
+
+static int isl_set_prox_sleep(short int sleep)
+{
+	if(isl_core_update(isl_regmap, CONFIG_REG_1, ISL_PROX_SLP_MASK, sleep) < 0)
+		return -1;
+	return 0;
+}
+
 static ssize_t show_prox_sleep_t(struct kobject *kobj,
                 struct kobj_attribute *attr, char *buf)
 {
         int16_t sleep_t;
         mutex_lock(&isl_data.lock);
-        sleep_t = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
+        sleep_t = isl_core_read(isl_regmap, CONFIG_REG_1);
         if(sleep_t < 0){
                 __dbg_read_err("%s", __func__);
                 mutex_unlock(&isl_data.lock);
@@ -952,7 +1248,7 @@ static ssize_t store_prox_sleep_t(struct kobject *kobj,
                 struct kobj_attribute *attr, const char *buf,
                         size_t count)
 {
-        int16_t reg, ret;
+        int16_t reg;
         uint32_t sleep_t;
         mutex_lock(&isl_data.lock);
       	sleep_t = simple_strtoul(buf,NULL ,10);
@@ -971,12 +1267,7 @@ static ssize_t store_prox_sleep_t(struct kobject *kobj,
         default   :goto err_out;
         }
 
-        ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
-        if(ret < 0)
-                goto err_out;
-
-        reg = (ret & 0x8F) | reg;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, reg) < 0)
+        if(isl_set_prox_sleep(reg) < 0)
                 goto err_out;
 
         mutex_unlock(&isl_data.lock);
@@ -988,7 +1279,155 @@ err_out:
         return -1;
 }
 
+/*
+ * @fn          show_poll_delay
+ *
+ * @brief       This function shows the input polling period in ns
+ *
+ * @return      Returns the length of data buffer
+ *
+ */
+
+static ssize_t show_poll_delay(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	int64_t ns;
+
+	mutex_lock(&isl_data.lock);
+	ns = (int64_t)isl_data.poll_interval * NSEC_PER_MSEC;
+	mutex_unlock(&isl_data.lock);
+	return sprintf(buf, "%lld", ns);
+}
+
+/*
+ * @fn          store_poll_delay
+ *
+ * @brief       This function sets the input polling period from a
+ *              value in ns written by the sensors HAL, and picks the
+ *              longest proximity sleep that still fits in that period
+ *
+ * @return      Returns the length of data buffer on success
+ *              otherwise returns an error (-1)
+ *
+ */
+
+static ssize_t store_poll_delay(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	uint64_t ms;
+	unsigned int i;
+
+	ms = div_u64(simple_strtoull(buf, NULL, 10), NSEC_PER_MSEC);
+	if(ms < ISL_POLL_INTERVAL_MIN_MS)
+		ms = ISL_POLL_INTERVAL_MIN_MS;
+	else if(ms > ISL_POLL_INTERVAL_MAX_MS)
+		ms = ISL_POLL_INTERVAL_MAX_MS;
+
+	for(i = 0; i < ARRAY_SIZE(isl_prox_sleep_table) - 1; i++) {
+		if(isl_prox_sleep_table[i].sleep_us <= ms * 1000)
+			break;
+	}
+
+	mutex_lock(&isl_data.lock);
+	if(isl_set_prox_sleep(isl_prox_sleep_table[i].reg) < 0){
+		__dbg_write_err("%s", __func__);
+		mutex_unlock(&isl_data.lock);
+		return -1;
+	}
+	/* picked up when the next poll is queued */
+	isl_data.poll_interval = ms;
+	mutex_unlock(&isl_data.lock);
+	return strlen(buf);
+}
+
+#ifdef ISL29028A_INTERRUPT_MODE
+/*
+ * @fn          show_irq_latency
+ *
+ * @brief       This function shows the interrupt to report latency as
+ *              "last max average count", the times in microseconds
+ *
+ * @return      Returns data buffer length
+ *
+ */
+
+static ssize_t show_irq_latency(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return isl_core_latency_show(&isl_data.latency, buf);
+}
+
+/*
+ * @fn          store_irq_latency
+ *
+ * @brief       This function restarts the latency measurement on any
+ *              write
+ *
+ * @return      Returns length of data buffer
+ *
+ */
+
+static ssize_t store_irq_latency(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	disable_irq(isl_data.irq_num);
+	isl_core_latency_reset(&isl_data.latency);
+	enable_irq(isl_data.irq_num);
+	return count;
+}
+
+/*
+ * @fn          show_event_mode
+ *
+ * @brief       This function shows whether the data are reported from
+ *              the sensor interrupt
+ *
+ * @return      Returns data buffer length
+ *
+ */
+
+static ssize_t show_event_mode(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%d", isl_data.event_mode);
+}
+
+/*
+ * @fn          store_event_mode
+ *
+ * @brief       This function turns event mode on or off, valid values
+ *              are 1 / 0 / enable / disable. In event mode every
+ *              interrupt reports the data and polling stops while
+ *              proximity is the only function enabled.
+ *
+ * @return      Returns the length of data buffer on success
+ *              otherwise returns an error (-1)
+ *
+ */
+
+static ssize_t store_event_mode(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	int en, prox;
 
+	en = isl_parse_enable(buf);
+	if(en < 0){
+		__dbg_invl_err("%s", __func__);
+		return -1;
+	}
+	mutex_lock(&isl_data.lock);
+	isl_data.event_mode = en;
+	prox = isl_core_read(isl_regmap, ISL_PROX_DATA);
+	if(prox < 0 || isl_arm_prox(prox) < 0){
+		__dbg_write_err("%s", __func__);
+		mutex_unlock(&isl_data.lock);
+		return -1;
+	}
+	isl_start_polling();
+	mutex_unlock(&isl_data.lock);
+	return strlen(buf);
+}
+#endif
 
 MODULE_DEVICE_TABLE(i2c,isl_device_table);
 
@@ -1016,6 +1455,14 @@ __ATTR(alsir_high_thres, 0666, show_alsir_high_thres, store_alsir_high_thres);
 /* Kernel object structure attributes for intr_persistence sysfs */
 static struct kobj_attribute intr_perst_attribute = 
 __ATTR(intr_perst, 0666, show_intr_perst, store_intr_perst);
+
+/* Kernel object structure attributes for irq_latency sysfs */
+static struct kobj_attribute irq_latency_attribute = 
+__ATTR(irq_latency, 0666, show_irq_latency, store_irq_latency);
+
+/* Kernel object structure attributes for event_mode sysfs */
+static struct kobj_attribute event_mode_attribute = 
+__ATTR(event_mode, 0666, show_event_mode, store_event_mode);
 #endif
 
 /* Kernel object structure attributes for alsir_range sysfs */
@@ -1036,13 +1483,13 @@ __ATTR(ir_data, 0666, show_ir_data, NULL);
 
 /* Kernel object structure attributes for prox_status sysfs */
 static struct kobj_attribute prox_status_attribute = 
-__ATTR(prox_status, 0666, show_prox_status, NULL);
+__ATTR(prox_status, 0666, show_prox_status, store_prox_status);
 
 //////////////////////////
 
 /* Kernel object structure attributes for prox_status sysfs */
 static struct kobj_attribute als_status_attribute = 
-__ATTR(als_status, 0666, show_als_status, NULL);
+__ATTR(als_status, 0666, show_als_status, store_als_status);
 
 //////////////////////////
 
@@ -1053,6 +1500,9 @@ __ATTR(ir_current, 0666, show_ir_current, store_ir_current);
 static struct kobj_attribute prox_sleep_t_attribute = 
 __ATTR(prox_sleep_t, 0666, show_prox_sleep_t, store_prox_sleep_t);
 
+/* Device attribute of the input device, /sys/class/input/eventX/device/poll_delay */
+static DEVICE_ATTR(poll_delay, 0666, show_poll_delay, store_poll_delay);
+
 static struct attribute *isl29028A_attrs[] = {
 
 #ifdef ISL29028A_INTERRUPT_MODE
@@ -1061,6 +1511,8 @@ static struct attribute *isl29028A_attrs[] = {
 	&alsir_low_thres_attribute.attr,
 	&alsir_high_thres_attribute.attr,
 	&intr_perst_attribute.attr,
+	&irq_latency_attribute.attr,
+	&event_mode_attribute.attr,
 #endif
 	&prox_data_attribute.attr,
 	&alsir_range_attribute.attr,
@@ -1085,20 +1537,19 @@ static struct attribute_group isl29028A_attr_grp = {
 /*
  * @fn          isl_sensor_irq_handler
  *
- * @brief       This function is the interrupt handler for sensor.
- *              It schedules an interrupt thread and returns (free)
- *              interrupt.
+ * @brief       This function is the hard interrupt handler for sensor.
+ *              It stamps the interrupt and wakes the threaded handler;
+ *              the line stays masked until that returns (IRQF_ONESHOT).
  *
- * @return      IRQ_HANDLED
+ * @return      IRQ_WAKE_THREAD
  *
  */
 
 static irqreturn_t isl_sensor_irq_handler(int irq, void *dev_id)
 {	
-//	printk(KERN_ERR"%s\n",__func__);
-	disable_irq_nosync(isl_data.irq_num);
-	schedule_work(&isl_data.work);
-	return IRQ_HANDLED;
+	isl_core_irq_stamp(&isl_data.latency);
+	isl_iio_irq(isl_data.iio);
+	return IRQ_WAKE_THREAD;
 }
 #endif
 
@@ -1118,43 +1569,48 @@ static int initialize_isl29028A(struct i2c_client *client)
 	
 	/* As per the device datasheet recommendations */
 	/* Power down the device */
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, ISL_REG_CLEAR) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_1, ISL_REG_CLEAR) < 0)
                 return -EINVAL;
 	/* Write 0x0E to configuration test register 1 */
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST1, ISL_REG_1_DEF) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST1, ISL_REG_1_DEF) < 0)
                 return -EINVAL;
 	/* Write 0x029 to configuratio test register 2 */
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST2, ISL_REG_TEST_2) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST2, ISL_REG_TEST_2) < 0)
                 return -EINVAL;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST2, ISL_REG_CLEAR) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST2, ISL_REG_CLEAR) < 0)
                 return -EINVAL;
 	mdelay(2);
+	/* the sequence above reset every register behind the cache */
+	if(isl_core_reload(isl_regmap, &isl29028A_core_desc) < 0)
+		return -EINVAL;
 
-	/*Initialize the dvice in als sensing mode */
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, 0x74) < 0)
+	/* Leave ALS and prox off until the HAL enables them */
+        if(isl_core_write(isl_regmap, CONFIG_REG_1, ISL_REG_1_INIT) < 0)
                 return -EINVAL;
-        if(i2c_smbus_write_byte_data(client, CONFIG_REG_2, 0x66) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_2, 0x66) < 0)
                 return -EINVAL;
 
 #ifdef ISL29028A_INTERRUPT_MODE
-
-        /* Writing interrupt low threshold as 0xCCC (5% of max range) */
-        if(i2c_smbus_write_byte_data(isl_client, ISL_PROX_LT_BYTE, ISL_PROX_LT_DEF) < 0)
+        /* Proximity interrupt on a single conversion out of the window */
+        if(isl_core_write(isl_regmap, CONFIG_REG_2, ISL_REG_2_EVENT) < 0)
                 return -EINVAL;
 
-        /* Writing interrupt high threshold as 0xCCCC (80% of max range)  */
-        if(i2c_smbus_write_byte_data(client, ISL_PROX_HT_BYTE, ISL_PROX_HT_DEF) < 0)
+        /* Proximity window 0x0C - 0xCC, armed for the far state */
+        isl_data.prox_lt = ISL_PROX_LT_DEF;
+        isl_data.prox_ht = ISL_PROX_HT_DEF;
+        isl_data.prox_near = 0;
+        if(isl_arm_prox(0) < 0)
                 return -EINVAL;
 
         /* Writing interrupt low threshold as 0xCCC (5% of max range) */
-        if(i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH1, ISL_ALSIR_TH1_DEF) < 0)
+        if(isl_core_write(isl_regmap, ISL_ALSIR_TH1, ISL_ALSIR_TH1_DEF) < 0)
                 return -EINVAL;
 
-        if(i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH2, ISL_ALSIR_TH2_DEF) < 0 )
+        if(isl_core_write(isl_regmap, ISL_ALSIR_TH2, ISL_ALSIR_TH2_DEF) < 0 )
                 return -EINVAL;
 
         /* Writing interrupt high threshold as 0xCCCC (80% of max range)  */
-       if(i2c_smbus_write_byte_data(isl_client, ISL_ALSIR_TH3, ISL_ALSIR_TH3_DEF) < 0)
+       if(isl_core_write(isl_regmap, ISL_ALSIR_TH3, ISL_ALSIR_TH3_DEF) < 0)
 
                 return -EINVAL;
 #endif
@@ -1162,30 +1618,92 @@ static int initialize_isl29028A(struct i2c_client *client)
 	
 }
 
-/** @function   : isl_input_poll
+/** @function   : isl_report_data
  *  @desc       : Function to report lux and prox value to User space in the OS
  *
  *  @args
- *  dev   	: input polled device
+ *  prox_value	: proximity data
+ *  lux_value	: ALS/IR data
+ *
+ *  @return     : void
+ */
+static void isl_report_data(unsigned int prox_value, unsigned int lux_value)
+{
+	input_report_abs(isl_data.input, ABS_MISC, lux_value);
+	input_report_abs(isl_data.input, ABS_DISTANCE, prox_value);
+	input_sync(isl_data.input);
+}
+
+/** @function   : isl_input_poll
+ *  @desc       : Work polling the data while they are not reported from
+ *                the interrupt. Queues itself again unless events are
+ *                armed, the device is closed or nothing is enabled.
+ *
+ *  @args
+ *  work   	: poll_work of isl_data
  *
  *  @return     : void
  */
-static void isl_input_poll(struct input_polled_dev *dev)
+static void isl_input_poll(struct work_struct *work)
 {
         unsigned int prox_value,lux_value;
 
-	if( isl29028A_i2c_read_word16(isl_client, ISL_ALSIR_DT1, &lux_value) < 0){
-                __dbg_read_err("%s", __func__);
-        }
-		
-	prox_value = i2c_smbus_read_byte_data(isl_client, ISL_PROX_DATA);
-        if(prox_value < 0){
+	mutex_lock(&isl_data.lock);
+	/* nothing is converting while both functions are powered down */
+	if(!isl_data.opened || !isl_data.enabled)
+		goto out;
+
+	if(isl29028A_read_data(&prox_value, &lux_value) < 0){
                 __dbg_read_err("%s", __func__);
+		goto next;
         }
+	isl_report_data(prox_value, lux_value);
+#ifdef ISL29028A_INTERRUPT_MODE
+	/* the first report in event mode also arms the window */
+	if(isl_data.event_mode && isl_arm_prox(prox_value) < 0)
+                __dbg_write_err("%s", __func__);
+#endif
+
+next:
+	if(!isl_events_armed())
+		queue_delayed_work(system_freezable_wq, &isl_data.poll_work,
+				msecs_to_jiffies(isl_data.poll_interval));
+out:
+	mutex_unlock(&isl_data.lock);
+}
 
-	input_report_abs(isl_data.input_poll_dev->input, ABS_MISC, lux_value);
-	input_report_abs(isl_data.input_poll_dev->input, ABS_DISTANCE, prox_value);
-	input_sync(isl_data.input_poll_dev->input);
+/** @function   : isl_input_open
+ *  @desc       : Starts polling when user space opens the input device
+ *
+ *  @args
+ *  dev   	: input device
+ *
+ *  @return     : 0
+ */
+static int isl_input_open(struct input_dev *dev)
+{
+	mutex_lock(&isl_data.lock);
+	isl_data.opened = 1;
+	isl_start_polling();
+	mutex_unlock(&isl_data.lock);
+	return 0;
+}
+
+/** @function   : isl_input_close
+ *  @desc       : Stops polling and interrupt reports when the input
+ *                device is closed
+ *
+ *  @args
+ *  dev   	: input device
+ *
+ *  @return     : void
+ */
+static void isl_input_close(struct input_dev *dev)
+{
+	mutex_lock(&isl_data.lock);
+	isl_data.opened = 0;
+	mutex_unlock(&isl_data.lock);
+	cancel_delayed_work_sync(&isl_data.poll_work);
 }
 
 #ifdef ISL29028A_INTERRUPT_MODE
@@ -1193,30 +1711,44 @@ static void isl_input_poll(struct input_polled_dev *dev)
 /*
  * @fn          isl29028A_irq_thread
  *
- * @brief       This work thread is scheduled by sensor interrupt handler
- *		to clear the interrupt flags of sensor
+ * @brief       This threaded handler runs at real-time priority after
+ *		the sensor interrupt. It reads the interrupt flags and the
+ *		data in one burst, clears the flags and, in event mode,
+ *		reports the data and arms the next proximity transition
  *
- * @return      void
+ * @return      IRQ_HANDLED
  */
 
-static void isl29028A_irq_thread(struct work_struct *work)
+static irqreturn_t isl29028A_irq_thread(int irq, void *dev_id)
 {
-	short int ret;
-	
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_2);
-	if(ret < 0){
+	/* CONFIG_REG_2 up to the end of the data, the thresholds between */
+	u8 dat[ISL_ALSIR_DT2 - CONFIG_REG_2 + 1];
+	unsigned int prox_value, lux_value;
+
+	mutex_lock(&isl_data.lock);
+	if(isl_core_read_burst(isl_regmap, CONFIG_REG_2, dat, sizeof(dat)) < 0){
 		__dbg_read_err("%s", __func__);
 		goto err;
 	}
-    	if(i2c_smbus_write_byte_data(isl_client,CONFIG_REG_2,
-				(ret & ISL_INT_CLEAR_MASK)) < 0){
+    	if(isl_core_write(isl_regmap, CONFIG_REG_2,
+				(dat[0] & ISL_INT_CLEAR_MASK)) < 0){
 		__dbg_write_err("%s", __func__);
                 goto err;
         }
+	if(!isl_data.event_mode || !isl_data.opened || !isl_data.enabled)
+		goto err;
+
+	prox_value = dat[ISL_PROX_DATA - CONFIG_REG_2];
+	lux_value = (dat[ISL_ALSIR_DT2 - CONFIG_REG_2] << 8) |
+			dat[ISL_ALSIR_DT1 - CONFIG_REG_2];
+	isl_report_data(prox_value, lux_value);
+	isl_core_latency_done(&isl_data.latency);
 
+	if(isl_arm_prox(prox_value) < 0)
+		__dbg_write_err("%s", __func__);
 err:
-        enable_irq(isl_data.irq_num);
-	
+	mutex_unlock(&isl_data.lock);
+	return IRQ_HANDLED;
 }
 #endif
 
@@ -1232,33 +1764,45 @@ err:
  */
 static int setup_input_device(void)
 {
-        isl_data.input_poll_dev = input_allocate_polled_device();
+        isl_data.input = input_allocate_device();
 
-        if(!isl_data.input_poll_dev) {
+        if(!isl_data.input) {
                 printk( KERN_ERR "Failed to allocate input device");
                 return -1;
         }
-	isl_data.input_poll_dev->poll = isl_input_poll;
-	isl_data.input_poll_dev->poll_interval = 50;
+	/* polling is driver owned so it can stop while events are armed,
+	   like input-polldev it does not run while the system is frozen */
+	INIT_DELAYED_WORK(&isl_data.poll_work, isl_input_poll);
+	isl_data.poll_interval = ISL_POLL_INTERVAL_DEF_MS;
 
-	isl_data.input_poll_dev->input->name = "isl29028A";
-        input_set_drvdata(isl_data.input_poll_dev->input,&isl_data);
+	isl_data.input->name = "isl29028A";
+	isl_data.input->open = isl_input_open;
+	isl_data.input->close = isl_input_close;
+        input_set_drvdata(isl_data.input,&isl_data);
 
         /* Set event data type */
-        input_set_capability(isl_data.input_poll_dev->input, EV_ABS, ABS_DISTANCE);
-        input_set_capability(isl_data.input_poll_dev->input, EV_ABS, ABS_MISC);
+        input_set_capability(isl_data.input, EV_ABS, ABS_DISTANCE);
+        input_set_capability(isl_data.input, EV_ABS, ABS_MISC);
 
-        __set_bit(EV_ABS, isl_data.input_poll_dev->input->evbit);
-        __set_bit(EV_ABS, isl_data.input_poll_dev->input->evbit);
+        __set_bit(EV_ABS, isl_data.input->evbit);
+        __set_bit(EV_ABS, isl_data.input->evbit);
         
-	input_set_abs_params(isl_data.input_poll_dev->input, ABS_DISTANCE, 0, 1, 0, 0);
-        input_set_abs_params(isl_data.input_poll_dev->input, ABS_MISC, 0, 16000, 0, 0);
+	input_set_abs_params(isl_data.input, ABS_DISTANCE, 0, 1, 0, 0);
+        input_set_abs_params(isl_data.input, ABS_MISC, 0, 16000, 0, 0);
 
-        if(input_register_polled_device(isl_data.input_poll_dev)) {
+        if(input_register_device(isl_data.input)) {
                 printk (KERN_ERR "Failed to register input device");
+		input_free_device(isl_data.input);
                 return -1;
         }
 
+	if(device_create_file(&isl_data.input->dev,
+						&dev_attr_poll_delay) < 0) {
+                printk (KERN_ERR "Failed to create poll_delay sysfs");
+		input_unregister_device(isl_data.input);
+                return -1;
+	}
+
         return 0;
 }
 
@@ -1288,8 +1832,13 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
 	}
 
 	isl_client = client; 
+	isl_regmap = isl_core_init(client, &isl29028A_core_desc);
+	if(IS_ERR(isl_regmap))
+		return PTR_ERR(isl_regmap);
 	isl_data.last_mod = 0;
+	isl_data.enabled = 0;
 	isl_data.persist_flag = 0;
+	isl_data.event_mode = 1;
 	mutex_init(&isl_data.lock);
 
 	/* Initialise the sensor with default configuration */
@@ -1300,13 +1849,13 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
 	}
 
 	mutex_lock(&isl_data.lock);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
-	printk("CONFIG_REG_1 0x74 %x %d\n",ret,ret);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_2);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_1);
+	printk("CONFIG_REG_1 0x70 %x %d\n",ret,ret);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_2);
 	printk("CONFIG_REG_2 0x66 %x %d\n",ret,ret);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_TEST1);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_TEST1);
 	printk("test1 0x06 %x %d \n",ret,ret);
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_TEST2);
+	ret = isl_core_read(isl_regmap, CONFIG_REG_TEST2);
 	printk("test2 0x00 %x %d\n",ret,ret);
 	mutex_unlock(&isl_data.lock);
 #ifdef ISL29028A_INTERRUPT_MODE
@@ -1337,12 +1886,12 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
 		goto gpio_err;
 	} 
 
-	/* Initialize the work queue */
-	INIT_WORK(&isl_data.work,isl29028A_irq_thread);
-
-	/* Register irq handler for sensor */
-	if(request_irq(isl_data.irq_num, isl_sensor_irq_handler, 
-				IRQF_TRIGGER_FALLING, "isl29028A", NULL) < 0){
+	/* Register irq handlers for sensor, the data are reported from
+	   the irq thread rather than from the shared system workqueue */
+	if(request_threaded_irq(isl_data.irq_num, isl_sensor_irq_handler,
+				isl29028A_irq_thread,
+				IRQF_TRIGGER_FALLING | IRQF_ONESHOT,
+				"isl29028A", NULL) < 0){
 		pr_err("%s : %s:Failed to register irq handler",
 						 ISL29028_NAME, __func__);
 		goto gpio_err;
@@ -1374,6 +1923,18 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
 	if(setup_input_device())
                 goto gpio_err;
 
+	/* The input device stays the primary interface, IIO is optional */
+#ifdef ISL29028A_INTERRUPT_MODE
+	isl_data.iio = isl_iio_init(client, &isl29028A_iio_desc, true);
+#else
+	isl_data.iio = isl_iio_init(client, &isl29028A_iio_desc, false);
+#endif
+	if(IS_ERR(isl_data.iio)){
+		pr_err("%s :%s :IIO registration failed (%ld)\n", ISL29028_NAME,
+					__func__, PTR_ERR(isl_data.iio));
+		isl_data.iio = NULL;
+	}
+
 	return 0;
 
 #ifdef ISL29028A_INTERRUPT_MODE
@@ -1399,7 +1960,7 @@ static int isl_sensor_suspend(struct i2c_client *client, pm_message_t msg)
 
         short int reg;
 
-        reg = i2c_smbus_read_byte_data(isl_client, CONFIG_REG_1);
+        reg = isl_core_read(isl_regmap, CONFIG_REG_1);
         if(reg < 0){
 		__dbg_read_err("%s", __func__);
                 goto err;
@@ -1407,7 +1968,7 @@ static int isl_sensor_suspend(struct i2c_client *client, pm_message_t msg)
         isl_data.last_mod = reg;
 
         /* Put the sensor to ALS/IR Disabled and Proximity Disabled mode*/
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, ISL_OP_POWERDOWN) < 0){
+        if(isl_core_write(isl_regmap, CONFIG_REG_1, ISL_OP_POWERDOWN) < 0){
 		__dbg_write_err("%s", __func__);
                 goto err;
         }
@@ -1437,18 +1998,18 @@ static int isl_sensor_resume(struct i2c_client *client)
         short int reg;
 
 	/* As per the datasheet recommendations */
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1, ISL_REG_CLEAR) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_1, ISL_REG_CLEAR) < 0)
                 return -EINVAL;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST1, ISL_REG_TEST_1) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST1, ISL_REG_TEST_1) < 0)
                 return -EINVAL;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST2, ISL_REG_TEST_2) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST2, ISL_REG_TEST_2) < 0)
                 return -EINVAL;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_TEST2, ISL_REG_CLEAR) < 0)
+        if(isl_core_write(isl_regmap, CONFIG_REG_TEST2, ISL_REG_CLEAR) < 0)
                 return -EINVAL;
         mdelay(2);
 
         reg = isl_data.last_mod;
-        if(i2c_smbus_write_byte_data(isl_client, CONFIG_REG_1,reg) < 0){
+        if(isl_core_write(isl_regmap, CONFIG_REG_1,reg) < 0){
 		__dbg_read_err("%s", __func__);
                 goto err;
         }
@@ -1476,13 +2037,16 @@ static int __devexit isl_sensor_remove(struct i2c_client *client)
 {
 	sysfs_remove_group(isl_data.isl_kobj, &isl29028A_attr_grp);
 	kset_unregister(isl_data.isl_kset);
-	input_unregister_polled_device (isl_data.input_poll_dev);
-	input_free_polled_device (isl_data.input_poll_dev);
+	device_remove_file(&isl_data.input->dev, &dev_attr_poll_delay);
+	/* closes the device, which stops the poll work */
+	input_unregister_device (isl_data.input);
 
 #ifdef ISL29028A_INTERRUPT_MODE
 	free_irq(isl_data.irq_num, NULL);
 	gpio_free(39);
 #endif
+	/* only once the interrupt is gone, its handler fires the IIO trigger */
+	isl_iio_remove(isl_data.iio);
 	return 0;
 
 }
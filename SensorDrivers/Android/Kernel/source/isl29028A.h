@@ -50,6 +50,7 @@
 #define ISL_PROX_SLP_50ms 			(0x05 << ISL_PROX_SLP_POS)
 #define ISL_PROX_SLP_12500us 			(0x06 << ISL_PROX_SLP_POS)
 #define ISL_PROX_SLP_0ms 			(0x07 << ISL_PROX_SLP_POS)
+#define ISL_PROX_SLP_MASK			(0x07 << ISL_PROX_SLP_POS)
 
 /* Proximity Enable bits*/
 #define ISL_PROX_EN_POS				7
@@ -107,6 +108,21 @@
 #define ISL_ALSIR_TH1_DEF			0xCC
 #define ISL_ALSIR_TH2_DEF			0xC0
 #define ISL_ALSIR_TH3_DEF			0xCC
+/* prox sleep 0 ms, ALS and prox powered down until enabled from sysfs */
+#define ISL_REG_1_INIT				0x70
+/* prox interrupt after a single conversion out of the window, so near/far
+   transitions are reported within one conversion in event mode */
+#define ISL_REG_2_EVENT				(ISL_PROX_PERST_SET_1 | ISL_ALS_PERST_SET_16)
+
+/* Enable bits of isl29028A_data.enabled */
+#define ISL_ALS_ACTIVE				(1 << 0)
+#define ISL_PROX_ACTIVE				(1 << 1)
+
+/********************************** INPUT POLLING INTERVAL ***************************************/
+/* The HAL writes the requested period in ns to <input>/poll_delay */
+#define ISL_POLL_INTERVAL_DEF_MS		50
+#define ISL_POLL_INTERVAL_MIN_MS		10
+#define ISL_POLL_INTERVAL_MAX_MS		1000
 
 #ifndef __dbg_read_err
 #define __dbg_read_err(fmt, var) printk(KERN_ERR \
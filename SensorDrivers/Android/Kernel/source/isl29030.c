@@ -41,6 +41,7 @@
 #include <linux/pm.h>
 //#include <linux/pm_runtime.h>
 #include <linux/i2c/isl29030.h>
+#include <linux/input/isl_core.h>
 
 static int isl29030_last_lmod;
 static int isl29030_last_pmod;
@@ -50,6 +51,22 @@ static unsigned short isl29030_default_proxlt = ISL_DEFAULT_LT;
 
 static struct device      *isl29030_hwmon_dev;
 static struct i2c_client  *isl29030_i2c_client;
+/* cached register map, see isl_core */
+static struct regmap      *isl29030_regmap;
+
+/* interrupt flags in CMD_2, conversion data and the test registers */
+static const struct regmap_range isl29030_volatile_ranges[] = {
+    ISL_CORE_RANGE(REG_CMD_2, REG_CMD_2),
+    ISL_CORE_RANGE(REG_DATA_PROX, REG_DATA_MSB_ALS),
+    ISL_CORE_RANGE(REG_TEST1, REG_TEST2),
+};
+
+static const struct isl_core_desc isl29030_core_desc = {
+    .name                   = "isl29030",
+    .max_register           = REG_TEST2,
+    .volatile_ranges        = isl29030_volatile_ranges,
+    .num_volatile_ranges    = ARRAY_SIZE(isl29030_volatile_ranges),
+};
 
 struct isl29030_data {
     struct input_dev            *isl29030_idev;
@@ -81,7 +98,7 @@ static int isl_set_mod(struct i2c_client *client, int func, int mod)
     int ret, val;
 
     /* set operation mod */
-    val = i2c_smbus_read_byte_data(client, REG_CMD_1);
+    val = isl_core_read(isl29030_regmap, REG_CMD_1);
     if (val < 0)
         return -EINVAL;
 
@@ -109,7 +126,7 @@ static int isl_set_mod(struct i2c_client *client, int func, int mod)
         val &= ~PROX_EN_MASK;
     }
 
-    ret = i2c_smbus_write_byte_data(client, REG_CMD_1, val);
+    ret = isl_core_write(isl29030_regmap, REG_CMD_1, val);
     if (ret < 0)
         return -EINVAL;
 
@@ -126,7 +143,7 @@ static int isl_get_mod(struct i2c_client *client, int func)
 {
     int val, retval = ISL_MOD_DISABLE;
 
-    val = i2c_smbus_read_byte_data(client, REG_CMD_1);
+    val = isl_core_read(isl29030_regmap, REG_CMD_1);
     if (val < 0)
         return -EINVAL;
 
@@ -169,20 +186,20 @@ static void isl_adjust_als_thresholds( unsigned int newval )
     low_high_reg = (adj_lt & 0x0F00) >> 8;				
     low_high_reg |= (adj_ht & 0x000F) << 4;				
     high_reg = (adj_ht & 0x0FF0) >> 4;					
-//    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_LOW_ALS, low_reg);
-    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_LOW_ALS, 0xcc);
+//    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_ALS, low_reg);
+    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_ALS, 0xcc);
     if (ret < 0) {
         printk(KERN_ERR "error writing low als threshold\n");
         return;
     }
-//    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_LOW_HIGH_ALS, low_high_reg);
-    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_LOW_HIGH_ALS, 0xc0);
+//    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_HIGH_ALS, low_high_reg);
+    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_HIGH_ALS, 0xc0);
     if (ret < 0) {
         printk(KERN_ERR "error writing highlow als threshold\n");
         return;
     }
-//    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_HIGH_ALS, high_reg);
-    ret = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_INT_HIGH_ALS, 0xcc);
+//    ret = isl_core_write(isl29030_regmap, REG_INT_HIGH_ALS, high_reg);
+    ret = isl_core_write(isl29030_regmap, REG_INT_HIGH_ALS, 0xcc);
     if (ret < 0) {
         printk(KERN_ERR "error writing high als threshold\n");
         return;
@@ -208,12 +225,12 @@ static unsigned short isl_read_lux( struct i2c_client *client, unsigned short *r
 {
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
-    short msb_read = 0, lsb_read = 0;
+    u8 data[2];
     short val = 0;
     /*MSI VOLTRON END */
     unsigned short ret_val = 0, error = 0;
 
-    val = i2c_smbus_read_byte_data(client, REG_CMD_1);
+    val = isl_core_read(isl29030_regmap, REG_CMD_1);
     if (val < 0) {
         printk(KERN_ERR "error reading reg cmd1\n");
         return -EINVAL;
@@ -224,33 +241,28 @@ static unsigned short isl_read_lux( struct i2c_client *client, unsigned short *r
     else
         *range = 0;
 
-    msb_read = i2c_smbus_read_byte_data(client, REG_DATA_MSB_ALS);
-    if (msb_read < 0) {
-        printk(KERN_ERR "error reading msb data\n");
-        return -EINVAL;
-    }
-//    msb_read &= 0x000F;  // only four bits for 12-bit conversion
-
-    lsb_read = i2c_smbus_read_byte_data(client, REG_DATA_LSB_ALS);
-    if (lsb_read < 0) {
-        printk(KERN_ERR "error reading lsb data\n");
+    /* LSB and MSB in one transfer so a new conversion cannot tear them */
+    if (isl_core_read_block(isl29030_regmap, REG_DATA_LSB_ALS, data, sizeof(data)) < 0) {
+        printk(KERN_ERR "error reading als data\n");
         return -EINVAL;
     }
-//    lsb_read &= 0x00FF;
 
-    ret_val = (msb_read << 8) | lsb_read;
+    ret_val = (data[1] << 8) | data[0];
 
     /* we may need to clear this flag to get new values */
-    val = i2c_smbus_read_byte_data(client, REG_CMD_2);
+    val = isl_core_read(isl29030_regmap, REG_CMD_2);
     if (val < 0) {
         printk(KERN_ERR "error reading reg cmd2\n");
         return -EINVAL;
     }
-    val &= ~(ALS_INT_CLEAR);
-    error = i2c_smbus_write_byte_data(client, REG_CMD_2, val);
-    if (error < 0) {
-        printk(KERN_ERR "error writing reg cmd2\n");
-        return -EINVAL;
+    /* nothing to clear while no ALS interrupt is pending */
+    if (val & ALS_INT_CLEAR) {
+        val &= ~(ALS_INT_CLEAR);
+        error = isl_core_write(isl29030_regmap, REG_CMD_2, val);
+        if (error < 0) {
+            printk(KERN_ERR "error writing reg cmd2\n");
+            return -EINVAL;
+        }
     }
 
     return ret_val;
@@ -273,7 +285,7 @@ static int read_and_report_prox( struct isl29030_data *isl )
 
     mutex_lock(&mutex);
 
-    val = i2c_smbus_read_byte_data(isl29030_i2c_client, REG_DATA_PROX);
+    val = isl_core_read(isl29030_regmap, REG_DATA_PROX);
     if (val < 0)
         goto prox_out;
     prox_result = val;
@@ -283,12 +295,12 @@ static int read_and_report_prox( struct isl29030_data *isl )
     // we can't really check high and low thresholds anyway, just report
     // the abs value
 
-    val = i2c_smbus_read_byte_data(isl29030_i2c_client, REG_INT_LOW_PROX);
+    val = isl_core_read(isl29030_regmap, REG_INT_LOW_PROX);
     if (val < 0)
         goto prox_out;
     prox_lt = val;
 
-    val = i2c_smbus_read_byte_data(isl29030_i2c_client, REG_INT_HIGH_PROX);
+    val = isl_core_read(isl29030_regmap, REG_INT_HIGH_PROX);
     if (val < 0)
         goto prox_out;
     prox_ht = val;
@@ -309,11 +321,11 @@ static int read_and_report_prox( struct isl29030_data *isl )
     input_sync(isl->isl29030_idev);
 
     /* we may need to clear this flag to get new values */
-    val = i2c_smbus_read_byte_data(isl29030_i2c_client, REG_CMD_2);
+    val = isl_core_read(isl29030_regmap, REG_CMD_2);
     if (val < 0)
         goto prox_out;
     val &= ~(PROX_INT_CLEAR);
-    error = i2c_smbus_write_byte_data(isl29030_i2c_client, REG_CMD_2, val);
+    error = isl_core_write(isl29030_regmap, REG_CMD_2, val);
     if (error < 0)
         goto prox_out;
 
@@ -356,14 +368,14 @@ static void isl29030_irq_worker( struct work_struct *work )
 
 	mutex_lock(&mutex);
     /* read to determine which interrupt has tripped (or both) */
-    reg_read = i2c_smbus_read_byte_data(isl29030_i2c_client, REG_CMD_2);
+    reg_read = isl_core_read(isl29030_regmap, REG_CMD_2);
 	mutex_unlock(&mutex);
 	//	printk("done!\n");
     if (reg_read < 0) {
         printk(KERN_ERR "failure to read status");
         goto work_out;
     }
-/*    if(i2c_smbus_write_byte_data(isl29030_i2c_client,REG_CMD_2,
+/*    if(isl_core_write(isl29030_regmap, REG_CMD_2,
                                 (ret & 0x66)) < 0){
                 printk(KERN_ERR"%s", __func__);
                 goto work_out;
@@ -372,11 +384,11 @@ static void isl29030_irq_worker( struct work_struct *work )
 
     if ((reg_read & ALS_INT_CLEAR) == ALS_INT_CLEAR) {
      //   result = read_and_report_lux(isl)
-	i2c_smbus_write_byte_data(isl29030_i2c_client, REG_CMD_2,0x05 );
+	isl_core_write(isl29030_regmap, REG_CMD_2,0x05 );
     }
 
     if ((reg_read & PROX_INT_CLEAR) == PROX_INT_CLEAR) {
-	i2c_smbus_write_byte_data(isl29030_i2c_client, REG_CMD_2,0x41 );
+	isl_core_write(isl29030_regmap, REG_CMD_2,0x41 );
      //   result = read_and_report_prox(isl);
     }
 
@@ -497,7 +509,6 @@ static ssize_t isl_lmod_show(struct device *dev, struct device_attribute *attr,
 
 static ssize_t isl_range_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
     short ret_val = 0;
@@ -518,12 +529,12 @@ static ssize_t isl_range_store(struct device *dev, struct device_attribute *attr
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    reg_read = i2c_smbus_read_byte_data(client, REG_CMD_1);
+    reg_read = isl_core_read(isl29030_regmap, REG_CMD_1);
     if (val)
         reg_read |= ALS_RANGE_HIGH_MASK;
     else
         reg_read &= ~ALS_RANGE_HIGH_MASK;
-    ret_val = i2c_smbus_write_byte_data(client, REG_CMD_1, reg_read);
+    ret_val = isl_core_write(isl29030_regmap, REG_CMD_1, reg_read);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -534,12 +545,11 @@ static ssize_t isl_range_store(struct device *dev, struct device_attribute *attr
 
 static ssize_t isl_range_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     int val;
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    val = i2c_smbus_read_byte_data(client, REG_CMD_1);
+    val = isl_core_read(isl29030_regmap, REG_CMD_1);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -577,7 +587,6 @@ static ssize_t isl_factor_show(struct device *dev, struct device_attribute *attr
 
 static ssize_t isl_proxlt_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
     short ret_val = 0;
@@ -593,7 +602,7 @@ static ssize_t isl_proxlt_store(struct device *dev, struct device_attribute *att
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    ret_val = i2c_smbus_write_byte_data(client, REG_INT_LOW_PROX, val);
+    ret_val = isl_core_write(isl29030_regmap, REG_INT_LOW_PROX, val);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -604,7 +613,6 @@ static ssize_t isl_proxlt_store(struct device *dev, struct device_attribute *att
 
 static ssize_t isl_proxlt_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
     short val = 0;
@@ -612,7 +620,7 @@ static ssize_t isl_proxlt_show(struct device *dev, struct device_attribute *attr
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    val = i2c_smbus_read_byte_data(client, REG_INT_LOW_PROX);
+    val = isl_core_read(isl29030_regmap, REG_INT_LOW_PROX);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -624,7 +632,6 @@ static ssize_t isl_proxlt_show(struct device *dev, struct device_attribute *attr
 
 static ssize_t isl_proxht_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
     short ret_val = 0;
@@ -639,7 +646,7 @@ static ssize_t isl_proxht_store(struct device *dev, struct device_attribute *att
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    ret_val = i2c_smbus_write_byte_data(client, REG_INT_HIGH_PROX, val);
+    ret_val = isl_core_write(isl29030_regmap, REG_INT_HIGH_PROX, val);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -650,7 +657,6 @@ static ssize_t isl_proxht_store(struct device *dev, struct device_attribute *att
 
 static ssize_t isl_proxht_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     /*MSI VOLTRON BEGIN */
     /*Comparison of unsigned value against 0 is always false,return value is -ve*/
     short val = 0;
@@ -658,7 +664,7 @@ static ssize_t isl_proxht_show(struct device *dev, struct device_attribute *attr
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
-    val = i2c_smbus_read_byte_data(client, REG_INT_HIGH_PROX);
+    val = isl_core_read(isl29030_regmap, REG_INT_HIGH_PROX);
     //pm_runtime_put_sync(dev);
     mutex_unlock(&mutex);
 
@@ -699,24 +705,23 @@ err_exit:
 
 static ssize_t isl_distance_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     int val, error;
     int output = 0;
 
     mutex_lock(&mutex);
     //pm_runtime_get_sync(dev);
 
-    val = i2c_smbus_read_byte_data(client, REG_DATA_PROX);
+    val = isl_core_read(isl29030_regmap, REG_DATA_PROX);
     if (val < 0)
         goto err_exit;
     output = val;
 
     /* we may need to clear this flag to get new values */
-    val = i2c_smbus_read_byte_data(client, REG_CMD_2);
+    val = isl_core_read(isl29030_regmap, REG_CMD_2);
     if (val < 0)
         goto err_exit;
     val &= ~(PROX_INT_CLEAR);
-    error = i2c_smbus_write_byte_data(client, REG_CMD_2, val);
+    error = isl_core_write(isl29030_regmap, REG_CMD_2, val);
     if (error < 0)
         goto err_exit;
 
@@ -733,11 +738,10 @@ err_exit:
 unsigned char last_isl29030_register = REG_CMD_1;
 static ssize_t isl_reg_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     int reg_value = 0;
 
     mutex_lock(&mutex);
-    reg_value = i2c_smbus_read_byte_data(client, last_isl29030_register);
+    reg_value = isl_core_read(isl29030_regmap, last_isl29030_register);
     mutex_unlock(&mutex);
     return sprintf(buf, "%02X:%02X\n", last_isl29030_register, reg_value);
 }
@@ -745,7 +749,6 @@ static ssize_t isl_reg_show(struct device *dev, struct device_attribute *attr, c
 static ssize_t isl_reg_store(struct device *dev, struct device_attribute *attr,
                     const char *buf, size_t count)
 {
-    struct i2c_client *client = isl29030_i2c_client;
     int reg_value = 0;
     int len = 0;
     unsigned long conversion;
@@ -772,7 +775,7 @@ static ssize_t isl_reg_store(struct device *dev, struct device_attribute *attr,
                 return -EINVAL;
             temp_val = (unsigned char)conversion;
 
-            i2c_smbus_write_byte_data(client, last_isl29030_register, temp_val);
+            isl_core_write(isl29030_regmap, last_isl29030_register, temp_val);
             break;
         case 6:
             strncpy(&temp_buf[0], buf, 2);
@@ -788,9 +791,9 @@ static ssize_t isl_reg_store(struct device *dev, struct device_attribute *attr,
                 return -EINVAL;
             temp_mask = (unsigned char)conversion;
 
-            reg_value = i2c_smbus_read_byte_data(client, last_isl29030_register);
+            reg_value = isl_core_read(isl29030_regmap, last_isl29030_register);
             read = (reg_value & ~temp_mask) | (temp_val & temp_mask);
-            i2c_smbus_write_byte_data(client, last_isl29030_register, read);
+            isl_core_write(isl29030_regmap, last_isl29030_register, read);
             break;
         default:
             // bad, do not set anything
@@ -844,22 +847,27 @@ static int isl_set_default_config(struct i2c_client *client)
 
     // APP note to properly power on chip
     reg_out = 0x00;
-    ret = i2c_smbus_write_byte_data(client, REG_CMD_1, reg_out);
+    ret = isl_core_write(isl29030_regmap, REG_CMD_1, reg_out);
     if (ret < 0)
         return -EINVAL;
-    ret = i2c_smbus_write_byte_data(client, REG_TEST2, 0x29);
+    ret = isl_core_write(isl29030_regmap, REG_TEST2, 0x29);
     if (ret < 0)
         return -EINVAL;
-    ret = i2c_smbus_write_byte_data(client, REG_TEST1, 0x00);
+    ret = isl_core_write(isl29030_regmap, REG_TEST1, 0x00);
     if (ret < 0)
         return -EINVAL;
-    ret = i2c_smbus_write_byte_data(client, REG_TEST2, 0x00);
+    ret = isl_core_write(isl29030_regmap, REG_TEST2, 0x00);
     if (ret < 0)
         return -EINVAL;
 
     // sleep after this app note functionality
     msleep(2);
 
+    // the sequence above reset every register behind the cache
+    ret = isl_core_reload(isl29030_regmap, &isl29030_core_desc);
+    if (ret < 0)
+        return -EINVAL;
+
     // Now go ahead and start initializing
 
     // default high, range = 1
@@ -869,26 +877,26 @@ static int isl_set_default_config(struct i2c_client *client)
     reg_out &= ISL_CLEAR_PULSE_RATE;//0x02
     reg_out |= (ISL_PULSE_RATE_CONT << 4);//0x62
 
-//    ret = i2c_smbus_write_byte_data(client, REG_CMD_1, reg_out);
-    ret = i2c_smbus_write_byte_data(client, REG_CMD_1, 0x66);
+//    ret = isl_core_write(isl29030_regmap, REG_CMD_1, reg_out);
+    ret = isl_core_write(isl29030_regmap, REG_CMD_1, 0x66);
     if (ret < 0)
         return -EINVAL;
 
     // initialize the prox wait period
     reg_out = 0x00;
     reg_out |= (ISL_DEFAULT_PROX_PRST << 5);//0x60
-    ret = i2c_smbus_write_byte_data(client, REG_CMD_2, reg_out);
+    ret = isl_core_write(isl29030_regmap, REG_CMD_2, reg_out);
     if (ret < 0)
         return -EINVAL;
 /*        // Writing interrupt low threshold as 0xCCC (5% of max range) 
-        if(i2c_smbus_write_byte_data(client, REG_INT_LOW_ALS, 0x0C) < 0)
+        if(isl_core_write(isl29030_regmap, REG_INT_LOW_ALS, 0x0C) < 0)
                 return -EINVAL;
 
-        if(i2c_smbus_write_byte_data(client, REG_INT_LOW_HIGH_ALS, 0xC0) < 0 )
+        if(isl_core_write(isl29030_regmap, REG_INT_LOW_HIGH_ALS, 0xC0) < 0 )
                 return -EINVAL;
 
         // Writing interrupt high threshold as 0xCCCC (80% of max range)  
-       if(i2c_smbus_write_byte_data(client, REG_INT_HIGH_ALS, 0xCC) < 0)
+       if(isl_core_write(isl29030_regmap, REG_INT_HIGH_ALS, 0xCC) < 0)
 
                 return -EINVAL;*/
 
@@ -896,13 +904,13 @@ static int isl_set_default_config(struct i2c_client *client)
     isl_adjust_als_thresholds( 0xFFFF );
 
     // initialize the prox thresholds
-//    ret = i2c_smbus_write_byte_data(client, REG_INT_LOW_PROX, isl29030_default_proxlt);
-    ret = i2c_smbus_write_byte_data(client, REG_INT_LOW_PROX, 0x0c);
+//    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_PROX, isl29030_default_proxlt);
+    ret = isl_core_write(isl29030_regmap, REG_INT_LOW_PROX, 0x0c);
     if (ret < 0)
         return -EINVAL;
 
-//    ret = i2c_smbus_write_byte_data(client, REG_INT_HIGH_PROX, isl29030_default_proxht);
-    ret = i2c_smbus_write_byte_data(client, REG_INT_HIGH_PROX, 0xcc);
+//    ret = isl_core_write(isl29030_regmap, REG_INT_HIGH_PROX, isl29030_default_proxht);
+    ret = isl_core_write(isl29030_regmap, REG_INT_HIGH_PROX, 0xcc);
     if (ret < 0)
         return -EINVAL;
 
@@ -959,6 +967,9 @@ isl29030_probe(struct i2c_client *client, const struct i2c_device_id *id)
     struct isl29030_platform_data *pdata = client->dev.platform_data;
 
     isl29030_i2c_client = client;
+    isl29030_regmap = isl_core_init(client, &isl29030_core_desc);
+    if (IS_ERR(isl29030_regmap))
+        return PTR_ERR(isl29030_regmap);
 	
     mutex_init(&mutex);
 
@@ -1080,27 +1091,27 @@ isl29030_probe(struct i2c_client *client, const struct i2c_device_id *id)
 
 /*
         mutex_lock(&mutex);
-        ret = i2c_smbus_read_byte_data(client, REG_CMD_1);
+        ret = isl_core_read(isl29030_regmap, REG_CMD_1);
         printk("CONFIG_REG_1 0x01 0x66 %x %d\n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_CMD_2);
+        ret = isl_core_read(isl29030_regmap, REG_CMD_2);
         printk("CONFIG_REG_2 0x02 0x60 %x %d\n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_TEST1);
+        ret = isl_core_read(isl29030_regmap, REG_TEST1);
         printk("test1 0x0E 0x00 %x %d \n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_TEST2);
+        ret = isl_core_read(isl29030_regmap, REG_TEST2);
         printk("test2 0x0F 0x00 %x %d\n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_INT_LOW_PROX);
+        ret = isl_core_read(isl29030_regmap, REG_INT_LOW_PROX);
         printk("PROX_REG_low 0x03 0x00 %x %d\n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_INT_HIGH_PROX);
+        ret = isl_core_read(isl29030_regmap, REG_INT_HIGH_PROX);
         printk("PROX_REG_high 0x04 0x00%x %d\n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_INT_LOW_ALS);
+        ret = isl_core_read(isl29030_regmap, REG_INT_LOW_ALS);
         printk("ALSIR_TH1 0x05 0x0000 %x %d \n",ret,ret);
-        ret = i2c_smbus_read_byte_data(client, REG_INT_LOW_HIGH_ALS);
+        ret = isl_core_read(isl29030_regmap, REG_INT_LOW_HIGH_ALS);
         printk("ALSIR_TH2 0x06 0x00C0 %x %d\n",ret,ret);
-	ret = i2c_smbus_read_byte_data(client,REG_INT_HIGH_ALS );
+	ret = isl_core_read(isl29030_regmap, REG_INT_HIGH_ALS );
 	printk("ALSIR_TH3 0x07 0x0000 %x %d\n",ret,ret);
 
         mutex_unlock(&mutex);*/
-	i2c_smbus_write_byte_data(client,REG_CMD_2,0x04);
+	isl_core_write(isl29030_regmap, REG_CMD_2,0x04);
 
     return 0;
 
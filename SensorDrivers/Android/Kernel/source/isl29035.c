@@ -36,6 +36,7 @@
 #include <linux/sysfs.h>
 #include <linux/irq.h>
 #include <linux/isl29035.h>
+#include <linux/input/isl_core.h>
 #include <linux/delay.h>
 #ifndef _PRINTK_H_
 #include <linux/printk.h>
@@ -46,13 +47,14 @@
 
 static struct isl29035_data {
         struct i2c_client *client_data;
-        struct work_struct work;
+        struct regmap *regmap;          /* cached registers, see isl_core */
         struct mutex isl_mutex;
         int32_t last_mod;
         int16_t intr_flag;
 	uint8_t count;
         uint16_t last_ir_lt;
         uint32_t irq_num;
+        struct isl_core_latency latency;
         uint16_t last_ir_ht;
         uint16_t last_als_lt;
         uint16_t last_als_ht;
@@ -67,6 +69,20 @@ static struct i2c_device_id isl_device_table[] = {
 
 MODULE_DEVICE_TABLE(i2c, isl_device_table);
 
+/* interrupt flag in CMD_REG_1, conversion data, brown-out flag in DEV_ID */
+static const struct regmap_range isl29035_volatile_ranges[] = {
+	ISL_CORE_RANGE(ISL29035_CMD_REG_1, ISL29035_CMD_REG_1),
+	ISL_CORE_RANGE(ISL29035_DATA_LSB, ISL29035_DATA_MSB),
+	ISL_CORE_RANGE(ISL29035_DEV_ID_REG, ISL29035_DEV_ID_REG),
+};
+
+static const struct isl_core_desc isl29035_core_desc = {
+	.name			= "isl29035",
+	.max_register		= ISL29035_DEV_ID_REG,
+	.volatile_ranges	= isl29035_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29035_volatile_ranges),
+};
+
 /*
  * @fn          get_adc_resolution_bits
  *
@@ -79,7 +95,7 @@ MODULE_DEVICE_TABLE(i2c, isl_device_table);
 static int32_t get_adc_resolution_bits(uint16_t *res)
 {
         int16_t ret;
-        ret = i2c_smbus_read_byte_data(isl_data.client_data, ISL29035_CMD_REG_2);
+        ret = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_2);
         if(ret < 0)
                 return -1;
 
@@ -107,14 +123,12 @@ static int32_t get_adc_resolution_bits(uint16_t *res)
 static int32_t set_adc_resolution_bits(uint16_t res)
 {
         uint16_t reg;
-        reg = i2c_smbus_read_byte_data(isl_data.client_data,
-                                        ISL29035_CMD_REG_2);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_2);
         if(reg < 0)
                 return -1;
 
         reg =  ( reg & ISL29035_ADC_READ_MASK ) | res;
-        if(i2c_smbus_write_byte_data(isl_data.client_data,
-                                        ISL29035_CMD_REG_2, reg) < 0)
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_2, reg) < 0)
                 return -1;
         return 0;
 }
@@ -201,10 +215,9 @@ static ssize_t show_intr_persistency(struct device *dev,
 {
         int16_t reg;
         int16_t intr_persist;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
-        reg = i2c_smbus_read_byte_data(client, ISL29035_CMD_REG_1);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
         if(reg < 0){
                 mutex_unlock(&isl_data.isl_mutex);
 		__dbg_read_err("%s",__func__);
@@ -239,7 +252,6 @@ static ssize_t store_intr_persistency(struct device *dev,
 {
         int16_t intr_persist;
         int16_t reg;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
         intr_persist = simple_strtoul(buf, NULL, 10);
@@ -257,14 +269,14 @@ static ssize_t store_intr_persistency(struct device *dev,
                 goto err_out;
         }
 
-        reg = i2c_smbus_read_byte_data(client, ISL29035_CMD_REG_1);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
         if (reg < 0) {
 		__dbg_read_err("%s",__func__);
                 goto err_out;
         }
 
         reg = (reg & ISL29035_PERSIST_BIT_CLEAR) | intr_persist;
-        if(i2c_smbus_write_byte_data(client, ISL29035_CMD_REG_1, reg) < 0){
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_1, reg) < 0){
 		__dbg_read_err("%s",__func__);
                 goto err_out;
         }
@@ -287,19 +299,14 @@ err_out:
  *
  */
 
-static int32_t isl29035_i2c_read_word16(struct i2c_client *client,
-                        uint8_t reg_addr, uint16_t *buf)
+static int32_t isl29035_i2c_read_word16(uint8_t reg_addr, uint16_t *buf)
 {
-        short int reg_h;
-        short int reg_l;
-        reg_l = i2c_smbus_read_byte_data(client, reg_addr);
-        if (reg_l < 0)
-                return -EINVAL;
+        int ret;
 
-        reg_h = i2c_smbus_read_byte_data(client, reg_addr + 1);
-        if (reg_h < 0)
+        ret = isl_core_read16(isl_data.regmap, reg_addr);
+        if (ret < 0)
                 return -EINVAL;
-        *buf = (reg_h << 8) | reg_l;
+        *buf = ret;
 	isl_data.count++;
         return 0;
 }
@@ -313,19 +320,9 @@ static int32_t isl29035_i2c_read_word16(struct i2c_client *client,
  *
  */
 
-static int32_t isl29035_i2c_write_word16(struct i2c_client *client,
-                        uint8_t reg_addr, uint16_t *buf)
+static int32_t isl29035_i2c_write_word16(uint8_t reg_addr, uint16_t *buf)
 {
-        uint8_t reg_h;
-        uint8_t reg_l;
-
-        /* Extract LSB and MSB bytes from data */
-        reg_l = *buf & 0xFF;
-        reg_h = (*buf & 0xFF00) >> 8;
-
-        if(i2c_smbus_write_byte_data(client, reg_addr, reg_l) < 0)
-                return -1;
-        if(i2c_smbus_write_byte_data(client, reg_addr + 1, reg_h) < 0)
+        if(isl_core_write16(isl_data.regmap, reg_addr, *buf) < 0)
                 return -1;
         return 0;
 }
@@ -348,15 +345,13 @@ static ssize_t show_intr_threshold_high(struct device *dev,
                 char *buf)
 {
         uint16_t reg;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
         if(isl_data.intr_flag){
                 sprintf(buf, "%d\n",isl_data.last_ir_ht);
                 goto end;
         }else{
-                if(isl29035_i2c_read_word16(client,
-                                ISL29035_HT_LBYTE, &reg) < 0){
+                if(isl29035_i2c_read_word16(ISL29035_HT_LBYTE, &reg) < 0){
 			__dbg_read_err("%s",__func__);
                         mutex_unlock(&isl_data.isl_mutex);
                         return -1;
@@ -384,7 +379,6 @@ static ssize_t store_intr_threshold_high(struct device *dev,
                 const char *buf, size_t count)
 {
         uint16_t reg;
-        struct i2c_client *client = to_i2c_client(dev);
 
         reg = simple_strtoul(buf, NULL, 10);
         if (reg <= 0 || reg > 65535){
@@ -393,8 +387,7 @@ static ssize_t store_intr_threshold_high(struct device *dev,
         }
         mutex_lock(&isl_data.isl_mutex);
 
-        if(isl29035_i2c_write_word16(client,
-                                ISL29035_HT_LBYTE, &reg) < 0){
+        if(isl29035_i2c_write_word16(ISL29035_HT_LBYTE, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		goto err_out;
         }
@@ -427,7 +420,6 @@ static ssize_t show_intr_threshold_low(struct device *dev,
 {
         uint16_t  reg;
         int32_t   ret;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
         if(isl_data.intr_flag){
@@ -435,8 +427,7 @@ static ssize_t show_intr_threshold_low(struct device *dev,
                 goto end;
         }
         else{
-                ret = isl29035_i2c_read_word16(client,
-                                ISL29035_LT_LBYTE, &reg);
+                ret = isl29035_i2c_read_word16(ISL29035_LT_LBYTE, &reg);
                 if (ret < 0) {
 			__dbg_read_err("%s",__func__);
                         mutex_unlock(&isl_data.isl_mutex);
@@ -465,7 +456,6 @@ static ssize_t store_intr_threshold_low(struct device *dev,
                 const char *buf, size_t count)
 {
         uint16_t reg;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
         reg = simple_strtoul(buf, NULL, 10);
@@ -474,8 +464,7 @@ static ssize_t store_intr_threshold_low(struct device *dev,
                 mutex_unlock(&isl_data.isl_mutex);
                 return -1;
         }
-        if(isl29035_i2c_write_word16(client,
-                                ISL29035_LT_LBYTE, &reg) < 0){
+        if(isl29035_i2c_write_word16(ISL29035_LT_LBYTE, &reg) < 0){
 		__dbg_write_err("%s",__func__);
                 mutex_unlock(&isl_data.isl_mutex);
                 return -1;
@@ -504,7 +493,7 @@ static ssize_t store_intr_threshold_low(struct device *dev,
 static int isl_get_sensing_range(unsigned int *als_range)
 {
         int ret;
-        ret = i2c_smbus_read_byte_data(isl_data.client_data,ISL29035_CMD_REG_2);
+        ret = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_2);
         if(ret < 0){
                 mutex_unlock(&isl_data.isl_mutex);
 		__dbg_read_err("%s",__func__);
@@ -533,13 +522,11 @@ static int isl_get_sensing_range(unsigned int *als_range)
 static int32_t isl_set_sensing_range(unsigned long val)
 {
         int16_t reg;
-        reg = i2c_smbus_read_byte_data(isl_data.client_data,
-                                        ISL29035_CMD_REG_2);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_2);
         if(reg < 0)
                 return -EINVAL;
         reg = ( reg & 0xfc) | val;
-        if(i2c_smbus_write_byte_data(isl_data.client_data,
-                                        ISL29035_CMD_REG_2, reg) < 0)
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_2, reg) < 0)
                 return -EINVAL;
         return 0;
 }
@@ -557,15 +544,13 @@ static int isl_set_sensing_mode(int mod)
 {
         int reg;
 
-        reg = i2c_smbus_read_byte_data(isl_data.client_data,
-                                             ISL29035_CMD_REG_1);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
         if(reg < 0)
                 return -EINVAL;
 
         isl_data.last_mod = reg;
         reg = (reg & 0x1F) | mod;
-        if(i2c_smbus_write_byte_data(isl_data.client_data,
-                                       ISL29035_CMD_REG_1 ,reg) < 0)
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_1 ,reg) < 0)
                 return -EINVAL;
         return 0;
 }
@@ -584,7 +569,7 @@ static int isl_set_sensing_mode(int mod)
 static int32_t isl_get_sensing_mode(struct i2c_client *client)
 {
         int32_t reg ;
-        reg = i2c_smbus_read_byte_data(client , ISL29035_CMD_REG_1);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
         if(reg < 0)
                 return -1;
         return ((reg & 0xf0) >> 5);
@@ -653,7 +638,6 @@ static ssize_t store_sensing_mode(struct device *dev,
                 struct device_attribute *attr,
                 const char *buf, size_t count)
 {
-        struct i2c_client *client = to_i2c_client(dev);
         ulong mode;
 
 	if(strict_strtoul(buf, 10, &mode))
@@ -684,19 +668,19 @@ static ssize_t store_sensing_mode(struct device *dev,
 		goto err_out;
         }
         if(isl_data.intr_flag){
-                if(isl29035_i2c_write_word16(client, ISL29035_LT_LBYTE,
+                if(isl29035_i2c_write_word16(ISL29035_LT_LBYTE,
                                         &isl_data.last_ir_lt) < 0)
 			__dbg_write_err("%s",__func__);
-                if(isl29035_i2c_write_word16(client, ISL29035_HT_LBYTE,
+                if(isl29035_i2c_write_word16(ISL29035_HT_LBYTE,
                                         &isl_data.last_ir_ht) < 0)
 			__dbg_write_err("%s",__func__);
 
         }else{
-                if(isl29035_i2c_write_word16(client, ISL29035_LT_LBYTE,
+                if(isl29035_i2c_write_word16(ISL29035_LT_LBYTE,
                                         &isl_data.last_als_lt) < 0){
 			__dbg_write_err("%s",__func__);
                 }
-                if(isl29035_i2c_write_word16(client, ISL29035_HT_LBYTE,
+                if(isl29035_i2c_write_word16(ISL29035_HT_LBYTE,
                                         &isl_data.last_als_ht) < 0 ){
 			__dbg_write_err("%s",__func__);
                 }
@@ -954,10 +938,9 @@ static ssize_t show_als_data(struct device *dev,
                 char *buf)
 {
         uint16_t val;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
-        if(isl29035_i2c_read_word16(client, ISL29035_DATA_LSB, &val) < 0){
+        if(isl29035_i2c_read_word16(ISL29035_DATA_LSB, &val) < 0){
                 mutex_unlock(&isl_data.isl_mutex);
 		__dbg_read_err("%s",__func__);
                 return -1;
@@ -977,7 +960,7 @@ static uint16_t get_measure(void)
 	msleep(100);
 	isl_data.count = 0;
 	isl_get_sensing_range(&als_range);
-        if(isl29035_i2c_read_word16(isl_data.client_data, ISL29035_DATA_LSB, &val) < 0){
+        if(isl29035_i2c_read_word16(ISL29035_DATA_LSB, &val) < 0){
                 __dbg_read_err("%s",__func__);
                 return -1;
         }
@@ -989,7 +972,7 @@ static uint16_t get_measure(void)
 		if(isl_data.count < MAX_COUNT){
 		isl_data.count = 0;
 		msleep(300);
-        		if(isl29035_i2c_read_word16(isl_data.client_data, ISL29035_DATA_LSB, &val) < 0){
+        		if(isl29035_i2c_read_word16(ISL29035_DATA_LSB, &val) < 0){
                 	__dbg_read_err("%s",__func__);
                 	return -1;
         		}
@@ -1025,10 +1008,9 @@ static ssize_t show_ir_data(struct device *dev,
                 struct device_attribute *attr, char *buf)
 {	
         uint16_t val;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&isl_data.isl_mutex);
-        if(isl29035_i2c_read_word16(client, ISL29035_DATA_LSB, &val) < 0){
+        if(isl29035_i2c_read_word16(ISL29035_DATA_LSB, &val) < 0){
 		__dbg_read_err("%s",__func__);
                 mutex_unlock(&isl_data.isl_mutex);
                 return -1;
@@ -1060,6 +1042,44 @@ static ssize_t show_ir_corr(struct device *dev,
 }
 
 
+#ifdef ISL29035_INTERRUPT_MODE
+/*
+ * @fn          show_irq_latency
+ *
+ * @brief       This function shows the interrupt to report latency as
+ *              "last max average count", the times in microseconds
+ *
+ * @return      Returns data buffer length
+ *
+ */
+
+static ssize_t show_irq_latency(struct device *dev,
+                struct device_attribute *attr, char *buf)
+{
+        return isl_core_latency_show(&isl_data.latency, buf);
+}
+
+/*
+ * @fn          store_irq_latency
+ *
+ * @brief       This function restarts the latency measurement on any
+ *              write
+ *
+ * @return      Returns length of data buffer
+ *
+ */
+
+static ssize_t store_irq_latency(struct device *dev,
+                struct device_attribute *attr, const char *buf, size_t count)
+{
+        disable_irq(isl_data.irq_num);
+        isl_core_latency_reset(&isl_data.latency);
+        enable_irq(isl_data.irq_num);
+        return count;
+}
+#endif
+
+
 /*******************Attributes of ISL29035 ALS Sensor*********/
 
 /* Device attributes for adc resolution sysfs */
@@ -1091,6 +1111,9 @@ static DEVICE_ATTR( intr_threshold_low, ISL29035_SYSFS_PERM ,
 /* Device attributes for interrupt persistency sysfs */
 static DEVICE_ATTR( intr_persistency, ISL29035_SYSFS_PERM ,
                 show_intr_persistency, store_intr_persistency);
+/* Device attributes for interrupt latency sysfs */
+static DEVICE_ATTR( irq_latency, ISL29035_SYSFS_PERM ,
+                show_irq_latency, store_irq_latency);
 #endif
 
 
@@ -1106,6 +1129,7 @@ static struct attribute *isl29035_attr[] = {
         &dev_attr_intr_threshold_high.attr,
         &dev_attr_intr_threshold_low.attr,
         &dev_attr_intr_persistency.attr,
+        &dev_attr_irq_latency.attr,
 #endif
         &dev_attr_als_data.attr,
         NULL
@@ -1118,28 +1142,35 @@ static struct attribute_group isl29035_attr_grp = {
 
 
 #ifdef ISL29035_INTERRUPT_MODE  
+/*
+ * @fn          isl_sensor_irq_handler
+ *
+ * @brief       Hard interrupt handler, stamps the interrupt and wakes
+ *              the irq thread. The line stays masked until the thread
+ *              returns (IRQF_ONESHOT).
+ *
+ * @return      IRQ_WAKE_THREAD
+ */
 static irqreturn_t isl_sensor_irq_handler(int irq, void *dev_id)
 {
-	disable_irq_nosync(isl_data.irq_num);
-        schedule_work(&isl_data.work);
-        return IRQ_HANDLED;
-	
+        isl_core_irq_stamp(&isl_data.latency);
+        return IRQ_WAKE_THREAD;
 }
 /*
- * @fn          sensor_irq_thread
+ * @fn          isl29035_irq_thread
  *
- * @brief       This thread is scheduled by sensor interrupt
+ * @brief       This thread runs at real-time priority after a sensor
+ *              interrupt
  *
- * @return      void
+ * @return      IRQ_HANDLED
  */
 
 
-static void isl29035_irq_thread(struct work_struct *work)
+static irqreturn_t isl29035_irq_thread(int irq, void *dev_id)
 {
 	int16_t reg;
         uint16_t val;
-        reg = i2c_smbus_read_byte_data(isl_data.client_data,
-                                                ISL29035_CMD_REG_1);
+        reg = isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
 	/* Read CMD_REG_1 to clear the interrupt */
         if(reg < 0){
                 pr_err( "%s :%s :Failed to read ISL29035_CMD_REG_1"
@@ -1148,13 +1179,13 @@ static void isl29035_irq_thread(struct work_struct *work)
         }
 	
 	/* Report the lux*/
-        if (isl29035_i2c_read_word16(isl_data.client_data,
-                                ISL29035_DATA_LSB, &val) < 0)
+        if (isl29035_i2c_read_word16(ISL29035_DATA_LSB, &val) < 0)
                 goto err;
 
 	autorange(val);
 err:
-        enable_irq(isl_data.irq_num);
+        isl_core_latency_done(&isl_data.latency);
+        return IRQ_HANDLED;
 }
 #endif
 
@@ -1173,44 +1204,44 @@ static int32_t initialize_isl29035(struct i2c_client *client)
 {
 
         /* Reset the device to avoid previous saturations */
-        if(i2c_smbus_write_byte_data(client, ISL29035_CMD_REG_1, 0x00) < 0)
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_1, 0x00) < 0)
                 return -EINVAL;
 	
         /* Clear the brown-Out flag */
-        if(i2c_smbus_write_byte_data(client, ISL29035_DEV_ID_REG, 0x28) < 0)
+        if(isl_core_write(isl_data.regmap, ISL29035_DEV_ID_REG, 0x28) < 0)
                 return -EINVAL;
         
         /*   Set Operating Mode: ALS Continuous
              Set Interrupt Persistency: 16 cycles */
 
-        if(i2c_smbus_write_byte_data(client, ISL29035_CMD_REG_1,
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_1,
 				    ISL29035_CMD_REG_1_DEF) < 0)
                 return -EINVAL;
 
         /* Set ADC Resolution : 16-bit
            Set Sensing Range  : 16000 */
 
-        if(i2c_smbus_write_byte_data(client , ISL29035_CMD_REG_2,
+        if(isl_core_write(isl_data.regmap, ISL29035_CMD_REG_2,
 				    ISL29035_CMD_REG_2_DEF) < 0)
                 return -EINVAL;
 
 #ifdef ISL29035_INTERRUPT_MODE
 
         /* Writing interrupt low threshold as 0xCCC (5% of max range) */
-        if(i2c_smbus_write_byte_data(client, ISL29035_LT_LBYTE,
+        if(isl_core_write(isl_data.regmap, ISL29035_LT_LBYTE,
                                     ISL29035_LT_LBYTE_DEF) < 0)
                 return -EINVAL;
 
-        if(i2c_smbus_write_byte_data(client, ISL29035_LT_HBYTE,
+        if(isl_core_write(isl_data.regmap, ISL29035_LT_HBYTE,
                                     ISL29035_LT_HBYTE_DEF) < 0)
                 return -EINVAL;
 
         /* Writing interrupt high threshold as 0xCCCC (80% of max range)  */
-        if(i2c_smbus_write_byte_data(client, ISL29035_HT_LBYTE,
+        if(isl_core_write(isl_data.regmap, ISL29035_HT_LBYTE,
                                     ISL29035_HT_LBYTE_DEF) < 0)
                 return -EINVAL;
 
-        if(i2c_smbus_write_byte_data(client, ISL29035_HT_HBYTE,
+        if(isl_core_write(isl_data.regmap, ISL29035_HT_HBYTE,
                                     ISL29035_HT_HBYTE_DEF) < 0)
                 return -EINVAL;
 
@@ -1220,7 +1251,7 @@ static int32_t initialize_isl29035(struct i2c_client *client)
         isl_data.last_als_ht = 0xCC;
 
 #endif
-        if(i2c_smbus_read_byte_data(client, ISL29035_CMD_REG_1) < 0)
+        if(isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1) < 0)
                 return -EINVAL;
         return 0;
 }
@@ -1229,8 +1260,8 @@ static int32_t initialize_isl29035(struct i2c_client *client)
 /*
  * @fn          isl_gpio_config
  *
- * @brief       This function is for enable the irq pin nunber and initialize the 
- * 		kernel work queue
+ * @brief       This function is for enable the irq pin nunber and register
+ * 		the threaded irq handler
  *
  * @return      Returns 0 on success otherwise returns an error (-1)
  *
@@ -1255,12 +1286,12 @@ static int isl_gpio_config(struct isl29035_platform_data *pdata)
 /*        if(irq_set_irq_type(isl_data.irq_num, IRQ_TYPE_EDGE_FALLING) < 0)
                 return gpio_err;
 */
-        /* Initialize the work queue */
-        INIT_WORK(&isl_data.work,isl29035_irq_thread);
-
-        /* Register irq handler for sensor */
-        if(request_irq(isl_data.irq_num, isl_sensor_irq_handler,
-                        IRQF_TRIGGER_FALLING , "isl29035", NULL) < 0){ 
+        /* Register irq handlers for sensor, the bottom half is an irq
+           thread rather than work on the shared system workqueue */
+        if(request_threaded_irq(isl_data.irq_num, isl_sensor_irq_handler,
+                        isl29035_irq_thread,
+                        IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "isl29035",
+                        NULL) < 0){ 
                 pr_err( "%s: Failed to register irq %d\n",
                                  __func__, isl_data.irq_num);
                 goto gpio_err;
@@ -1294,7 +1325,11 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
         if(pdata == NULL)
                 return -ENOMEM;
 
-	dev_id = i2c_smbus_read_byte_data( client, ISL29035_DEV_ID_REG );
+        isl_data.regmap = isl_core_init(client, &isl29035_core_desc);
+        if(IS_ERR(isl_data.regmap))
+                return PTR_ERR(isl_data.regmap);
+
+	dev_id = isl_core_read(isl_data.regmap, ISL29035_DEV_ID_REG );
 	if((dev_id & ISL29035_DEV_ID_MASK) != ISL29035_DEVICE_ID){
 		pr_err("%s: Failed to recognize the device\n", __func__);
 		return -1;
@@ -1324,7 +1359,7 @@ static int __devinit isl_sensor_probe(struct i2c_client *client,
         mutex_init(&isl_data.isl_mutex);
 
         /* Clear any previous interrupt */
-//        i2c_smbus_read_byte_data(client, ISL29035_CMD_REG_1);
+//        isl_core_read(isl_data.regmap, ISL29035_CMD_REG_1);
 
         return 0;
 }
@@ -30,6 +30,7 @@
 #include <linux/hrtimer.h>
 #include <linux/input.h>
 #include <linux/input/isl29037.h>
+#include <linux/input/isl_core.h>
 #include <linux/slab.h>
 #include <linux/sysfs.h>
 #include <linux/delay.h>
@@ -44,6 +45,7 @@
  *		  	  in the driver probe
  *  @ prox_poll_delay 	- Timer interval of high resolution timer 
  *  @ client		- Reference to I2C slave (sensor device)  
+ *  @ regmap		- Cached register map of the sensor, see isl_core
  *  @ isl29037_kobj 	- Kernel object used as parent node for sysfs entry
  *  @ mutex		- Provides mutex based synchronization for userspace
  *			  access to driver sysfs files
@@ -60,6 +62,7 @@ struct isl29037_drv_data {
 	struct hrtimer *timer;
 	ktime_t prox_poll_delay;
 	struct i2c_client *client;
+	struct regmap *regmap;
 	struct kobject *isl29037_kobj;
 	struct mutex mutex;
 	struct work_struct work;
@@ -175,13 +178,26 @@ static struct i2c_device_id isl_device_ids[] = {
 
 MODULE_DEVICE_TABLE(i2c, isl_device_ids);
 
+/* interrupt flags, conversion data and the soft reset register */
+static const struct regmap_range isl29037_volatile_ranges[] = {
+	ISL_CORE_RANGE(INT_CONFIG_REG, INT_CONFIG_REG),
+	ISL_CORE_RANGE(PROX_DATA_REG, CONFIG3_REG),
+};
+
+static const struct isl_core_desc isl29037_core_desc = {
+	.name			= "isl29037",
+	.max_register		= CONFIG3_REG,
+	.volatile_ranges	= isl29037_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29037_volatile_ranges),
+};
+
 struct isl29037_drv_data drv_data;
 struct isl29037_sm rt;
 
 
 /** @function: isl_read_field
  *  @desc    : read function for reading a particular bit field in a particular register
- *   	       from isl29037 sensor registers over I2C interface
+ *   	       from isl29037 sensor registers through the cached register map
  *  @args    
  *  reg	     : register to read from (0x00h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to read from
@@ -195,29 +211,19 @@ struct isl29037_sm rt;
  */
 static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *val)
 {
-	unsigned char byte;
-	unsigned char i;
-
-	byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-	if(mask == ISL_FULL_MASK) {
-		*val = byte;
-	} else {
-		byte &= mask;
+	int ret;
 
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;	
+	ret = isl_core_read_field(drv_data.regmap, reg, mask);
+	if(ret < 0) return -1;
 
-		if( i > 7 ) return -1;
-
-		*val = (byte >> i);
-	}
+	*val = ret;
 	return 0;
 }
 
 
 /** @function: isl_write_field
  *  @desc    : write function for writing a particular bit field in a particular register
- *   	       to isl29037 sensor registers over I2C interface
+ *   	       to isl29037 sensor registers through the cached register map
  *  @args    
  *  reg	     : register to write to (0x00h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to write to
@@ -231,56 +237,15 @@ static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *
  */
 static int isl_write_field(unsigned char reg, unsigned char mask, unsigned char val)
 {
-	unsigned char byte;
-	unsigned char i = 0;
-
-	if(mask == ISL_FULL_MASK) {
-		i2c_smbus_write_byte_data(drv_data.client, reg, val);
-	} else {
-		byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-		byte &= (~mask);
-
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;	
-
-		if(i > 7) return -1;
-
-		byte |= (val << i);
-		i2c_smbus_write_byte_data(drv_data.client, reg, byte);
-	}
+	if(isl_core_write_field(drv_data.regmap, reg, mask, val) < 0)
+		return -1;
 	return 0;
 }
 
 
-/** @function: isl_read_field16
- *  @desc    : read function for reading the 16bit field from the registers
- *   	       to isl29037 sensor registers over I2C interface
- *  @args    
- *  reg	     : register to read from (0x00h to 0x0Fh)
- *  val	     : value to be read from the register bits
- *
- *  @return  : 0 on success, -1 on failure
- *
- */
-static void isl_read_field16(unsigned char reg, unsigned int *val)
-{
-	unsigned char low=0,high=0;
-	isl_read_field(reg, 0xFF, &high);
-	isl_read_field(reg+1, 0xFF, &low);
-	if(reg == 0x08 || reg == 0x0B){
-		*val = ((high & 0x0F) << 8) | low;
-	}
-	else
-	{
-		*val = (low << 8 ) | (high & 0xF0);
-		*val = *val >> 4;
-	}
-}
-
-
 /** @function: isl_write_field16
  *  @desc    : write function for writing the 16bit field from the registers
- *   	       to isl29037 sensor registers over I2C interface
+ *   	       to isl29037 sensor registers through the cached register map
  *  @args    
  *  reg	     : register to write to (0x00h to 0x0Fh)
  *  val	     : value to be write to the register bits
@@ -685,9 +650,15 @@ void report_prox_count(int prox_count)
 
 static void sensor_thread(struct work_struct *work)
 {
+	unsigned char dat[PROX_AMBIR_REG - PROX_DATA_REG + 1];
 	unsigned char wash, prox;
-		isl_read_field(PROX_AMBIR_REG, PROX_AMBIR_MASK, &wash);
-		isl_read_field(PROX_DATA_REG, ISL_FULL_MASK, &prox);
+
+		/* prox, als and ambir of one conversion in a single burst */
+		if(isl_core_read_block(drv_data.regmap, PROX_DATA_REG, dat, sizeof(dat)) < 0)
+			return;
+		wash = (dat[PROX_AMBIR_REG - PROX_DATA_REG] & PROX_AMBIR_MASK) >>
+				__ffs(PROX_AMBIR_MASK);
+		prox = dat[0];
 
 		if(wash < rt.wash) {
 		rt.obj_pos = 1;			//1:near
@@ -701,8 +672,9 @@ static void sensor_thread(struct work_struct *work)
 		}
 
 	/* Report prox count to Userspace */
-	isl_read_field16(PROX_DATA_HB,&rt.report_als);
-	isl_read_field(PROX_DATA_REG,ISL_FULL_MASK,&rt.report_prox);
+	rt.report_als = ((dat[PROX_DATA_HB - PROX_DATA_REG] & 0x0F) << 8) |
+			dat[PROX_DATA_LB - PROX_DATA_REG];
+	rt.report_prox = prox;
 	report_prox_count(rt.report_prox);
 	report_als_count(rt.report_als);
 }
@@ -851,6 +823,7 @@ static int isl29037_initialize(void)
 {
 	/* Reset the sensor device */
         isl_write_field(CONFIG3_REG, ISL_FULL_MASK, 0x38);
+	isl_core_reload(drv_data.regmap, &isl29037_core_desc);
 
 	/* Reset the config2 register */
         isl_write_field(CONFIG2_REG, ISL_FULL_MASK, 0x00);
@@ -893,6 +866,10 @@ static int isl29037_probe(struct i2c_client *client, const struct i2c_device_id
 
 	drv_data.client = client;
 
+	drv_data.regmap = isl_core_init(client, &isl29037_core_desc);
+	if(IS_ERR(drv_data.regmap))
+		return PTR_ERR(drv_data.regmap);
+
 	/* Verify device id - Device ID Reg 00h */		
 	if(isl_read_field(DEVICE_ID_REG, 0xF0, &val))
 		goto end;
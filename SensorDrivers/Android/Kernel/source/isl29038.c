@@ -31,6 +31,7 @@
 #include <linux/mutex.h>
 #include <linux/device.h>
 #include <linux/isl29038.h>
+#include <linux/input/isl_core.h>
 #include <linux/slab.h>
 #include <linux/gpio.h>
 #include <linux/interrupt.h>
@@ -46,12 +47,13 @@
 /* private members of this sensor*/
 static struct isl29038_data {
 	struct 	mutex lock;
-	struct 	work_struct work;
 	struct 	kset *isl_kset;
 	struct 	kobject *isl_kobj;
 	struct 	i2c_client *isl_client;
+	struct	regmap *regmap;		/* cached registers, see isl_core */
 #ifdef ISL29038_INTERRUPT_MODE
 	uint32_t irq_num;
+	struct	isl_core_latency latency;
 #endif
 	uint16_t als_mode;
 	uint16_t prox_mode;
@@ -65,6 +67,19 @@ static struct i2c_device_id isl_device_id[] = {
 
 MODULE_DEVICE_TABLE(i2c, isl_device_id);
 
+/* interrupt and brown-out flags, conversion data and the reset register */
+static const struct regmap_range isl29038_volatile_ranges[] = {
+	ISL_CORE_RANGE(CONFIG_REG_3, CONFIG_REG_3),
+	ISL_CORE_RANGE(ISL_PROX_DATA_REG, CONFIG_REG_4),
+};
+
+static const struct isl_core_desc isl29038_core_desc = {
+	.name			= ISL29038_NAME,
+	.max_register		= CONFIG_REG_4,
+	.volatile_ranges	= isl29038_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29038_volatile_ranges),
+};
+
 /*
  * @fn          isl29038_i2c_read_word16
  *
@@ -76,19 +91,15 @@ MODULE_DEVICE_TABLE(i2c, isl_device_id);
  */
 
 
-static int32_t isl29038_i2c_read_word16(struct i2c_client *client,
-                                 unsigned char reg_addr, uint16_t *buf)
+static int32_t isl29038_i2c_read_word16(unsigned char reg_addr, uint16_t *buf)
 {
-        int16_t reg_h;
-        int16_t reg_l;
+        u8 dat[2];
 
-        reg_l = i2c_smbus_read_byte_data(client, reg_addr);
-        if (reg_l < 0)
-                return -1;
-        reg_h = i2c_smbus_read_byte_data(client, reg_addr - 1);
-        if (reg_h < 0)
+        /* MSB sits below LSB, fetch both in one transfer */
+        if (isl_core_read_block(pri_data.regmap, reg_addr - 1, dat,
+                                sizeof(dat)) < 0)
                 return -1;
-        *buf = (reg_h << 8) | reg_l;
+        *buf = (dat[0] << 8) | dat[1];
         return 0;
 }
 
@@ -109,7 +120,7 @@ static ssize_t show_prox_mode(struct kobject *kobj,
 	uint16_t reg;
 
 	mutex_lock(&pri_data.lock);	
-	reg = i2c_smbus_read_byte_data(pri_data.isl_client,CONFIG_REG_0);	
+	reg = isl_core_read(pri_data.regmap, CONFIG_REG_0);	
 	if(reg < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -148,13 +159,13 @@ static ssize_t store_prox_mode(struct kobject *kobj,
 		__dbg_invl_err("%s",__func__);		
 		goto err_out;
 	}
-	reg = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+	reg = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 	if(reg < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
 	}
 	reg = (reg & W_PROX_MODE_MASK) | mod;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_0 ,reg) < 0){
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_0 ,reg) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}			
@@ -185,7 +196,7 @@ static ssize_t show_prox_persist(struct kobject *kobj,
 	int16_t p_perst;
 
 	mutex_lock(&pri_data.lock);
-	p_perst = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+	p_perst = isl_core_read(pri_data.regmap, CONFIG_REG_3);
 	if(p_perst < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -234,14 +245,14 @@ static ssize_t store_prox_persist(struct kobject *kobj,
 		return -1;
 	}
 	
-	reg = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+	reg = isl_core_read(pri_data.regmap, CONFIG_REG_3);
 	if(reg < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
 	}
 	p_perst = (reg & W_PROX_PERSIST_MASK) | p_perst;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_3, p_perst) < 0){
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_3, p_perst) < 0){
 		__dbg_write_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
@@ -267,7 +278,7 @@ static ssize_t show_prox_lt(struct kobject *kobj,
 	int16_t p_lt;	
 
 	mutex_lock(&pri_data.lock);
-	p_lt = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_PROX_INT_TL);
+	p_lt = isl_core_read(pri_data.regmap, ISL_PROX_INT_TL);
 	if(p_lt < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -300,7 +311,7 @@ static ssize_t store_prox_lt(struct kobject *kobj,
 		__dbg_invl_err("%s",__func__);		
 		return -1;
 	}
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_PROX_INT_TL, p_lt) < 0){
+	if(isl_core_write(pri_data.regmap, ISL_PROX_INT_TL, p_lt) < 0){
 		__dbg_write_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
@@ -327,7 +338,7 @@ static ssize_t show_prox_ht(struct kobject *kobj,
 	int16_t p_ht;	
 
 	mutex_lock(&pri_data.lock);
-	p_ht = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_PROX_INT_TH);
+	p_ht = isl_core_read(pri_data.regmap, ISL_PROX_INT_TH);
 	if(p_ht < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -361,7 +372,7 @@ static ssize_t store_prox_ht(struct kobject *kobj,
 		__dbg_invl_err("%s",__func__);		
 		return -1;
 	}
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_PROX_INT_TH, p_ht) < 0){
+	if(isl_core_write(pri_data.regmap, ISL_PROX_INT_TH, p_ht) < 0){
 		__dbg_write_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
@@ -388,7 +399,7 @@ static ssize_t show_prx_ambir_stat(struct kobject *kobj,
 {
 	int16_t prx_st;
 	mutex_lock(&pri_data.lock);	
-	prx_st = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_PROX_AMBIR_REG);
+	prx_st = isl_core_read(pri_data.regmap, ISL_PROX_AMBIR_REG);
 	if(prx_st < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -420,7 +431,7 @@ static ssize_t show_p_sleep_uS(struct kobject *kobj,
 	int16_t sleep_t;
 
 	mutex_lock(&pri_data.lock);
-	sleep_t = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+	sleep_t = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 	if(sleep_t < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -482,13 +493,13 @@ static ssize_t store_p_sleep_uS(struct kobject *kobj,
 		default   	:__dbg_invl_err("%s", __func__);goto err_out;
 	}
 
-	ret = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+	ret = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 	if(ret < 0){
 		__dbg_read_err("%s",__func__);	
 		goto err_out;
 	}
 	reg = (ret & W_PROX_SLP_MASK) | reg;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_0, reg) < 0){
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_0, reg) < 0){
 		__dbg_write_err("%s",__func__);	
 		goto err_out;
 	}
@@ -516,7 +527,7 @@ static ssize_t show_ir_curr_uA(struct kobject *kobj,
 {
 	int16_t ir_cur;
 	mutex_lock(&pri_data.lock);
-	ir_cur = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+	ir_cur = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 	if(ir_cur < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -569,13 +580,13 @@ static ssize_t store_ir_curr_uA(struct kobject *kobj,
 			    __dbg_invl_err("%s",__func__);		
 			    goto err_out; 
 	}
-	ret = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+	ret = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
 	}
 	reg = (ret & W_IR_LED_CURR_MASK) | reg;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_0, reg) < 0){
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_0, reg) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}	
@@ -605,7 +616,7 @@ static ssize_t show_intr_algorithm(struct kobject *kobj,
 	int16_t intr_alg;	
 	mutex_lock(&pri_data.lock);
 
-	intr_alg = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);	
+	intr_alg = isl_core_read(pri_data.regmap, REG_CONFIG_1);	
 	if(intr_alg < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -648,13 +659,13 @@ static ssize_t store_intr_algorithm(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
 		goto err_out;
 	}
-	ret = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);
+	ret = isl_core_read(pri_data.regmap, REG_CONFIG_1);
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
 	}
 	intr_alg = (ret & W_INTR_ALGO_MASK) | intr_alg;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1, intr_alg) < 0){
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_1, intr_alg) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}
@@ -683,7 +694,7 @@ static ssize_t show_prox_data(struct kobject *kobj,
 	int16_t p_data;
 
 	mutex_lock(&pri_data.lock);
-	p_data = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_PROX_DATA_REG);
+	p_data = isl_core_read(pri_data.regmap, ISL_PROX_DATA_REG);
 	if(p_data < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -710,7 +721,7 @@ static ssize_t show_als_mode(struct kobject *kobj,
 {
 	int16_t mode;
 	mutex_lock(&pri_data.lock);	
-	mode = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);
+	mode = isl_core_read(pri_data.regmap, REG_CONFIG_1);
 	if(mode < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -750,13 +761,13 @@ static ssize_t store_als_mode(struct kobject *kobj,
 		__dbg_invl_err("%s",__func__);
 		goto in_err;
 	}
-	mode = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);
+	mode = isl_core_read(pri_data.regmap, REG_CONFIG_1);
 	if(mode < 0){
 		__dbg_read_err("%s", __func__);
 		goto in_err;
 	}
 	mode = (mode & W_ALS_MODE_MASK) | reg;
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1, mode) < 0){
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_1, mode) < 0){
 		__dbg_write_err("%s", __func__);
 		goto in_err;
 	}
@@ -785,7 +796,7 @@ static ssize_t show_als_range(struct kobject *kobj,
 {
 	uint16_t range;
 	mutex_lock(&pri_data.lock);
-	range = i2c_smbus_read_byte_data(pri_data.isl_client,REG_CONFIG_1);
+	range = isl_core_read(pri_data.regmap, REG_CONFIG_1);
 	if(range < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
@@ -840,13 +851,13 @@ static ssize_t store_als_range(struct kobject *kobj,
 		default :__dbg_invl_err("%s",__func__);
 			 goto err_out;break;
 	}		
-	ret = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);		
+	ret = isl_core_read(pri_data.regmap, REG_CONFIG_1);		
 	if(ret < 0){
 		__dbg_read_err("%s", __func__);
 		goto err_out;
 	}
 	reg = (ret & R_ALS_RANGE_MASK) | reg ;	
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1, reg) < 0){
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_1, reg) < 0){
 		__dbg_write_err("%s", __func__);
 		goto err_out;
 	}
@@ -875,8 +886,7 @@ static ssize_t show_als_data(struct kobject *kobj,
 	
 	mdelay(20);
 	mutex_lock(&pri_data.lock);
-	if(isl29038_i2c_read_word16(pri_data.isl_client, 
-				ISL_ALS_DATA_LBYTE, &reg) < 0){
+	if(isl29038_i2c_read_word16(ISL_ALS_DATA_LBYTE, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
@@ -903,7 +913,7 @@ static ssize_t show_alsir_compensation(struct kobject *kobj,
 	uint16_t alsir_comp;
 
 	mutex_lock(&pri_data.lock);
-	alsir_comp = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_2);		
+	alsir_comp = isl_core_read(pri_data.regmap, REG_CONFIG_2);		
 	if(alsir_comp < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&pri_data.lock);
@@ -939,7 +949,7 @@ static ssize_t store_alsir_compensation(struct kobject *kobj,
 		__dbg_invl_err("%s", __func__);
                 goto err_out;
         }
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_2,
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_2,
 					 alsir_comp) < 0){
 		__dbg_write_err("%s", __func__);
                 goto err_out;
@@ -971,14 +981,14 @@ static ssize_t show_als_low_thres(struct kobject *kobj,
 
         mutex_lock(&pri_data.lock);
 	/* Read the LSB of Low threshold */
-	reg_l = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_ALS_INT_TL0);
+	reg_l = isl_core_read(pri_data.regmap, ISL_ALS_INT_TL0);
 	if( reg_l < 0){
                 __dbg_read_err("%s", __func__);
                goto err_out; 
         }
 	reg_l &= ISL_LT_MASK; 		/* Mask the lower nibble */
 	/* Read the MSB of Low threshold */
-	reg_h = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_ALS_INT_TL1);
+	reg_h = isl_core_read(pri_data.regmap, ISL_ALS_INT_TL1);
         if( reg_l < 0){
                 __dbg_read_err("%s", __func__);
                goto err_out; 
@@ -1018,7 +1028,7 @@ static ssize_t store_als_low_thres(struct kobject *kobj,
                 __dbg_invl_err("%s", __func__);
                 goto err_out;
         }
-        ret = i2c_smbus_read_byte_data(pri_data.isl_client,ISL_ALS_INT_TL0);
+        ret = isl_core_read(pri_data.regmap, ISL_ALS_INT_TL0);
         if(ret < 0){
                 __dbg_read_err("%s", __func__);
                 goto err_out;
@@ -1030,12 +1040,12 @@ static ssize_t store_als_low_thres(struct kobject *kobj,
         reg_l = (ret & 0x0f) | reg_l;
 
         /* Write Low byte threshold at 0x08h */
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_ALS_INT_TL0, reg_l) < 0){
+        if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TL0, reg_l) < 0){
                 __dbg_write_err("%s", __func__);
                 goto err_out;
         }
         /* Write high byte threshold at 0x09h retaining upper nibble */
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_ALS_INT_TL1, reg_h) < 0){
+        if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TL1, reg_h) < 0){
                 __dbg_write_err("%s", __func__);
                 goto err_out;
         }
@@ -1066,12 +1076,12 @@ static ssize_t show_als_high_thres(struct kobject *kobj,
         uint16_t reg_h;
 
         mutex_lock(&pri_data.lock);
-        reg_l = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_ALS_INT_TH0);
+        reg_l = isl_core_read(pri_data.regmap, ISL_ALS_INT_TH0);
         if (reg_l < 0){
                 __dbg_read_err("%s", __func__);
                goto err;
         }
-        reg_h = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_ALS_INT_TH1);
+        reg_h = isl_core_read(pri_data.regmap, ISL_ALS_INT_TH1);
         if (reg_l < 0){
                 __dbg_read_err("%s", __func__);
                goto err;
@@ -1113,7 +1123,7 @@ static ssize_t store_als_high_thres(struct kobject *kobj,
                 __dbg_invl_err("%s", __func__);
                 goto err_out;
         }
-        ret = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_ALS_INT_TH1);
+        ret = isl_core_read(pri_data.regmap, ISL_ALS_INT_TH1);
         if(ret < 0){
                 __dbg_read_err("%s", __func__);
                 goto err_out;
@@ -1124,12 +1134,12 @@ static ssize_t store_als_high_thres(struct kobject *kobj,
         reg_h = (ret & 0xf0) | reg_h;
 
         /* Write Low byte threshold at 0x09h */
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_ALS_INT_TH0, reg_l) < 0){
+        if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TH0, reg_l) < 0){
                 __dbg_read_err("%s", __func__);
                 goto err_out;
         }
         /* Write high byte threshold at 0x08h retaining upper nibble */
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, ISL_ALS_INT_TH1, reg_h) < 0){
+        if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TH1, reg_h) < 0){
                 __dbg_write_err("%s", __func__);
                 goto err_out;
         }
@@ -1158,7 +1168,7 @@ static ssize_t show_als_persist(struct kobject *kobj,
        int16_t a_perst;
 
         mutex_lock(&pri_data.lock);
-        a_perst = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+        a_perst = isl_core_read(pri_data.regmap, CONFIG_REG_3);
         if (a_perst < 0){
                 __dbg_read_err("%s", __func__);
                 mutex_unlock(&pri_data.lock);
@@ -1209,14 +1219,14 @@ static ssize_t store_als_persist(struct kobject *kobj,
 		goto err_out;
         }
 
-        reg = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+        reg = isl_core_read(pri_data.regmap, CONFIG_REG_3);
         if(reg < 0){
                 __dbg_read_err("%s", __func__);
 		goto err_out;
         }
         a_perst = (reg & W_ALS_PERST_MASK) | a_perst;
 
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_3, a_perst) < 0){
+        if(isl_core_write(pri_data.regmap, CONFIG_REG_3, a_perst) < 0){
                 __dbg_write_err("%s", __func__);
 		goto err_out;
         }
@@ -1246,7 +1256,7 @@ static ssize_t show_prox_offset_comp(struct kobject *kobj,
 	uint16_t prx_comp;
 	
         mutex_lock(&pri_data.lock);
-        prx_comp = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);
+        prx_comp = isl_core_read(pri_data.regmap, REG_CONFIG_1);
         if(prx_comp < 0){
                 __dbg_read_err("%s",__func__);
                 mutex_unlock(&pri_data.lock);
@@ -1281,7 +1291,7 @@ static ssize_t store_prox_offset_comp(struct kobject *kobj,
                 goto err_out;
         }
 	 
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1,
+        if(isl_core_write(pri_data.regmap, REG_CONFIG_1,
                                          (prox_comp & W_PROX_OFFST_COMP_MASK)) < 0){
                 __dbg_read_err("%s",__func__);
 		goto err_out;
@@ -1311,7 +1321,7 @@ static ssize_t show_dev_status(struct kobject *kobj,
 	uint16_t ret;
 
         mutex_lock(&pri_data.lock);
-        ret = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+        ret = isl_core_read(pri_data.regmap, CONFIG_REG_3);
         if(ret < 0){
                 __dbg_read_err("%s",__func__);
                 mutex_unlock(&pri_data.lock);
@@ -1349,11 +1359,12 @@ static ssize_t store_reset(struct kobject *kobj,
                 __dbg_invl_err("%s:<valid:38>", __func__);
                 goto err_out;
         }
-	if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_4, ISL_SOFT_RESET) < 0){
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_4, ISL_SOFT_RESET) < 0){
 		__dbg_write_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
 		return -1;
 	}
+	isl_core_reload(pri_data.regmap, &isl29038_core_desc);
 	mutex_unlock(&pri_data.lock);
 	return strlen(buf);
 err_out:
@@ -1378,7 +1389,7 @@ static ssize_t show_prox_ambir_data(struct kobject *kobj,
 {
 	uint16_t val;
 	mutex_lock(&pri_data.lock);
-	val = i2c_smbus_read_byte_data(pri_data.isl_client, ISL_PROX_AMBIR_REG);
+	val = isl_core_read(pri_data.regmap, ISL_PROX_AMBIR_REG);
 	if(val < 0){
 		__dbg_read_err("%s", __func__);
 		mutex_unlock(&pri_data.lock);
@@ -1389,6 +1400,43 @@ static ssize_t show_prox_ambir_data(struct kobject *kobj,
 
 }
 
+#ifdef ISL29038_INTERRUPT_MODE
+/*
+ * @fn          show_irq_latency
+ *
+ * @brief       This function shows the interrupt to report latency as
+ *              "last max average count", the times in microseconds
+ *
+ * @return      Returns data buffer length
+ *
+ */
+
+static ssize_t show_irq_latency(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return isl_core_latency_show(&pri_data.latency, buf);
+}
+
+/*
+ * @fn          store_irq_latency
+ *
+ * @brief       This function restarts the latency measurement on any
+ *              write
+ *
+ * @return      Returns length of data buffer
+ *
+ */
+
+static ssize_t store_irq_latency(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	disable_irq(pri_data.irq_num);
+	isl_core_latency_reset(&pri_data.latency);
+	enable_irq(pri_data.irq_num);
+	return count;
+}
+#endif
+
 /* Proximity attributes */
 static struct kobj_attribute prox_mode_attribute =
 __ATTR(prox_mode, ISL29038_SYSFS_PERM, show_prox_mode, store_prox_mode);
@@ -1458,6 +1506,9 @@ __ATTR(als_high_thres,ISL29038_SYSFS_PERM, show_als_high_thres,
 static struct kobj_attribute als_persist_attribute = 
 __ATTR(als_persist, ISL29038_SYSFS_PERM, show_als_persist,
 					store_als_persist);	
+static struct kobj_attribute irq_latency_attribute = 
+__ATTR(irq_latency, ISL29038_SYSFS_PERM, show_irq_latency,
+					store_irq_latency);
 #endif
 
 static struct attribute *isl29038_attrs[] = {
@@ -1485,6 +1536,7 @@ static struct attribute *isl29038_attrs[] = {
 	&als_persist_attribute.attr,
 	&als_low_thres_attribute.attr,
 	&als_high_thres_attribute.attr,
+	&irq_latency_attribute.attr,
 #endif
 	&dev_status_attribute.attr, 		/* Brown out or normal operation */
 	&reset_attribute.attr,
@@ -1502,47 +1554,46 @@ static struct attribute_group isl29038_attr_grp = {
 /*
  * @fn          isl29038_irq_thread
  *
- * @brief       This work thread is scheduled by sensor interrupt handler
- *              to clear the interrupt flags of sensor
+ * @brief       This threaded handler runs at real-time priority after
+ *              the sensor interrupt to clear the interrupt flags of sensor
  *
- * @return      void
+ * @return      IRQ_HANDLED
  */
 
-static void isl29038_irq_thread(struct work_struct *work)
+static irqreturn_t isl29038_irq_thread(int irq, void *dev_id)
 {
 	short int ret;
 
-        ret = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_3);
+        ret = isl_core_read(pri_data.regmap, CONFIG_REG_3);
         if(ret < 0){
                 __dbg_read_err("%s", __func__);
                 goto err;
         }
-        if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_3,
+        if(isl_core_write(pri_data.regmap, CONFIG_REG_3,
                                 		(ret & 0x67)) < 0){
                 __dbg_write_err("%s", __func__);
                 goto err;
         }
 err:
-        enable_irq(pri_data.irq_num);
+        isl_core_latency_done(&pri_data.latency);
+        return IRQ_HANDLED;
 }
 
 /*
  * @fn          isl29038_irq_handler
  *
- * @brief       This function is the interrupt handler for sensor.
- *              It schedules an interrupt thread and returns (free)
- *              interrupt.
+ * @brief       This function is the hard interrupt handler for sensor.
+ *              It stamps the interrupt and wakes the threaded handler;
+ *              the line stays masked until that returns (IRQF_ONESHOT).
  *
- * @return      IRQ_HANDLED
+ * @return      IRQ_WAKE_THREAD
  *
  */
 
 static irqreturn_t isl29038_irq_handler(int irq, void *dev_id)
 {
-	disable_irq_nosync(pri_data.irq_num);
-        schedule_work(&pri_data.work);
-        return IRQ_HANDLED;
-
+	isl_core_irq_stamp(&pri_data.latency);
+        return IRQ_WAKE_THREAD;
 }
 #endif
 
@@ -1560,26 +1611,26 @@ static irqreturn_t isl29038_irq_handler(int irq, void *dev_id)
 static int isl29038_init_default(struct i2c_client *client)
 {
 	/* Brown-Out clear  */
-	if(i2c_smbus_write_byte_data(client, CONFIG_REG_3, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_3, 0x00) < 0)
 		return -EINVAL;
 
-	if(i2c_smbus_write_byte_data(client, CONFIG_REG_0, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_0, 0x00) < 0)
 		return -EINVAL;
-	if(i2c_smbus_write_byte_data(client, REG_CONFIG_1, 0x07) < 0)
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_1, 0x07) < 0)
 		return -EINVAL;
-	if(i2c_smbus_write_byte_data(client, REG_CONFIG_2, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, REG_CONFIG_2, 0x00) < 0)
 		return -EINVAL;
 #ifdef ISL29038_INTERRUPT_MODE
-	if(i2c_smbus_write_byte_data(client, ISL_ALS_INT_TL0, 0x00) < 0)	
+	if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TL0, 0x00) < 0)	
 		return -EINVAL;
-	if(i2c_smbus_write_byte_data(client, ISL_ALS_INT_TL1, 0x0C) < 0)	
+	if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TL1, 0x0C) < 0)	
 		return -EINVAL;
-	if(i2c_smbus_write_byte_data(client, ISL_ALS_INT_TH0, 0xCC) < 0)	
+	if(isl_core_write(pri_data.regmap, ISL_ALS_INT_TH0, 0xCC) < 0)	
 		return -EINVAL;
 #endif
-	if(i2c_smbus_write_byte_data(client, CONFIG_REG_4, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_4, 0x00) < 0)
 		return -EINVAL;
-	if(i2c_smbus_write_byte_data(client, CONFIG_REG_3, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_3, 0x00) < 0)
 		return -EINVAL;
 			
 	return 0;	
@@ -1610,7 +1661,11 @@ static int __devinit isl29038_probe(struct i2c_client *client,
 		return -1;
 	} 	
 	
-	dev_id = i2c_smbus_read_byte_data(client , DEVICE_ID_REG);
+	pri_data.regmap = isl_core_init(client, &isl29038_core_desc);
+	if(IS_ERR(pri_data.regmap))
+		return PTR_ERR(pri_data.regmap);
+
+	dev_id = isl_core_read(pri_data.regmap, DEVICE_ID_REG);
 	if((dev_id & ISL29038_ID_MASK) != ISL29038_ID){
 		pr_err("%s :%s :Invalid device id for ISL29038 sensor\n",
 				ISL29038_NAME, __func__);
@@ -1649,12 +1704,11 @@ static int __devinit isl29038_probe(struct i2c_client *client,
 		goto gpio_err;
 	} 
 	
-	/* Initialize the work queue */
-	INIT_WORK(&pri_data.work, isl29038_irq_thread);
-	
-	/* Request irq num*/
-	if(request_irq(pri_data.irq_num, isl29038_irq_handler, 
-				IRQF_TRIGGER_FALLING, "isl29038", NULL) < 0){
+	/* Request irq num, the flags are cleared in the irq thread */
+	if(request_threaded_irq(pri_data.irq_num, isl29038_irq_handler,
+				isl29038_irq_thread,
+				IRQF_TRIGGER_FALLING | IRQF_ONESHOT,
+				"isl29038", NULL) < 0){
 		pr_err("%s :failed to request irq handler\n", __func__);
 		goto gpio_err;
 	}	
@@ -1685,7 +1739,7 @@ static int __devinit isl29038_probe(struct i2c_client *client,
 	mutex_init(&pri_data.lock);
 
 	/* Clear any previous interrupt */
-	if(i2c_smbus_write_byte_data(client, CONFIG_REG_3, 0x00) < 0)
+	if(isl_core_write(pri_data.regmap, CONFIG_REG_3, 0x00) < 0)
 	return 0;
 
 #ifdef ISL29038_INTERRUPT_MODE
@@ -1731,7 +1785,7 @@ static int __devexit isl29038_remove(struct i2c_client *client)
 static int isl29038_suspend(struct i2c_client *client, pm_message_t mesg)
 {	
 	int32_t ret;
-	ret = i2c_smbus_read_byte_data(pri_data.isl_client, REG_CONFIG_1);	
+	ret = isl_core_read(pri_data.regmap, REG_CONFIG_1);	
 	if(ret < 0){
 		__dbg_read_err("%s",__func__);
 		goto err_out;
@@ -1742,14 +1796,14 @@ static int isl29038_suspend(struct i2c_client *client, pm_message_t mesg)
 		pri_data.als_mode = ret;	
 		pri_data.prox_mode = 0;
 		/* ALS disable */	
-		if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1,
+		if(isl_core_write(pri_data.regmap, REG_CONFIG_1,
 						 ret & 0xfb) < 0){
 			__dbg_write_err("%s",__func__);
 			goto err_out;
 		}	
 	}
 	else{
-		ret = i2c_smbus_read_byte_data(pri_data.isl_client, CONFIG_REG_0);
+		ret = isl_core_read(pri_data.regmap, CONFIG_REG_0);
 		if(ret < 0){
 			__dbg_read_err("%s",__func__);
 			goto err_out;
@@ -1757,7 +1811,7 @@ static int isl29038_suspend(struct i2c_client *client, pm_message_t mesg)
 		pri_data.prox_mode = ret;
 		pri_data.als_mode  = 0;
 		/* PROX disable */
-		if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_0, 
+		if(isl_core_write(pri_data.regmap, CONFIG_REG_0, 
 						ret & 0xdf) < 0){
 			__dbg_write_err("%s",__func__);
 			goto err_out;
@@ -1786,12 +1840,12 @@ err_out:
 static int isl29038_resume(struct i2c_client *client)
 {
 	if(pri_data.als_mode){	
-		if(i2c_smbus_write_byte_data(pri_data.isl_client, REG_CONFIG_1, pri_data.als_mode) < 0){
+		if(isl_core_write(pri_data.regmap, REG_CONFIG_1, pri_data.als_mode) < 0){
 			__dbg_write_err("%s",__func__);
 			goto err_out;
 		}
 	}else if(pri_data.prox_mode){
-		if(i2c_smbus_write_byte_data(pri_data.isl_client, CONFIG_REG_0, pri_data.prox_mode) < 0){
+		if(isl_core_write(pri_data.regmap, CONFIG_REG_0, pri_data.prox_mode) < 0){
 			__dbg_write_err("%s",__func__);
 			goto err_out;
 		}
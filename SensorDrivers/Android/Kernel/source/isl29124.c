@@ -13,6 +13,8 @@
 #include <linux/kernel.h>
 #include <linux/gpio.h>
 #include <linux/isl29124.h>
+#include <linux/input/isl_core.h>
+#include <linux/input/isl_iio.h>
 #include <linux/i2c.h>
 #include <linux/interrupt.h>
 #include <linux/mutex.h>
@@ -43,8 +45,22 @@ MODULE_DESCRIPTION("Driver for ISL29124 RGB light sensor");
 #define NEW_CCM 
 struct mutex rwlock_mutex;
 unsigned char irq_num;
-struct work_struct work;
+struct isl_core_latency isl29124_latency;
 struct i2c_client *isl29124_client_data;
+struct regmap *isl29124_regmap;
+struct iio_dev *isl29124_iio;
+
+/* Status flags and RGB data are updated by the part */
+static const struct regmap_range isl29124_volatile_ranges[] = {
+	ISL_CORE_RANGE(STATUS_FLAGS_REG, BLUE_DATA_LBYTE_REG + 1),
+};
+
+static const struct isl_core_desc isl29124_core_desc = {
+	.name = "isl29124",
+	.max_register = BLUE_DATA_LBYTE_REG + 1,
+	.volatile_ranges = isl29124_volatile_ranges,
+	.num_volatile_ranges = ARRAY_SIZE(isl29124_volatile_ranges),
+};
 #if SENSOR_VREG
 struct regulator *vdd;
 struct regulator *vcc_i2c;
@@ -58,6 +74,8 @@ struct regulator *vcc_i2c;
 	struct delayed_work    sensor_dwork; /* for ALS polling */
 	bool sensor_enable;
 	unsigned long POLL_DELAY= 125;
+	/* sensing range in use, 1 for 4000 lux, reported with each frame */
+	int rgb_range_hi;
 #endif
 /* Devices supported by this driver and their I2C address */
 struct i2c_device_id isl_sensor_device_table[] = {
@@ -66,8 +84,9 @@ struct i2c_device_id isl_sensor_device_table[] = {
 };
 
 #if SENSOR_COM
-       int isl29124_i2c_read_word16(struct i2c_client *client, 
-                                    unsigned char reg_addr, unsigned short *buf);
+       int isl29124_i2c_read_word16(unsigned char reg_addr, unsigned short *buf);
+       int isl29124_read_rgb(unsigned short *red, unsigned short *green,
+                             unsigned short *blue);
        int get_optical_range(int *range);
        int get_adc_resolution_bits(int *res);
 #endif 
@@ -250,21 +269,20 @@ ssize_t show_cct(struct device *dev, struct device_attribute *attr, char *buf)
 	unsigned short regr;
         unsigned short regg;
         unsigned short regb;
-        struct i2c_client *client = to_i2c_client(dev);
 
         mutex_lock(&rwlock_mutex);
-        ret = isl29124_i2c_read_word16(client, RED_DATA_LBYTE_REG, &regr);
+        ret = isl29124_i2c_read_word16(RED_DATA_LBYTE_REG, &regr);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
         }
 
-        ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &regg);
+        ret = isl29124_i2c_read_word16(GREEN_DATA_LBYTE_REG, &regg);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
         }
-        ret = isl29124_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &regb);
+        ret = isl29124_i2c_read_word16(BLUE_DATA_LBYTE_REG, &regb);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
@@ -425,30 +443,18 @@ ssize_t show_lux(struct device *dev, struct device_attribute *attr, char *buf)
         unsigned short regg;
         unsigned short regb;
   //    unsigned short regg2;
-        struct i2c_client *client = to_i2c_client(dev);
         struct isl29124_data_t *dat=dev_get_drvdata(dev);
 	
         //dat = (struct isl29124_data_t *)dev->platform_data;
 
         mutex_lock(&rwlock_mutex);
-        ret = isl29124_i2c_read_word16(client, RED_DATA_LBYTE_REG, &regr);
-        if (ret < 0) {
-                printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
-                return -1;
-        }
-
-        ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &regg);
-        if (ret < 0) {
-                printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
-                return -1;
-        }
-        ret = isl29124_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &regb);
+        ret = isl29124_read_rgb(&regr, &regg, &regb);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
         }
 /****************        
-        ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &regg2);
+        ret = isl29124_i2c_read_word16(GREEN_DATA_LBYTE_REG, &regg2);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
@@ -484,20 +490,8 @@ static ssize_t show_cct(struct device *dev,
         unsigned short regg;
         unsigned short regb;
         struct isl29124_data_t *isl29124=dev_get_drvdata(dev);
-        struct i2c_client *client = to_i2c_client(dev);
 	mutex_lock(&rwlock_mutex);
-        ret = isl29124_i2c_read_word16(client, RED_DATA_LBYTE_REG, &regr);
-        if (ret < 0) {
-                printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
-                return -1;
-        }
-
-        ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &regg);
-        if (ret < 0) {
-                printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
-                return -1;
-        }
-        ret = isl29124_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &regb);
+        ret = isl29124_read_rgb(&regr, &regg, &regb);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
                 return -1;
@@ -530,7 +524,7 @@ int set_optical_range(int *range)
 {
         int ret;
 
-        ret = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG1_REG);
+        ret = isl_core_read(isl29124_regmap, CONFIG1_REG);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to get data\n", __FUNCTION__);
                 return -1;
@@ -543,11 +537,14 @@ int set_optical_range(int *range)
         else
                 return -1;
 
-        ret = i2c_smbus_write_byte_data(isl29124_client_data, CONFIG1_REG, ret);
+        ret = isl_core_write(isl29124_regmap, CONFIG1_REG, ret);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
                 return -1;
         }
+#if SENSOR_INPUT
+        rgb_range_hi = (*range == 4000);
+#endif
 
         return 0;
 }
@@ -565,13 +562,16 @@ int get_optical_range(int *range)
 {
         int ret;
 
-        ret = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG1_REG);
+        ret = isl_core_read(isl29124_regmap, CONFIG1_REG);
         if (ret < 0) {
                 printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
                 return -1;
         }
 
         *range = (ret & (1 << RGB_DATA_SENSE_RANGE_POS))?4000:330;
+#if SENSOR_INPUT
+        rgb_range_hi = (*range == 4000);
+#endif
 
         return 0;
 
@@ -590,7 +590,7 @@ int get_adc_resolution_bits(int *res)
 {
 	int ret;
 
-	ret = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG1_REG); 
+	ret = isl_core_read(isl29124_regmap, CONFIG1_REG); 
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -614,7 +614,7 @@ int set_adc_resolution_bits(int *res)
 	int ret;
 	int reg;
 
-	reg = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG1_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -625,7 +625,7 @@ int set_adc_resolution_bits(int *res)
 	else 
 		reg &= ~(1<<ADC_RESOLUTION_BITS_POS);
 	printk("%s,reg is %x\n",__func__,reg);
-	ret = i2c_smbus_write_byte_data(isl29124_client_data, CONFIG1_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG1_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -648,7 +648,7 @@ int set_mode(int mode)
 	int ret;
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG1_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -657,7 +657,7 @@ int set_mode(int mode)
 	reg &= RGB_OP_MODE_CLEAR;
 	reg |= mode;
 
-	ret = i2c_smbus_write_byte_data(isl29124_client_data, CONFIG1_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG1_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__); 
 		return -1;
@@ -744,35 +744,16 @@ void autorange(int green)
  * @return      Returns 0 on success otherwise returns an error (-1)
  *
  */ 
-int isl29124_i2c_read_word16(struct i2c_client *client, unsigned char reg_addr, unsigned short *buf)
+int isl29124_i2c_read_word16(unsigned char reg_addr, unsigned short *buf)
 {
-	//short int reg_h;
-	//short int reg_l;
-	u8 dat[4];
 	int ret;
-	
-	ret = i2c_smbus_read_i2c_block_data(client, reg_addr, 2, dat);
-	if(ret != 2)
-	{
-		printk(KERN_ERR "%s: Failed to read block data\n", __FUNCTION__);
-		return -1;
-	}
-	*buf = ((u16)dat[1] << 8) | (u16)dat[0];
-/*
-	reg_l = i2c_smbus_read_byte_data(client, reg_addr); 
-	if (reg_l < 0) {
-		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
-		return -1;	
-	}
 
-	reg_h = i2c_smbus_read_byte_data(client, reg_addr + 1); 
-	if (reg_h < 0) {
+	ret = isl_core_read16(isl29124_regmap, reg_addr);
+	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
-		return -1;	
+		return -1;
 	}
-
-	*buf = (reg_h << 8) | reg_l;	
-*/
+	*buf = ret;
 	return 0;
 }  
 
@@ -785,32 +766,75 @@ int isl29124_i2c_read_word16(struct i2c_client *client, unsigned char reg_addr,
  * @return      Returns 0 on success otherwise returns an error (-1)
  *
  */
-int isl29124_i2c_write_word16(struct i2c_client *client, unsigned char reg_addr, unsigned short *buf)
+int isl29124_i2c_write_word16(unsigned char reg_addr, unsigned short *buf)
 {
 	int ret;
-	unsigned char reg_h;
-	unsigned char reg_l;
 
-	/* Extract LSB and MSB bytes from data */
-	reg_l = *buf & 0xFF;
-	reg_h = (*buf & 0xFF00) >> 8;
-
-	ret = i2c_smbus_write_byte_data(client, reg_addr, reg_l); 
+	ret = isl_core_write16(isl29124_regmap, reg_addr, *buf);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;	
 	}
 
-	ret = i2c_smbus_write_byte_data(client, reg_addr + 1, reg_h); 
+	return 0;
+}
+
+
+/*
+ * @fn         	isl29124_read_rgb 
+ *
+ * @brief       This function reads the green, red and blue data of one
+ *              conversion in a single 6-byte burst 
+ *
+ * @return      Returns 0 on success otherwise returns an error (-1)
+ *
+ */
+int isl29124_read_rgb(unsigned short *red, unsigned short *green, unsigned short *blue)
+{
+	u8 dat[BLUE_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG + 1];
+	int ret;
+
+	ret = isl_core_read_block(isl29124_regmap, GREEN_DATA_LBYTE_REG, dat, sizeof(dat));
 	if (ret < 0) {
-		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
-		return -1;	
+		printk(KERN_ERR "%s: Failed to read block data\n", __FUNCTION__);
+		return -1;
 	}
-
+	*green = (dat[GREEN_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) |
+			dat[0];
+	*red = (dat[RED_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) |
+			dat[RED_DATA_LBYTE_REG - GREEN_DATA_LBYTE_REG];
+	*blue = (dat[BLUE_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) |
+			dat[BLUE_DATA_LBYTE_REG - GREEN_DATA_LBYTE_REG];
 	return 0;
 }
 
 
+static int isl29124_iio_read_sample(struct i2c_client *client, u16 *vals)
+{
+	int ret;
+
+	mutex_lock(&rwlock_mutex);
+	ret = isl29124_read_rgb(&vals[0], &vals[1], &vals[2]);
+	mutex_unlock(&rwlock_mutex);
+	return ret < 0 ? -EIO : 0;
+}
+
+static const struct iio_chan_spec isl29124_iio_channels[] = {
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_RED, 0, 16),
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_GREEN, 1, 16),
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_BLUE, 2, 16),
+	IIO_CHAN_SOFT_TIMESTAMP(3),
+};
+
+static const struct isl_iio_desc isl29124_iio_desc = {
+	.name = "isl29124",
+	.channels = isl29124_iio_channels,
+	.num_channels = ARRAY_SIZE(isl29124_iio_channels),
+	.default_period_ms = 125,	/* the input poll period */
+	.read_sample = isl29124_iio_read_sample,
+};
+
+
 /*
  * @fn         	show_red 
  *
@@ -823,10 +847,9 @@ ssize_t show_red(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	int ret;
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	ret = isl29124_i2c_read_word16(client, RED_DATA_LBYTE_REG, &reg);	
+	ret = isl29124_i2c_read_word16(RED_DATA_LBYTE_REG, &reg);	
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 		return -1;
@@ -851,10 +874,9 @@ ssize_t show_green(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	int ret;
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &reg);	
+	ret = isl29124_i2c_read_word16(GREEN_DATA_LBYTE_REG, &reg);	
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 		return -1;
@@ -883,10 +905,9 @@ ssize_t show_blue(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	int ret;
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	ret = isl29124_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &reg);	
+	ret = isl29124_i2c_read_word16(BLUE_DATA_LBYTE_REG, &reg);	
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 		return -1;
@@ -905,21 +926,9 @@ ssize_t show_rgb(struct device *dev, struct device_attribute *attr, char *buf)
 	unsigned short regr;
 	unsigned short regg;
 	unsigned short regb;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	ret = isl29124_i2c_read_word16(client, RED_DATA_LBYTE_REG, &regr);	
-	if (ret < 0) {
-		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
-		return -1;
-	}
-
-	ret = isl29124_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &regg);	
-	if (ret < 0) {
-		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
-		return -1;
-	}
-	ret = isl29124_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &regb);	
+	ret = isl29124_read_rgb(&regr, &regg, &regb);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 		return -1;
@@ -940,10 +949,9 @@ ssize_t show_rgb(struct device *dev, struct device_attribute *attr, char *buf)
 static ssize_t show_mode(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1134,10 +1142,9 @@ static ssize_t store_adc_resolution_bits(struct device *dev, struct device_attri
 static ssize_t show_intr_threshold_high(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = isl29124_i2c_read_word16(client, HIGH_THRESHOLD_LBYTE_REG, &reg); 
+	reg = isl29124_i2c_read_word16(HIGH_THRESHOLD_LBYTE_REG, &reg); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
 		return -1;	
@@ -1162,7 +1169,6 @@ static ssize_t store_intr_threshold_high(struct device *dev, struct device_attri
 {
 	int ret;
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -1170,7 +1176,7 @@ static ssize_t store_intr_threshold_high(struct device *dev, struct device_attri
 		printk(KERN_ERR "%s: Invalid input value\n", __FUNCTION__);
 		return -1;
 	}
-	ret = isl29124_i2c_write_word16(client, HIGH_THRESHOLD_LBYTE_REG, &reg);
+	ret = isl29124_i2c_write_word16(HIGH_THRESHOLD_LBYTE_REG, &reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write word\n", __FUNCTION__);
 		return -1;
@@ -1192,10 +1198,9 @@ static ssize_t store_intr_threshold_high(struct device *dev, struct device_attri
 static ssize_t show_intr_threshold_low(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = isl29124_i2c_read_word16(client, LOW_THRESHOLD_LBYTE_REG, &reg); 
+	reg = isl29124_i2c_read_word16(LOW_THRESHOLD_LBYTE_REG, &reg); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);
 		return -1;	
@@ -1221,7 +1226,6 @@ static ssize_t store_intr_threshold_low(struct device *dev, struct device_attrib
 	int ret;
 	unsigned short reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -1230,7 +1234,7 @@ static ssize_t store_intr_threshold_low(struct device *dev, struct device_attrib
 		return -1;
 	}
 
-	ret = isl29124_i2c_write_word16(client, LOW_THRESHOLD_LBYTE_REG, &reg);
+	ret = isl29124_i2c_write_word16(LOW_THRESHOLD_LBYTE_REG, &reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write word\n", __FUNCTION__);
 		return -1;
@@ -1251,10 +1255,9 @@ static ssize_t show_intr_threshold_assign(struct device *dev, struct device_attr
 {
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1296,7 +1299,6 @@ static ssize_t store_intr_threshold_assign(struct device *dev, struct device_att
 	short int reg;
 	short int threshold_assign;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "none")) {
@@ -1312,7 +1314,7 @@ static ssize_t store_intr_threshold_assign(struct device *dev, struct device_att
 		return -1;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -1321,7 +1323,7 @@ static ssize_t store_intr_threshold_assign(struct device *dev, struct device_att
 	reg &= INTR_THRESHOLD_ASSIGN_CLEAR;
 	reg |= threshold_assign;	
 
-	ret = i2c_smbus_write_byte_data(client, CONFIG3_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG3_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -1345,10 +1347,9 @@ static ssize_t show_intr_persistency(struct device *dev, struct device_attribute
 	short int reg;
 	short int intr_persist;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1392,7 +1393,6 @@ static ssize_t store_intr_persistency(struct device *dev, struct device_attribut
 	short int intr_persist;
 
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	intr_persist = simple_strtoul(buf, NULL, 10);
@@ -1409,7 +1409,7 @@ static ssize_t store_intr_persistency(struct device *dev, struct device_attribut
 		return -1;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -1418,7 +1418,7 @@ static ssize_t store_intr_persistency(struct device *dev, struct device_attribut
 	reg &= INTR_PERSIST_CTRL_CLEAR;
 	reg |= intr_persist << INTR_PERSIST_CTRL_POS; 	
 
-	ret = i2c_smbus_write_byte_data(client, CONFIG3_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG3_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -1441,10 +1441,9 @@ static ssize_t show_rgb_conv_intr(struct device *dev, struct device_attribute *a
 {
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1472,7 +1471,6 @@ static ssize_t store_rgb_conv_intr(struct device *dev, struct device_attribute *
 	int ret, rgb_conv_intr;
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "enable"))
@@ -1484,7 +1482,7 @@ static ssize_t store_rgb_conv_intr(struct device *dev, struct device_attribute *
 		return -1;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -1493,7 +1491,7 @@ static ssize_t store_rgb_conv_intr(struct device *dev, struct device_attribute *
 	reg &= RGB_CONV_TO_INTB_CLEAR;
 	reg |= rgb_conv_intr;
 
-	ret = i2c_smbus_write_byte_data(client, CONFIG3_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG3_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -1516,10 +1514,9 @@ static ssize_t show_adc_start_sync(struct device *dev, struct device_attribute *
 {
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1545,7 +1542,6 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 	int ret;
 	short int reg, adc_start_sync;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "i2cwrite"))
@@ -1557,7 +1553,7 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 		return -1;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -1569,7 +1565,7 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 		reg &= ADC_START_AT_I2C_WRITE;
 
 
-	ret = i2c_smbus_write_byte_data(client, CONFIG1_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG1_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -1595,10 +1591,9 @@ static ssize_t show_ir_comp_ctrl(struct device *dev, struct device_attribute *at
 {
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG2_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1623,7 +1618,6 @@ static ssize_t store_ir_comp_ctrl(struct device *dev, struct device_attribute *a
 	int ret;
 	short int reg, ir_comp_ctrl;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 
 	mutex_lock(&rwlock_mutex);
@@ -1637,7 +1631,7 @@ static ssize_t store_ir_comp_ctrl(struct device *dev, struct device_attribute *a
 		return -1;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG2_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;
@@ -1646,7 +1640,7 @@ static ssize_t store_ir_comp_ctrl(struct device *dev, struct device_attribute *a
 	reg &= ~(1<<REG_02_IR_COM_POS);
 	reg |= ir_comp_ctrl<<REG_02_IR_COM_POS;
 
-	ret = i2c_smbus_write_byte_data(client, CONFIG2_REG, (u8)reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG2_REG, (u8)reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);
 		return -1;
@@ -1667,10 +1661,9 @@ static ssize_t show_active_ir_comp(struct device *dev, struct device_attribute *
 {
 	short int reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG); 
+	reg = isl_core_read(isl29124_regmap, CONFIG2_REG); 
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 		return -1;	
@@ -1696,7 +1689,6 @@ static ssize_t store_active_ir_comp(struct device *dev, struct device_attribute
 	int ret;
 	unsigned short reg;
 
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -1704,8 +1696,8 @@ static ssize_t store_active_ir_comp(struct device *dev, struct device_attribute
 		printk(KERN_ERR "%s: Invalid input value\n", __FUNCTION__);
 		return -1;
 	}
-	ret = i2c_smbus_write_byte_data(client, CONFIG2_REG, (u8)reg); 
-//	ret = isl29124_i2c_write_word16(client, CONFIG2_REG, &reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG2_REG, (u8)reg); 
+//	ret = isl29124_i2c_write_word16(CONFIG2_REG, &reg);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to write word\n", __FUNCTION__);
 		return -1;
@@ -1736,8 +1728,11 @@ static ssize_t isl29124_store_enable_sensor(struct device *dev,
 	
 	if(val == 1)
 	{
+	int range;
 	sensor_enable = 1;
 	mutex_lock(&rwlock_mutex);
+	/* the frames carry the range from here on, without reading it back */
+	get_optical_range(&range);
 	__cancel_delayed_work(&sensor_dwork);
 	schedule_delayed_work(&sensor_dwork, msecs_to_jiffies(POLL_DELAY));	// 125ms
 	mutex_unlock(&rwlock_mutex);
@@ -1772,17 +1767,47 @@ static ssize_t isl29124_store_delay(struct device *dev,
 }
 #endif
 
+#ifdef ISL29124_INTERRUPT_MODE
+/*
+ * @fn          show_irq_latency
+ *
+ * @brief       This function shows the interrupt latency as "last max average count",
+ *              the times in microseconds
+ *
+ * @return      Returns the length of data buffer
+ */
+static ssize_t show_irq_latency(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return isl_core_latency_show(&isl29124_latency, buf);
+}
+
+/*
+ * @fn          store_irq_latency
+ *
+ * @brief       This function restarts the latency measurement on any write
+ *
+ * @return      Returns the length of data buffer
+ */
+static ssize_t store_irq_latency(struct device *dev,
+				struct device_attribute *attr, const char *buf, size_t count)
+{
+	disable_irq(irq_num);
+	isl_core_latency_reset(&isl29124_latency);
+	enable_irq(irq_num);
+	return count;
+}
+#endif
+
 static ssize_t show_reg_dump(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
 	int i;
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	mutex_lock(&rwlock_mutex);
 	*buf = 0;
 	for(i=0; i<15 ; i++)
 	{
-		reg = i2c_smbus_read_byte_data(client, (u8)i); 
+		reg = isl_core_read(isl29124_regmap, (u8)i); 
 		if (reg < 0) {
 			printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);
 			return -1;	
@@ -1800,12 +1825,14 @@ static ssize_t store_reg_dump(struct device *dev,
 	//unsigned long val = simple_strtoul(buf, NULL, 10);
 	unsigned int reg, dat;
 	int ret;	
-	struct i2c_client *client = to_i2c_client(dev);                             
 
 	sscanf(buf,"%02x %02x", &reg, &dat);
 	mutex_lock(&rwlock_mutex);
  
-	ret = i2c_smbus_write_byte_data(client, (u8)reg, (u8)dat);
+	ret = isl_core_write(isl29124_regmap, (u8)reg, (u8)dat);
+	/* 0x46 to the device id register resets the part */
+	if (ret >= 0 && reg == DEVICE_ID_REG)
+		isl_core_reload(isl29124_regmap, &isl29124_core_desc);
 
 
 	mutex_unlock(&rwlock_mutex);
@@ -1837,6 +1864,7 @@ static DEVICE_ATTR(intr_persistency, ISL29124_SYSFS_PERMISSIONS , show_intr_pers
 static DEVICE_ATTR(rgb_conv_intr, ISL29124_SYSFS_PERMISSIONS , show_rgb_conv_intr, store_rgb_conv_intr);
 
 static DEVICE_ATTR(adc_start_sync, ISL29124_SYSFS_PERMISSIONS , show_adc_start_sync, store_adc_start_sync);
+static DEVICE_ATTR(irq_latency, ISL29124_SYSFS_PERMISSIONS , show_irq_latency, store_irq_latency);
 #endif
 
 static DEVICE_ATTR(ir_comp_ctrl, ISL29124_SYSFS_PERMISSIONS , show_ir_comp_ctrl, store_ir_comp_ctrl);
@@ -1871,6 +1899,7 @@ static struct attribute *isl29124_attributes[] = {
 	&dev_attr_intr_persistency.attr,
 	&dev_attr_rgb_conv_intr.attr,
 	&dev_attr_adc_start_sync.attr,
+	&dev_attr_irq_latency.attr,
 #endif
 	/* IR compensation related attributes */
 	&dev_attr_ir_comp_ctrl.attr,
@@ -1892,11 +1921,11 @@ static struct attribute_group isl29124_attr_group = {
 /*
  * @fn          sensor_irq_thread 
  *
- * @brief       This thread is scheduled by sensor interrupt 
+ * @brief       This thread runs at real-time priority after a sensor interrupt 
  *
- * @return     	void
+ * @return     	IRQ_HANDLED
  */
-static void sensor_irq_thread(struct work_struct *work)
+static irqreturn_t sensor_irq_thread(int irq, void *dev_id)
 {
 
 	short int reg, intr_assign, intr_threshold_low, intr_threshold_high;
@@ -1904,7 +1933,7 @@ static void sensor_irq_thread(struct work_struct *work)
 	int ret;
 
 	/* Read the interrupt status flags from sensor */
-	reg = i2c_smbus_read_byte_data(isl29124_client_data, STATUS_FLAGS_REG);
+	reg = isl_core_read(isl29124_regmap, STATUS_FLAGS_REG);
 	if (reg < 0) {
 		printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);	
 		goto err_out;	
@@ -1912,7 +1941,7 @@ static void sensor_irq_thread(struct work_struct *work)
 
 	/* A threshold interrupt occured */
 	if(reg & RGBTHF_FLAG_POS) {
-		intr_assign = i2c_smbus_read_byte_data(isl29124_client_data, CONFIG3_REG);		
+		intr_assign = isl_core_read(isl29124_regmap, CONFIG3_REG);		
 		if (intr_assign < 0) {
 			printk(KERN_ERR "%s: Failed to read data\n", __FUNCTION__);	
 			goto err_out;	
@@ -1922,7 +1951,7 @@ static void sensor_irq_thread(struct work_struct *work)
 
 		if (intr_assign == INTR_THRESHOLD_ASSIGN_GREEN) {
 			/* GREEN interrupt occured */								
-			ret = isl29124_i2c_read_word16(isl29124_client_data, GREEN_DATA_LBYTE_REG, &green);	
+			ret = isl29124_i2c_read_word16(GREEN_DATA_LBYTE_REG, &green);	
 			if (ret < 0) {
 				printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 				goto err_out;
@@ -1935,7 +1964,7 @@ static void sensor_irq_thread(struct work_struct *work)
 
 	if(reg & BOUTF_FLAG_POS) {
 		/* Brownout interrupt occured */
-		ret = i2c_smbus_read_byte_data(isl29124_client_data, STATUS_FLAGS_REG);
+		ret = isl_core_read(isl29124_regmap, STATUS_FLAGS_REG);
 		if( ret < 0) {
 			printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);	
 			goto err_out;
@@ -1944,7 +1973,7 @@ static void sensor_irq_thread(struct work_struct *work)
 		ret &= ~(1 << BOUTF_FLAG_POS);
 
 		/* Clear the BOUTF flag */
-		ret = i2c_smbus_write_byte_data(isl29124_client_data, STATUS_FLAGS_REG, ret);
+		ret = isl_core_write(isl29124_regmap, STATUS_FLAGS_REG, ret);
 		if( ret < 0) {
 			printk(KERN_ERR "%s: Failed to write data\n", __FUNCTION__);	
 			goto err_out;
@@ -1953,23 +1982,25 @@ static void sensor_irq_thread(struct work_struct *work)
 	}
 
 err_out:
-	enable_irq(irq_num);
+	isl_core_latency_done(&isl29124_latency);
+	return IRQ_HANDLED;
 }
 
 /*
  * @fn          isl_sensor_irq_handler
  *
- * @brief       This function is the interrupt handler for sensor. It schedules and interrupt
- *              thread and resturns.
+ * @brief       This function is the hard interrupt handler for sensor. It stamps the
+ *              interrupt and wakes the interrupt thread, the line stays masked until
+ *              the thread returns (IRQF_ONESHOT).
  *
- * @return      IRQ_HANDLED
+ * @return      IRQ_WAKE_THREAD
  *
  */
 static irqreturn_t isl_sensor_irq_handler(int irq, void *dev_id)
 {
-	disable_irq(irq_num);
-	schedule_work(&work);	
-	return IRQ_HANDLED;
+	isl_core_irq_stamp(&isl29124_latency);
+	isl_iio_irq(isl29124_iio);
+	return IRQ_WAKE_THREAD;
 }
 
 #endif
@@ -1991,36 +2022,36 @@ void initialize_isl29124(struct i2c_client *client)
 	   RGB Data sensing range 4000 Lux,
 	   ADC resolution 16-bit,
 	   ADC start at intb start*/
-	i2c_smbus_write_byte_data(client, CONFIG1_REG, 0x2D); 
+	isl_core_write(isl29124_regmap, CONFIG1_REG, 0x2D); 
 #else
 	/* Set device mode to RGB , 
 	   RGB Data sensing range 4000 Lux,
 	   ADC resolution 16-bit,
 	   ADC start at i2c write 0x01*/
-	i2c_smbus_write_byte_data(client, CONFIG1_REG, 0x0D); 
+	isl_core_write(isl29124_regmap, CONFIG1_REG, 0x0D); 
 #endif
 
 	/* Default IR Active compenstation,
 	   Disable IR compensation control */
-	i2c_smbus_write_byte_data(client, CONFIG2_REG, 0x00);// changed by louis Mar 28 2014 
+	isl_core_write(isl29124_regmap, CONFIG2_REG, 0x00);// changed by louis Mar 28 2014 
 
 #ifdef ISL29124_INTERRUPT_MODE
 	/* Interrupt threshold assignment for Green,
 	   Interrupt persistency as 8 conversion data out of windows */
-	i2c_smbus_write_byte_data(client, CONFIG2_REG, 0x1D); 
+	isl_core_write(isl29124_regmap, CONFIG2_REG, 0x1D); 
 
 	/* Writing interrupt low threshold as 0xCCC (5% of max range) */
-	i2c_smbus_write_byte_data(client, LOW_THRESHOLD_LBYTE_REG, 0xCC);	
-	i2c_smbus_write_byte_data(client, LOW_THRESHOLD_HBYTE_REG, 0x0C);	
+	isl_core_write(isl29124_regmap, LOW_THRESHOLD_LBYTE_REG, 0xCC);	
+	isl_core_write(isl29124_regmap, LOW_THRESHOLD_HBYTE_REG, 0x0C);	
 
 	/* Writing interrupt high threshold as 0xF333 (80% of max range)  */
-	i2c_smbus_write_byte_data(client, HIGH_THRESHOLD_LBYTE_REG, 0xCC);	
-	i2c_smbus_write_byte_data(client, HIGH_THRESHOLD_HBYTE_REG, 0xCC);	
+	isl_core_write(isl29124_regmap, HIGH_THRESHOLD_LBYTE_REG, 0xCC);	
+	isl_core_write(isl29124_regmap, HIGH_THRESHOLD_HBYTE_REG, 0xCC);	
 #endif
 	/* Clear the brownout status flag */
-	reg = i2c_smbus_read_byte_data(client, STATUS_FLAGS_REG);
+	reg = isl_core_read(isl29124_regmap, STATUS_FLAGS_REG);
 	reg &= ~(1 << BOUTF_FLAG_POS);
-	i2c_smbus_write_byte_data(client, STATUS_FLAGS_REG, reg);		
+	isl_core_write(isl29124_regmap, STATUS_FLAGS_REG, reg);		
 
 }
 #if SENSOR_VREG
@@ -2110,16 +2141,7 @@ static void isl29124_work_handler(struct work_struct *work)
 	unsigned short regg = 0;
 	unsigned short regb = 0;
 	int ret;
-	ret = isl29124_i2c_read_word16(isl29124_client_data, RED_DATA_LBYTE_REG, &regr);	
-	if (ret < 0) {
-		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
-	}
-
-	ret = isl29124_i2c_read_word16(isl29124_client_data, GREEN_DATA_LBYTE_REG, &regg);	
-	if (ret < 0) {
-		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
-	}
-	ret = isl29124_i2c_read_word16(isl29124_client_data, BLUE_DATA_LBYTE_REG, &regb);	
+	ret = isl29124_read_rgb(&regr, &regg, &regb);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to read word\n", __FUNCTION__);	
 	}
@@ -2127,6 +2149,7 @@ static void isl29124_work_handler(struct work_struct *work)
 	      input_report_abs(sensor_input, ABS_R, regr);
 	      input_report_abs(sensor_input, ABS_G, regg);
 	      input_report_abs(sensor_input, ABS_B, regb);
+	      input_report_abs(sensor_input, ABS_MISC, rgb_range_hi);
 	      input_sync(sensor_input);
 	schedule_delayed_work(&sensor_dwork, msecs_to_jiffies(POLL_DELAY));	// restart timer
 }
@@ -2170,10 +2193,16 @@ printk("+++%s\n",__func__);
 	isl29124_power_init(client);
 	isl29124_power_on();
 #endif
-	/* Read the device id register from ISL29124 sensor device */
 	mdelay(10);
+	isl29124_regmap = isl_core_init(client, &isl29124_core_desc);
+	if (IS_ERR(isl29124_regmap)) {
+		printk(KERN_ERR "%s: Failed to set up register map\n", __FUNCTION__);
+		goto err;
+	}
+
+	/* Read the device id register from ISL29124 sensor device */
 	for(i = 0;i<10;i++)
-	reg = i2c_smbus_read_byte_data(client, DEVICE_ID_REG);
+	reg = isl_core_read(isl29124_regmap, DEVICE_ID_REG);
 	printk("%s,i2c client address is 0x%x,chip id is 0x%x",__func__,client->addr,reg);
 	/* Verify whether we have a valid sensor */
 	if( reg != ISL29124_DEV_ID) {
@@ -2207,17 +2236,14 @@ printk("+++%s\n",__func__);
 	}
 
 
-	/* Register irq handler for sensor */
-	ret = request_irq(irq_num, isl_sensor_irq_handler, 0, "isl29124", NULL);
+	/* Register irq handler and interrupt thread for sensor */
+	ret = request_threaded_irq(irq_num, isl_sensor_irq_handler, sensor_irq_thread,
+				IRQF_ONESHOT, "isl29124", NULL);
 	if (ret < 0) {
 		printk(KERN_ERR "%s: Failed to register irq handler for ISL29124 sensor interrupt\n", __FUNCTION__);  
 		goto err;
 	}
 
-	/* Initialize the sensor interrupt thread that would be scheduled by sensor
-	   interrupt handler */
-	INIT_WORK(&work, sensor_irq_thread);
-
 #endif
 #if SENSOR_INPUT
 	sensor_input = input_allocate_device();
@@ -2228,7 +2254,10 @@ printk("+++%s\n",__func__);
 	input_set_abs_params(sensor_input, ABS_R, 0, 0xFFFF, 0, 0);
 	input_set_abs_params(sensor_input, ABS_G, 0, 0xFFFF, 0, 0);
 	input_set_abs_params(sensor_input, ABS_B, 0, 0xFFFF, 0, 0);
+	input_set_abs_params(sensor_input, ABS_MISC, 0, 1, 0, 0);
 	sensor_input->name = "rgbsensor_isl29124_f";
+	/* the HAL finds sensor_enable and poll_delay through the input device */
+	sensor_input->dev.parent = &client->dev;
 	ret = input_register_device(sensor_input);
 	if (ret) {
 		printk("%s: Unable to register input device als: %s\n",
@@ -2251,6 +2280,17 @@ printk("+++%s\n",__func__);
 
 	/* Initialize a mutex for synchronization in sysfs file access */
 	mutex_init(&rwlock_mutex);
+
+	/* IIO is optional next to the input device and sysfs */
+#ifdef ISL29124_INTERRUPT_MODE
+	isl29124_iio = isl_iio_init(client, &isl29124_iio_desc, true);
+#else
+	isl29124_iio = isl_iio_init(client, &isl29124_iio_desc, false);
+#endif
+	if (IS_ERR(isl29124_iio)) {
+		printk(KERN_ERR "%s: Failed to register IIO device\n", __FUNCTION__);
+		isl29124_iio = NULL;
+	}
 	return 0;
 
 #ifdef ISL29124_INTERRUPT_MODE
@@ -2280,6 +2320,8 @@ static int __devexit isl_sensor_remove(struct i2c_client *client)
 	/* Free requested gpio */
 	gpio_free(ISL29124_INTR_GPIO);
 #endif
+	/* only once the interrupt is gone, its handler fires the IIO trigger */
+	isl_iio_remove(isl29124_iio);
 #if SENSOR_VREG
 	isl29124_power_off();
 	isl29124_power_dinit();
@@ -2303,7 +2345,7 @@ static int isl_sensor_suspend(struct i2c_client *client, pm_message_t msg)
 	int ret;
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG);
 	if(reg < 0) {
 		printk(KERN_ALERT "%s: Failed to read CONFIG1_REG\n", __FUNCTION__); 
 		goto err;
@@ -2313,7 +2355,7 @@ static int isl_sensor_suspend(struct i2c_client *client, pm_message_t msg)
 	reg |= RGB_OP_STANDBY_MODE_SET; 
 
 	/* Put the sensor device in standby mode */
-	ret = i2c_smbus_write_byte_data(client, CONFIG1_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG1_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ALERT "%s: Failed to write to CONFIG1_REG\n", __FUNCTION__);
 		goto err;
@@ -2342,7 +2384,7 @@ static int isl_sensor_resume(struct i2c_client *client)
 	int ret;
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29124_regmap, CONFIG1_REG);
 	if(reg < 0) {
 		printk(KERN_ALERT "%s: Failed to read CONFIG1_REG\n", __FUNCTION__); 
 		goto err;
@@ -2352,7 +2394,7 @@ static int isl_sensor_resume(struct i2c_client *client)
 	reg |= RGB_OP_GRB_MODE_SET; 
 
 	/* Put the sensor device in active conversion mode */
-	ret = i2c_smbus_write_byte_data(client, CONFIG1_REG, reg);
+	ret = isl_core_write(isl29124_regmap, CONFIG1_REG, reg);
 	if (ret < 0) {
 		printk(KERN_ALERT "%s: Failed to write to CONFIG1_REG\n", __FUNCTION__);
 		goto err;
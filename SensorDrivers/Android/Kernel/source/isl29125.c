@@ -27,6 +27,8 @@
 #include <linux/kernel.h>
 #include <linux/gpio.h>
 #include <linux/isl29125.h>
+#include <linux/input/isl_core.h>
+#include <linux/input/isl_iio.h>
 #include <linux/i2c.h>
 #include <linux/interrupt.h>
 #include <linux/mutex.h>
@@ -36,11 +38,25 @@
 #define ISL29125_INTERRUPT_MODE
 
 #ifdef ISL29125_INTERRUPT_MODE
-static struct work_struct work;
 static unsigned char irq_num;
+static struct isl_core_latency isl29125_latency;
 #endif
 static struct mutex rwlock_mutex;
 static struct i2c_client *isl_client;
+static struct regmap *isl29125_regmap;
+static struct iio_dev *isl29125_iio;
+
+/* Status flags and RGB data are updated by the part */
+static const struct regmap_range isl29125_volatile_ranges[] = {
+	ISL_CORE_RANGE(STATUS_FLAGS_REG, BLUE_DATA_LBYTE_REG + 1),
+};
+
+static const struct isl_core_desc isl29125_core_desc = {
+	.name = "isl29125",
+	.max_register = BLUE_DATA_LBYTE_REG + 1,
+	.volatile_ranges = isl29125_volatile_ranges,
+	.num_volatile_ranges = ARRAY_SIZE(isl29125_volatile_ranges),
+};
 
 /* Devices supported by this driver and their I2C address */
 static struct i2c_device_id isl_sensor_device_table[] = {
@@ -61,7 +77,7 @@ static int set_optical_range(int *range)
 {
 	int ret;
 
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG1_REG);
+	ret = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (ret < 0) {
 		__dbg_read_err("%s",__func__);
 		return -1;
@@ -72,7 +88,7 @@ static int set_optical_range(int *range)
 		ret &= RGB_SENSE_RANGE_330_SET;
 	else
 		return -1;
-	ret = i2c_smbus_write_byte_data(isl_client, CONFIG1_REG, ret);
+	ret = isl_core_write(isl29125_regmap, CONFIG1_REG, ret);
 	if (ret < 0) {
 		__dbg_write_err("%s",__func__);
 		return -1;
@@ -92,7 +108,7 @@ static int set_optical_range(int *range)
 static int get_optical_range(int *range)
 {
 	int ret;
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG1_REG);
+	ret = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (ret < 0) 
 		return -1;
 	
@@ -112,7 +128,7 @@ static int get_optical_range(int *range)
 static int get_adc_resolution_bits(int *res)
 {
 	int ret;
-	ret = i2c_smbus_read_byte_data(isl_client, CONFIG1_REG);
+	ret = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (ret < 0) 
 		return -1;
 	
@@ -132,7 +148,7 @@ static int get_adc_resolution_bits(int *res)
 static int set_adc_resolution_bits(int *res)
 {
 	int reg;
-	reg = i2c_smbus_read_byte_data(isl_client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		return -1;
@@ -142,7 +158,7 @@ static int set_adc_resolution_bits(int *res)
 	else
 		reg &= ADC_RESOLUTION_16BIT_SET;
 
-	if(i2c_smbus_write_byte_data(isl_client, CONFIG1_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG1_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		return -1;
 	}
@@ -162,11 +178,11 @@ static int set_mode(int mode)
 {
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(isl_client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (reg < 0) 
 		return -1;
 	reg = (reg & RGB_OP_MODE_CLEAR) | mode;
-	if(i2c_smbus_write_byte_data(isl_client, CONFIG1_REG, reg) < 0)
+	if(isl_core_write(isl29125_regmap, CONFIG1_REG, reg) < 0)
 		return -1;
 	
 	return 0;
@@ -247,20 +263,15 @@ static void autorange(int green)
  *
  */
 
-static int isl29125_i2c_read_word16(struct i2c_client *client, unsigned char reg_addr, unsigned short *buf)
+static int isl29125_i2c_read_word16(unsigned char reg_addr, unsigned short *buf)
 {
-	short int reg_h;
-	short int reg_l;
+	int ret;
 
-	reg_l = i2c_smbus_read_byte_data(client, reg_addr);
-	if (reg_l < 0) 
-		return -1;
-	
-	reg_h = i2c_smbus_read_byte_data(client, reg_addr + 1);
-	if (reg_h < 0) 
+	ret = isl_core_read16(isl29125_regmap, reg_addr);
+	if (ret < 0)
 		return -1;
-	
-	*buf = (reg_h << 8) | reg_l;
+
+	*buf = ret;
 	return 0;
 }
 
@@ -274,22 +285,58 @@ static int isl29125_i2c_read_word16(struct i2c_client *client, unsigned char reg
  *
  */
 
-static int isl29125_i2c_write_word16(struct i2c_client *client, unsigned char reg_addr, unsigned short *buf)
+static int isl29125_i2c_write_word16(unsigned char reg_addr, unsigned short *buf)
 {
-	unsigned char reg_h;
-	unsigned char reg_l;
+	if(isl_core_write16(isl29125_regmap, reg_addr, *buf) < 0)
+		return -1;
+	return 0;
+}
+
+/*
+ * @fn         	isl29125_iio_read_sample
+ *
+ * @brief       This function reads the red, green and blue data of one
+ *              conversion in a single 6-byte burst for the IIO buffer
+ *
+ * @return      Returns 0 on success otherwise returns an error
+ *
+ */
 
-	/* Extract LSB and MSB bytes from data */
-	reg_l = *buf & 0xFF;
-	reg_h = (*buf & 0xFF00) >> 8;
+static int isl29125_iio_read_sample(struct i2c_client *client, u16 *vals)
+{
+	u8 dat[BLUE_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG + 1];
+	int ret;
 
-	if(i2c_smbus_write_byte_data(client, reg_addr, reg_l) < 0)
-		return -1;
-	if(i2c_smbus_write_byte_data(client, reg_addr + 1, reg_h) < 0)
-		return -1;
+	mutex_lock(&rwlock_mutex);
+	ret = isl_core_read_block(isl29125_regmap, GREEN_DATA_LBYTE_REG, dat, sizeof(dat));
+	mutex_unlock(&rwlock_mutex);
+	if(ret < 0)
+		return ret;
+
+	vals[0] = (dat[RED_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) |
+			dat[RED_DATA_LBYTE_REG - GREEN_DATA_LBYTE_REG];
+	vals[1] = (dat[GREEN_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) | dat[0];
+	vals[2] = (dat[BLUE_DATA_HBYTE_REG - GREEN_DATA_LBYTE_REG] << 8) |
+			dat[BLUE_DATA_LBYTE_REG - GREEN_DATA_LBYTE_REG];
 	return 0;
 }
 
+static const struct iio_chan_spec isl29125_iio_channels[] = {
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_RED, 0, 16),
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_GREEN, 1, 16),
+	ISL_IIO_CHANNEL(IIO_INTENSITY, IIO_MOD_LIGHT_BLUE, 2, 16),
+	IIO_CHAN_SOFT_TIMESTAMP(3),
+};
+
+/* 16-bit conversions of all three colours take about 300 ms */
+static const struct isl_iio_desc isl29125_iio_desc = {
+	.name = "isl29125",
+	.channels = isl29125_iio_channels,
+	.num_channels = ARRAY_SIZE(isl29125_iio_channels),
+	.default_period_ms = 300,
+	.read_sample = isl29125_iio_read_sample,
+};
+
 
 /*
  * @fn         	show_red
@@ -303,10 +350,9 @@ static int isl29125_i2c_write_word16(struct i2c_client *client, unsigned char re
 static ssize_t show_red(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	if(isl29125_i2c_read_word16(client, RED_DATA_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_read_word16(RED_DATA_LBYTE_REG, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
 		return -1;
@@ -329,10 +375,9 @@ static ssize_t show_red(struct device *dev, struct device_attribute *attr, char
 static ssize_t show_green(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	if(isl29125_i2c_read_word16(client, GREEN_DATA_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_read_word16(GREEN_DATA_LBYTE_REG, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
 		return -1;
@@ -360,10 +405,9 @@ static ssize_t show_green(struct device *dev, struct device_attribute *attr, cha
 static ssize_t show_blue(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	if(isl29125_i2c_read_word16(client, BLUE_DATA_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_read_word16(BLUE_DATA_LBYTE_REG, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
 		return -1;
@@ -386,10 +430,9 @@ static ssize_t show_blue(struct device *dev, struct device_attribute *attr, char
 static ssize_t show_mode(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -550,10 +593,9 @@ static ssize_t store_adc_resolution_bits(struct device *dev, struct device_attri
 static ssize_t show_intr_threshold_high(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	if(isl29125_i2c_read_word16(client, HIGH_THRESHOLD_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_read_word16(HIGH_THRESHOLD_LBYTE_REG, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
 		return -1;
@@ -576,7 +618,6 @@ static ssize_t store_intr_threshold_high(struct device *dev, struct device_attri
 						 const char *buf, size_t count)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -584,7 +625,7 @@ static ssize_t store_intr_threshold_high(struct device *dev, struct device_attri
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	if(isl29125_i2c_write_word16(client, HIGH_THRESHOLD_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_write_word16(HIGH_THRESHOLD_LBYTE_REG, &reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -608,10 +649,9 @@ err:
 static ssize_t show_intr_threshold_low(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	if(isl29125_i2c_read_word16(client, LOW_THRESHOLD_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_read_word16(LOW_THRESHOLD_LBYTE_REG, &reg) < 0){
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
 		return -1;
@@ -633,7 +673,6 @@ static ssize_t store_intr_threshold_low(struct device *dev, struct device_attrib
 					const char *buf, size_t count)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -641,7 +680,7 @@ static ssize_t store_intr_threshold_low(struct device *dev, struct device_attrib
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	if(isl29125_i2c_write_word16(client, LOW_THRESHOLD_LBYTE_REG, &reg) < 0){
+	if(isl29125_i2c_write_word16(LOW_THRESHOLD_LBYTE_REG, &reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -665,10 +704,9 @@ static ssize_t show_intr_threshold_assign(struct device *dev, struct device_attr
 							 char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -702,7 +740,6 @@ static ssize_t store_intr_threshold_assign(struct device *dev, struct device_att
 {
 	short int reg;
 	short int threshold_assign;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "none")) {
@@ -717,13 +754,13 @@ static ssize_t store_intr_threshold_assign(struct device *dev, struct device_att
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
 	}
 	reg = (reg & INTR_THRESHOLD_ASSIGN_CLEAR) | threshold_assign;
-	if(i2c_smbus_write_byte_data(client, CONFIG3_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG3_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -748,10 +785,9 @@ static ssize_t show_intr_persistency(struct device *dev, struct device_attribute
 
 	short int reg;
 	short int intr_persist;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -783,7 +819,6 @@ static ssize_t store_intr_persistency(struct device *dev, struct device_attribut
 {
 	short int reg;
 	short int intr_persist;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	intr_persist = simple_strtoul(buf, NULL, 10);
@@ -799,14 +834,14 @@ static ssize_t store_intr_persistency(struct device *dev, struct device_attribut
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
 	}
 	reg &= INTR_PERSIST_CTRL_CLEAR;
 	reg |= intr_persist << INTR_PERSIST_CTRL_POS;
-	if(i2c_smbus_write_byte_data(client, CONFIG3_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG3_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -829,10 +864,9 @@ err:
 static ssize_t show_rgb_conv_intr(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		pr_err( "%s : %s: Failed to read data\n", ISL29125_MODULE, __func__);
 		mutex_unlock(&rwlock_mutex);
@@ -858,7 +892,6 @@ static ssize_t store_rgb_conv_intr(struct device *dev, struct device_attribute *
 {
 	int rgb_conv_intr;
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "enable"))
@@ -869,14 +902,14 @@ static ssize_t store_rgb_conv_intr(struct device *dev, struct device_attribute *
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	reg = i2c_smbus_read_byte_data(client, CONFIG3_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG3_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
 	}
 
 	reg |= (reg & RGB_CONV_TO_INTB_CLEAR) | rgb_conv_intr;
-	if(i2c_smbus_write_byte_data(client, CONFIG3_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG3_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -900,10 +933,9 @@ err:
 static ssize_t show_adc_start_sync(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -929,7 +961,6 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 					 const char *buf, size_t count)
 {
 	short int reg, adc_start_sync;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "i2cwrite"))
@@ -940,7 +971,7 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
@@ -949,7 +980,7 @@ static ssize_t store_adc_start_sync(struct device *dev, struct device_attribute
 		reg |= ADC_START_AT_RISING_INTB;
 	else
 		reg &= ADC_START_AT_I2C_WRITE;
-	if(i2c_smbus_write_byte_data(client, CONFIG1_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG1_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -973,10 +1004,9 @@ err:
 static ssize_t show_ir_comp_ctrl(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG2_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -1002,7 +1032,6 @@ static ssize_t store_ir_comp_ctrl(struct device *dev, struct device_attribute *a
 {
 	int ir_comp_ctrl;
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	if(!strcmp(buf, "enable"))
@@ -1014,13 +1043,13 @@ static ssize_t store_ir_comp_ctrl(struct device *dev, struct device_attribute *a
 		goto err;
 	}
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG2_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
 	}
 	reg = (reg & IR_COMPENSATION_CLEAR) | ir_comp_ctrl;
-	if(i2c_smbus_write_byte_data(client, CONFIG2_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG2_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -1043,10 +1072,9 @@ err:
 static ssize_t show_active_ir_comp(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	short int reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
-	reg = i2c_smbus_read_byte_data(client, CONFIG2_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG2_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		mutex_unlock(&rwlock_mutex);
@@ -1070,7 +1098,6 @@ static ssize_t store_active_ir_comp(struct device *dev, struct device_attribute
 			const char *buf, size_t count)
 {
 	unsigned short reg;
-	struct i2c_client *client = to_i2c_client(dev);
 
 	mutex_lock(&rwlock_mutex);
 	reg = simple_strtoul(buf, NULL, 10);
@@ -1078,7 +1105,7 @@ static ssize_t store_active_ir_comp(struct device *dev, struct device_attribute
 		__dbg_invl_err("%s",__func__);
 		goto err;
 	}
-	if(isl29125_i2c_write_word16(client, CONFIG2_REG, &reg) < 0){
+	if(isl29125_i2c_write_word16(CONFIG2_REG, &reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -1089,6 +1116,39 @@ err:
 	return -1;
 }
 
+/*
+ * @fn          show_irq_latency
+ *
+ * @brief       This function Displays the interrupt latency as "last max average count",
+ *              the times in microseconds
+ *
+ * @return     	Returns length of data buffer
+ *
+ */
+
+static ssize_t show_irq_latency(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return isl_core_latency_show(&isl29125_latency, buf);
+}
+
+/*
+ * @fn          store_irq_latency
+ *
+ * @brief       This function restarts the latency measurement on any write
+ *
+ * @return     	Returns length of data buffer
+ *
+ */
+
+static ssize_t store_irq_latency(struct device *dev, struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	disable_irq(irq_num);
+	isl_core_latency_reset(&isl29125_latency);
+	enable_irq(irq_num);
+	return count;
+}
+
 #endif
 /* Attributes of ISL29125 RGB light sensor */
 static DEVICE_ATTR(red, ISL29125_SYSFS_PERMISSIONS , show_red, NULL);
@@ -1116,6 +1176,8 @@ static DEVICE_ATTR(adc_start_sync, ISL29125_SYSFS_PERMISSIONS , show_adc_start_s
 static DEVICE_ATTR(ir_comp_ctrl, ISL29125_SYSFS_PERMISSIONS , show_ir_comp_ctrl, store_ir_comp_ctrl);
 static DEVICE_ATTR(active_ir_comp, ISL29125_SYSFS_PERMISSIONS , show_active_ir_comp, 
 			store_active_ir_comp);
+static DEVICE_ATTR(irq_latency, ISL29125_SYSFS_PERMISSIONS , show_irq_latency,
+			store_irq_latency);
 #endif
 
 static struct attribute *isl29125_attributes[] = {
@@ -1146,6 +1208,9 @@ static struct attribute *isl29125_attributes[] = {
 	/* IR compensation related attributes */
 	&dev_attr_ir_comp_ctrl.attr,
 	&dev_attr_active_ir_comp.attr,
+
+	/* Interrupt to report latency */
+	&dev_attr_irq_latency.attr,
 #endif
 	NULL
 };
@@ -1159,12 +1224,12 @@ static struct attribute_group isl29125_attr_group = {
 /*
  * @fn          sensor_irq_thread
  *
- * @brief       This thread is scheduled by sensor interrupt
+ * @brief       This thread runs at real-time priority after a sensor interrupt
  *
- * @return     	void
+ * @return     	IRQ_HANDLED
  */
 
-static void sensor_irq_thread(struct work_struct *work)
+static irqreturn_t sensor_irq_thread(int irq, void *dev_id)
 {
 
 	short int reg, intr_assign;
@@ -1172,7 +1237,7 @@ static void sensor_irq_thread(struct work_struct *work)
 	int ret;
 
 	/* Read the interrupt status flags from sensor */
-	reg = i2c_smbus_read_byte_data(isl_client, STATUS_FLAGS_REG);
+	reg = isl_core_read(isl29125_regmap, STATUS_FLAGS_REG);
 	if (reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err_out;
@@ -1180,7 +1245,7 @@ static void sensor_irq_thread(struct work_struct *work)
 
 	/* A threshold interrupt occured */
 	if(reg & (1 << RGBTHF_FLAG_POS)) {
-		intr_assign = i2c_smbus_read_byte_data(isl_client, CONFIG3_REG);
+		intr_assign = isl_core_read(isl29125_regmap, CONFIG3_REG);
 		if (intr_assign < 0) {
 			__dbg_read_err("%s",__func__);
 			goto err_out;
@@ -1188,7 +1253,7 @@ static void sensor_irq_thread(struct work_struct *work)
 		intr_assign &= 0x3;
 		if (intr_assign == INTR_THRESHOLD_ASSIGN_GREEN) {
 			/* GREEN interrupt occured */
-			if(isl29125_i2c_read_word16(isl_client, GREEN_DATA_LBYTE_REG, &green) < 0){
+			if(isl29125_i2c_read_word16(GREEN_DATA_LBYTE_REG, &green) < 0){
 				__dbg_read_err("%s",__func__);
 				goto err_out;
 			}
@@ -1198,7 +1263,7 @@ static void sensor_irq_thread(struct work_struct *work)
 
 	if(reg & (1 << BOUTF_FLAG_POS)) {
 		/* Brownout interrupt occured */
-		ret = i2c_smbus_read_byte_data(isl_client, STATUS_FLAGS_REG);
+		ret = isl_core_read(isl29125_regmap, STATUS_FLAGS_REG);
 		if( ret < 0) {
 			__dbg_write_err("%s",__func__);
 			goto err_out;
@@ -1206,31 +1271,33 @@ static void sensor_irq_thread(struct work_struct *work)
 		ret &= ~(1 << BOUTF_FLAG_POS);
 
 		/* Clear the BOUTF flag */
-		ret = i2c_smbus_write_byte_data(isl_client, STATUS_FLAGS_REG, ret);
+		ret = isl_core_write(isl29125_regmap, STATUS_FLAGS_REG, ret);
 		if( ret < 0) {
 			__dbg_write_err("%s",__func__);
 			goto err_out;
 		}
 	}
 err_out:
-	enable_irq(irq_num);
+	isl_core_latency_done(&isl29125_latency);
+	return IRQ_HANDLED;
 }
 
 /*
  * @fn          isl_sensor_irq_handler
  *
- * @brief       This function is the interrupt handler for sensor. It schedules and interrupt
- *              thread and resturns.
+ * @brief       This function is the hard interrupt handler for sensor. It stamps the
+ *              interrupt and wakes the interrupt thread, the line stays masked until
+ *              the thread returns (IRQF_ONESHOT).
  *
- * @return      IRQ_HANDLED
+ * @return      IRQ_WAKE_THREAD
  *
  */
 
 static irqreturn_t isl_sensor_irq_handler(int irq, void *dev_id)
 {
-	disable_irq_nosync(irq_num);
-	schedule_work(&work);
-	return IRQ_HANDLED;
+	isl_core_irq_stamp(&isl29125_latency);
+	isl_iio_irq(isl29125_iio);
+	return IRQ_WAKE_THREAD;
 }
 
 #endif
@@ -1254,37 +1321,37 @@ static void initialize_isl29125(struct i2c_client *client)
 	   RGB Data sensing range 4000 Lux,
 	   ADC resolution 16-bit,
 	   ADC start at intb start*/
-	i2c_smbus_write_byte_data(client, CONFIG1_REG, 0x2D);
+	isl_core_write(isl29125_regmap, CONFIG1_REG, 0x2D);
 
 #endif
 
 	/* Default IR Active compenstation,
 	   Disable IR compensation control */
-	i2c_smbus_write_byte_data(client, CONFIG2_REG, 0x80);
+	isl_core_write(isl29125_regmap, CONFIG2_REG, 0x80);
 
 #ifdef ISL29125_INTERRUPT_MODE
 	/* Interrupt threshold assignment for Green,
 	   Interrupt persistency as 8 conversion data out of windows */
-	i2c_smbus_write_byte_data(client, CONFIG3_REG, 0x0D);
+	isl_core_write(isl29125_regmap, CONFIG3_REG, 0x0D);
 
 	/* Writing interrupt low threshold as 0xCCC (5% of max range) */
-	i2c_smbus_write_byte_data(client, LOW_THRESHOLD_LBYTE_REG, 0xCC);
-	i2c_smbus_write_byte_data(client, LOW_THRESHOLD_HBYTE_REG, 0x0C);
+	isl_core_write(isl29125_regmap, LOW_THRESHOLD_LBYTE_REG, 0xCC);
+	isl_core_write(isl29125_regmap, LOW_THRESHOLD_HBYTE_REG, 0x0C);
 
 	/* Writing interrupt high threshold as 0xCCCC (80% of max range)  */
-	i2c_smbus_write_byte_data(client, HIGH_THRESHOLD_LBYTE_REG, 0xCC);
-	i2c_smbus_write_byte_data(client, HIGH_THRESHOLD_HBYTE_REG, 0xCC);
+	isl_core_write(isl29125_regmap, HIGH_THRESHOLD_LBYTE_REG, 0xCC);
+	isl_core_write(isl29125_regmap, HIGH_THRESHOLD_HBYTE_REG, 0xCC);
 #endif
 	/* Clear the brownout status flag */
-	reg = i2c_smbus_read_byte_data(client, STATUS_FLAGS_REG);
+	reg = isl_core_read(isl29125_regmap, STATUS_FLAGS_REG);
 	reg &= ~(1 << BOUTF_FLAG_POS);
-	i2c_smbus_write_byte_data(client, STATUS_FLAGS_REG, reg);
+	isl_core_write(isl29125_regmap, STATUS_FLAGS_REG, reg);
 
 	/* Set device mode to RGB ,
 	   RGB Data sensing range 4000 Lux,
 	   ADC resolution 16-bit,
 	   ADC start at i2c write 0x01*/
-	i2c_smbus_write_byte_data(client, CONFIG1_REG, 0x01);
+	isl_core_write(isl29125_regmap, CONFIG1_REG, 0x01);
 }
 
 /*
@@ -1308,8 +1375,12 @@ static int __devinit isl_sensor_probe(struct i2c_client *client, const struct i2
 		return -1;
 	}
 
+	isl29125_regmap = isl_core_init(client, &isl29125_core_desc);
+	if (IS_ERR(isl29125_regmap))
+		return -1;
+
 	/* Read the device id register from ISL29125 sensor device */
-	reg = i2c_smbus_read_byte_data(client, DEVICE_ID_REG);
+	reg = isl_core_read(isl29125_regmap, DEVICE_ID_REG);
 	if(reg < 0){
 		pr_err("%s :failed to read device id\n",__func__);
 		return -1;
@@ -1355,12 +1426,9 @@ static int __devinit isl_sensor_probe(struct i2c_client *client, const struct i2
 		goto gpio_err;
 	} 
 
-	/* Initialize the sensor interrupt thread that would be scheduled by sensor
-	   interrupt handler */
-	INIT_WORK(&work, sensor_irq_thread);
-
-	/* Register irq handler for sensor */
-	if( request_irq(irq_num, isl_sensor_irq_handler, IRQF_TRIGGER_FALLING, "isl29125", NULL) < 0){
+	/* Register irq handler and interrupt thread for sensor */
+	if( request_threaded_irq(irq_num, isl_sensor_irq_handler, sensor_irq_thread,
+			IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "isl29125", NULL) < 0){
 		pr_err( "%s : %s: Failed to register irq handler for ISL29125 sensor interrupt\n", ISL29125_MODULE, __func__);
 		goto gpio_err;
 	}
@@ -1377,7 +1445,18 @@ static int __devinit isl_sensor_probe(struct i2c_client *client, const struct i2
 	mutex_init(&rwlock_mutex);
 	
 	/* Start ADC conversion */
-	i2c_smbus_write_byte_data(client, CONFIG1_REG, 0x01);
+	isl_core_write(isl29125_regmap, CONFIG1_REG, 0x01);
+
+	/* IIO is optional next to sysfs */
+#ifdef ISL29125_INTERRUPT_MODE
+	isl29125_iio = isl_iio_init(client, &isl29125_iio_desc, true);
+#else
+	isl29125_iio = isl_iio_init(client, &isl29125_iio_desc, false);
+#endif
+	if(IS_ERR(isl29125_iio)){
+		pr_err("%s : %s: Failed to register IIO device\n", ISL29125_MODULE, __func__);
+		isl29125_iio = NULL;
+	}
 	
 	return 0;
 
@@ -1410,6 +1489,8 @@ static int __devexit isl_sensor_remove(struct i2c_client *client)
 	/* Free requested gpio */
 	gpio_free(ISL29125_INTR_GPIO);
 #endif
+	/* only once the interrupt is gone, its handler fires the IIO trigger */
+	isl_iio_remove(isl29125_iio);
 	return 0;
 }
 
@@ -1426,14 +1507,14 @@ static int isl_sensor_suspend(struct i2c_client *client, pm_message_t msg)
 {
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if(reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
 	}
 	reg = (reg & RGB_OP_MODE_CLEAR) | RGB_OP_STANDBY_MODE_SET;
 	/* Put the sensor device in standby mode */
-	if(i2c_smbus_write_byte_data(client, CONFIG1_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG1_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -1459,7 +1540,7 @@ static int isl_sensor_resume(struct i2c_client *client)
 
 	short int reg;
 
-	reg = i2c_smbus_read_byte_data(client, CONFIG1_REG);
+	reg = isl_core_read(isl29125_regmap, CONFIG1_REG);
 	if(reg < 0) {
 		__dbg_read_err("%s",__func__);
 		goto err;
@@ -1467,7 +1548,7 @@ static int isl_sensor_resume(struct i2c_client *client)
 	reg &= RGB_OP_MODE_CLEAR;
 	reg |= RGB_OP_GRB_MODE_SET;
 	/* Put the sensor device in active conversion mode */
-	if(i2c_smbus_write_byte_data(client, CONFIG1_REG, reg) < 0){
+	if(isl_core_write(isl29125_regmap, CONFIG1_REG, reg) < 0){
 		__dbg_write_err("%s",__func__);
 		goto err;
 	}
@@ -33,6 +33,7 @@
 #include <linux/hrtimer.h>
 #include <linux/input.h>
 #include <linux/input/isl29177.h>
+#include <linux/input/isl_core.h>
 #include <linux/slab.h>
 #include <linux/sysfs.h>
 #include <linux/delay.h>
@@ -48,6 +49,7 @@
  *		  	  			in the driver probe
  *  @ prox_poll_delay 	- Timer interval of high resolution timer 
  *  @ client			- Reference to I2C slave (sensor device)  
+ *  @ regmap			- Cached register map of the sensor, see isl_core
  *  @ isl29177_kobj 	- Kernel object used as parent node for sysfs entry
  *  @ mutex				- Provides mutex based synchronization for userspace
  *			  			access to driver sysfs files
@@ -64,6 +66,7 @@ struct isl29177_drv_data {
 	struct hrtimer *timer;
 	ktime_t prox_poll_delay;
 	struct i2c_client *client;
+	struct regmap *regmap;
 	struct kobject *isl29177_kobj;
 	struct mutex mutex;
 	struct work_struct work;
@@ -300,13 +303,25 @@ static struct i2c_device_id isl_device_ids[] = {
 
 MODULE_DEVICE_TABLE(i2c, isl_device_ids);
 
+/* status, data, the reset/test register and the fuse block */
+static const struct regmap_range isl29177_volatile_ranges[] = {
+	ISL_CORE_RANGE(STATUS_REG, FUSE_CONTROL),
+};
+
+static const struct isl_core_desc isl29177_core_desc = {
+	.name			= "isl29177",
+	.max_register		= FUSE_CONTROL,
+	.volatile_ranges	= isl29177_volatile_ranges,
+	.num_volatile_ranges	= ARRAY_SIZE(isl29177_volatile_ranges),
+};
+
 struct isl29177_drv_data drv_data;
 struct isl29177_sm rt;
 
 
 /** @function: isl_read_field
  *  @desc    : read function for reading a particular bit field in a particular register
- *   	       from isl29177 sensor registers over I2C interface
+ *   	       from isl29177 sensor registers through the cached register map
  *  @args    
  *  reg	     : register to read from (0x00h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to read from
@@ -320,29 +335,19 @@ struct isl29177_sm rt;
  */
 static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *val)
 {
-	unsigned char byte;
-	unsigned char i;
+	int ret;
 
-	byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-	if(mask == ISL_FULL_MASK) {
-		*val = byte;
-	} else {
-		byte &= mask;
-
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;	
+	ret = isl_core_read_field(drv_data.regmap, reg, mask);
+	if(ret < 0) return -1;
 
-		if( i > 7 ) return -1;
-
-		*val = (byte >> i);
-	}
+	*val = ret;
 	return 0;
 }
 
 
 /** @function: isl_write_field
  *  @desc    : write function for writing a particular bit field in a particular register
- *   	       to isl29177 sensor registers over I2C interface
+ *   	       to isl29177 sensor registers through the cached register map
  *  @args    
  *  reg	     : register to write to (0x00h to 0x0Fh)
  *  mask     : specific bit or group of continuous bits to write to
@@ -356,23 +361,8 @@ static int isl_read_field(unsigned char reg, unsigned char mask, unsigned char *
  */
 static int isl_write_field(unsigned char reg, unsigned char mask, unsigned char val)
 {
-	unsigned char byte;
-	unsigned char i = 0;
-
-	if(mask == ISL_FULL_MASK) {
-		i2c_smbus_write_byte_data(drv_data.client, reg, val);
-	} else {
-		byte = i2c_smbus_read_byte_data(drv_data.client, reg);
-		byte &= (~mask);
-
-		for(i = 0; i < 8; i++)
-			if(mask & (1 << i)) break;	
-
-		if(i > 7) return -1;
-
-		byte |= (val << i);
-		i2c_smbus_write_byte_data(drv_data.client, reg, byte);
-	}
+	if(isl_core_write_field(drv_data.regmap, reg, mask, val) < 0)
+		return -1;
 	return 0;
 }
 
@@ -806,6 +796,7 @@ static void isl29177_initialize(void)
 	/* Enable test mode */
 	isl_write_field(CONFIG2_REG, ISL_FULL_MASK, 0x89); 			
 	msleep(10);
+	isl_core_reload(drv_data.regmap, &isl29177_core_desc);
 
 	/* Set high offset */
 	isl_write_field(CONFIG1_REG, ISL_FULL_MASK, 0x20);
@@ -1213,6 +1204,10 @@ static int isl29177_probe(struct i2c_client *client, const struct i2c_device_id
 	drv_data.client = client;
 	drv_data.pdata = pdata;
 
+	drv_data.regmap = isl_core_init(client, &isl29177_core_desc);
+	if(IS_ERR(drv_data.regmap))
+		return PTR_ERR(drv_data.regmap);
+
 	/* Verify device id - Device ID Reg 00h */		
 	if(isl_read_field(DEVICE_ID_REG, 0xF0, &val))
 		goto end;
@@ -0,0 +1,362 @@
+/******************************************************************************
+        File            : isl_core.c
+
+        Description     : Register access shared by the ISL sensor drivers.
+                          Each part gets a regmap over I2C with a register
+                          cache, so configuration reads never reach the
+                          bus and a read-modify-write costs one bus write.
+                          Data registers are read in one burst per sample.
+                          Also keeps the interrupt latency figures.
+
+        Build           : A module of its own that every driver selects,
+                          never linked into a driver, so each symbol is
+                          exported once. See Kconfig and Makefile.
+
+        License         : GPLv2
+
+        Copyright       : Intersil Corporation (c) 2014
+*******************************************************************************/
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/i2c.h>
+#include <linux/regmap.h>
+#include <linux/slab.h>
+#include <linux/err.h>
+#include <linux/bitops.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/input/isl_core.h>
+
+static bool isl_core_volatile(const struct isl_core_desc *desc,
+				unsigned int reg)
+{
+	unsigned int i;
+
+	for (i = 0; i < desc->num_volatile_ranges; i++) {
+		if (reg >= desc->volatile_ranges[i].range_min &&
+				reg <= desc->volatile_ranges[i].range_max)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * @fn          isl_core_init
+ *
+ * @brief       Creates the register map of a part. The cache starts
+ *              empty, so regmap reads nothing at init, and is then seeded
+ *              through isl_core_reload(), which leaves the volatile data
+ *              and flag registers alone. The map is freed with the device.
+ *
+ * @return      Returns the map on success otherwise an ERR_PTR
+ */
+struct regmap *isl_core_init(struct i2c_client *client,
+				const struct isl_core_desc *desc)
+{
+	struct regmap_access_table *volatile_table;
+	struct regmap_config config;
+	struct regmap *map;
+	int ret;
+
+	/* regmap keeps a pointer to the table */
+	volatile_table = devm_kzalloc(&client->dev, sizeof(*volatile_table),
+					GFP_KERNEL);
+	if (!volatile_table)
+		return ERR_PTR(-ENOMEM);
+	volatile_table->yes_ranges = desc->volatile_ranges;
+	volatile_table->n_yes_ranges = desc->num_volatile_ranges;
+
+	memset(&config, 0, sizeof(config));
+	config.name = desc->name;
+	config.reg_bits = 8;
+	config.val_bits = 8;
+	config.max_register = desc->max_register;
+	config.volatile_table = volatile_table;
+	/*
+	 * No defaults: a flat cache with num_reg_defaults_raw would have
+	 * regcache_hw_init() read every register, volatile ones included.
+	 */
+	config.cache_type = REGCACHE_RBTREE;
+
+	map = devm_regmap_init_i2c(client, &config);
+	if (IS_ERR(map)) {
+		dev_err(&client->dev, "%s: register map init failed (%ld)\n",
+			desc->name, PTR_ERR(map));
+		return map;
+	}
+
+	ret = isl_core_reload(map, desc);
+	if (ret < 0) {
+		dev_err(&client->dev, "%s: register cache seed failed (%d)\n",
+			desc->name, ret);
+		return ERR_PTR(ret);
+	}
+	return map;
+}
+EXPORT_SYMBOL(isl_core_init);
+
+/*
+ * @fn          isl_core_reload
+ *
+ * @brief       Reads the non-volatile registers back into the cache. Call
+ *              after a software reset, which changes them behind regmap.
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_reload(struct regmap *map, const struct isl_core_desc *desc)
+{
+	unsigned int reg, val;
+	int ret = 0;
+
+	for (reg = 0; reg <= desc->max_register; reg++) {
+		/* reading data or flags back could clear them */
+		if (isl_core_volatile(desc, reg))
+			continue;
+
+		regcache_cache_bypass(map, true);
+		ret = regmap_read(map, reg, &val);
+		regcache_cache_bypass(map, false);
+		if (ret < 0)
+			break;
+
+		regcache_cache_only(map, true);
+		ret = regmap_write(map, reg, val);
+		regcache_cache_only(map, false);
+		if (ret < 0)
+			break;
+	}
+	return ret;
+}
+EXPORT_SYMBOL(isl_core_reload);
+
+/*
+ * @fn          isl_core_read
+ *
+ * @brief       Reads a register, from the cache unless it is volatile
+ *
+ * @return      Returns the register value otherwise a negative errno
+ */
+int isl_core_read(struct regmap *map, unsigned int reg)
+{
+	unsigned int val;
+	int ret;
+
+	ret = regmap_read(map, reg, &val);
+	if (ret < 0)
+		return ret;
+	return val;
+}
+EXPORT_SYMBOL(isl_core_read);
+
+/*
+ * @fn          isl_core_write
+ *
+ * @brief       Writes a register through the cache
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_write(struct regmap *map, unsigned int reg, unsigned int val)
+{
+	return regmap_write(map, reg, val);
+}
+EXPORT_SYMBOL(isl_core_write);
+
+/*
+ * @fn          isl_core_update
+ *
+ * @brief       Replaces the bits in mask with those of val. Nothing is
+ *              written if the register already holds the result.
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_update(struct regmap *map, unsigned int reg,
+			unsigned int mask, unsigned int val)
+{
+	return regmap_update_bits(map, reg, mask, val);
+}
+EXPORT_SYMBOL(isl_core_update);
+
+/*
+ * @fn          isl_core_read_field
+ *
+ * @brief       Reads the bit field selected by mask, shifted down to bit 0
+ *
+ * @return      Returns the field value otherwise a negative errno
+ */
+int isl_core_read_field(struct regmap *map, unsigned int reg,
+			unsigned int mask)
+{
+	int ret;
+
+	if (!mask)
+		return -EINVAL;
+	ret = isl_core_read(map, reg);
+	if (ret < 0)
+		return ret;
+	return (ret & mask) >> __ffs(mask);
+}
+EXPORT_SYMBOL(isl_core_read_field);
+
+/*
+ * @fn          isl_core_write_field
+ *
+ * @brief       Writes val into the bit field selected by mask
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_write_field(struct regmap *map, unsigned int reg,
+			unsigned int mask, unsigned int val)
+{
+	if (!mask)
+		return -EINVAL;
+	/* a whole register needs no read, not even of a volatile one */
+	if (mask == 0xff)
+		return regmap_write(map, reg, val & 0xff);
+	return regmap_update_bits(map, reg, mask, (val << __ffs(mask)) & mask);
+}
+EXPORT_SYMBOL(isl_core_write_field);
+
+/*
+ * @fn          isl_core_read_block
+ *
+ * @brief       Reads count consecutive registers starting at reg. When
+ *              all of them are volatile this is one combined write-then-
+ *              read transfer, so a multi-byte sample is fetched in one
+ *              bus transaction and cannot be torn by a new conversion.
+ *              Cached registers are copied from the cache.
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_read_block(struct regmap *map, unsigned int reg, u8 *buf,
+				size_t count)
+{
+	return regmap_bulk_read(map, reg, buf, count);
+}
+EXPORT_SYMBOL(isl_core_read_block);
+
+/*
+ * @fn          isl_core_read_burst
+ *
+ * @brief       Reads count consecutive registers from the bus in one
+ *              transfer even when some of them are cached, e.g. the
+ *              interrupt flags together with the data behind them. The
+ *              cache is left as it is. The caller serialises this against
+ *              other users of the map.
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_read_burst(struct regmap *map, unsigned int reg, u8 *buf,
+				size_t count)
+{
+	int ret;
+
+	regcache_cache_bypass(map, true);
+	ret = regmap_raw_read(map, reg, buf, count);
+	regcache_cache_bypass(map, false);
+	return ret;
+}
+EXPORT_SYMBOL(isl_core_read_burst);
+
+/*
+ * @fn          isl_core_read16
+ *
+ * @brief       Reads a 16-bit value held LSB first in reg and reg + 1
+ *
+ * @return      Returns the value otherwise a negative errno
+ */
+int isl_core_read16(struct regmap *map, unsigned int reg)
+{
+	u8 dat[2];
+	int ret;
+
+	ret = isl_core_read_block(map, reg, dat, sizeof(dat));
+	if (ret < 0)
+		return ret;
+	return (dat[1] << 8) | dat[0];
+}
+EXPORT_SYMBOL(isl_core_read16);
+
+/*
+ * @fn          isl_core_write16
+ *
+ * @brief       Writes a 16-bit value LSB first to reg and reg + 1
+ *
+ * @return      Returns 0 on success otherwise a negative errno
+ */
+int isl_core_write16(struct regmap *map, unsigned int reg, unsigned int val)
+{
+	int ret;
+
+	ret = regmap_write(map, reg, val & 0xff);
+	if (ret < 0)
+		return ret;
+	return regmap_write(map, reg + 1, (val >> 8) & 0xff);
+}
+EXPORT_SYMBOL(isl_core_write16);
+
+/*
+ * @fn          isl_core_latency_done
+ *
+ * @brief       Closes one interrupt: accounts the time since the stamp
+ *              taken by the hard IRQ handler
+ *
+ * @return      void
+ */
+void isl_core_latency_done(struct isl_core_latency *lat)
+{
+	u64 ns;
+
+	/* nothing stamped, e.g. a thread run without an interrupt */
+	if (!ktime_to_ns(lat->irq_time))
+		return;
+
+	ns = ktime_to_ns(ktime_sub(ktime_get(), lat->irq_time));
+	lat->irq_time = ktime_set(0, 0);
+	lat->last_ns = ns;
+	if (ns > lat->max_ns)
+		lat->max_ns = ns;
+	lat->total_ns += ns;
+	lat->count++;
+}
+EXPORT_SYMBOL(isl_core_latency_done);
+
+/*
+ * @fn          isl_core_latency_show
+ *
+ * @brief       Formats the latency as "last max average count", the
+ *              times in microseconds, for a sysfs show function
+ *
+ * @return      Returns the length of the text
+ */
+ssize_t isl_core_latency_show(const struct isl_core_latency *lat, char *buf)
+{
+	u64 avg = lat->count ? div_u64(lat->total_ns, lat->count) : 0;
+
+	return sprintf(buf, "%llu %llu %llu %u\n",
+			div_u64(lat->last_ns, NSEC_PER_USEC),
+			div_u64(lat->max_ns, NSEC_PER_USEC),
+			div_u64(avg, NSEC_PER_USEC), lat->count);
+}
+EXPORT_SYMBOL(isl_core_latency_show);
+
+/*
+ * @fn          isl_core_latency_reset
+ *
+ * @brief       Starts a new measurement
+ *
+ * @return      void
+ */
+void isl_core_latency_reset(struct isl_core_latency *lat)
+{
+	lat->last_ns = 0;
+	lat->max_ns = 0;
+	lat->total_ns = 0;
+	lat->count = 0;
+}
+EXPORT_SYMBOL(isl_core_latency_reset);
+
+MODULE_AUTHOR("Intersil Corporation");
+/* "GPLv2" is not a license string the kernel knows, regmap needs GPL */
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("Register access shared by the ISL sensor drivers");
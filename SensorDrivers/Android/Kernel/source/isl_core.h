@@ -0,0 +1,77 @@
+/******************************************************************************
+        File            : isl_core.h
+
+        Description     : Register access shared by the ISL sensor drivers
+
+        License         : GPLv2
+
+        Copyright       : Intersil Corporation (c) 2014
+*******************************************************************************/
+
+#ifndef _ISL_CORE_H_
+#define _ISL_CORE_H_
+
+#include <linux/i2c.h>
+#include <linux/regmap.h>
+#include <linux/ktime.h>
+
+/*
+ * Register layout of one part.
+ *
+ * Every register up to max_register is cached. Registers the part changes
+ * on its own (conversion data, status and interrupt flags, fuse and test
+ * registers) are listed in volatile_ranges and always read from the bus.
+ */
+struct isl_core_desc {
+	const char *name;
+	unsigned int max_register;
+	const struct regmap_range *volatile_ranges;
+	unsigned int num_volatile_ranges;
+};
+
+#define ISL_CORE_RANGE(first, last)	{ .range_min = (first), .range_max = (last) }
+
+struct regmap *isl_core_init(struct i2c_client *client,
+				const struct isl_core_desc *desc);
+int isl_core_reload(struct regmap *map, const struct isl_core_desc *desc);
+
+int isl_core_read(struct regmap *map, unsigned int reg);
+int isl_core_write(struct regmap *map, unsigned int reg, unsigned int val);
+int isl_core_update(struct regmap *map, unsigned int reg,
+			unsigned int mask, unsigned int val);
+
+int isl_core_read_field(struct regmap *map, unsigned int reg,
+			unsigned int mask);
+int isl_core_write_field(struct regmap *map, unsigned int reg,
+			unsigned int mask, unsigned int val);
+
+int isl_core_read_block(struct regmap *map, unsigned int reg, u8 *buf,
+				size_t count);
+int isl_core_read_burst(struct regmap *map, unsigned int reg, u8 *buf,
+				size_t count);
+int isl_core_read16(struct regmap *map, unsigned int reg);
+int isl_core_write16(struct regmap *map, unsigned int reg, unsigned int val);
+
+/*
+ * Interrupt latency of a part. The hard IRQ handler stamps the interrupt
+ * and the threaded handler closes the sample when it is done, so the
+ * figures include the wake-up of the thread and its bus traffic.
+ */
+struct isl_core_latency {
+	ktime_t irq_time;
+	u64 last_ns;
+	u64 max_ns;
+	u64 total_ns;
+	u32 count;
+};
+
+static inline void isl_core_irq_stamp(struct isl_core_latency *lat)
+{
+	lat->irq_time = ktime_get();
+}
+
+void isl_core_latency_done(struct isl_core_latency *lat);
+ssize_t isl_core_latency_show(const struct isl_core_latency *lat, char *buf);
+void isl_core_latency_reset(struct isl_core_latency *lat);
+
+#endif
@@ -0,0 +1,341 @@
+/******************************************************************************
+        File            : isl_iio.c
+
+        Description     : IIO front end shared by the ISL sensor drivers.
+                          Scans are pushed into a kfifo backed triggered
+                          buffer with a timestamp taken when the trigger
+                          fires, either from an hrtimer owned by the part
+                          or from the part's interrupt line.
+                          Written against the IIO API of the 3.7 kernels
+                          the drivers build on (__devinit probes): no devm
+                          IIO helpers, no claim_direct_mode, and buffers
+                          that are read() through the character device.
+
+        Build           : A module of its own next to isl_core, selected
+                          by the drivers with IIO channels. See Kconfig
+                          and Makefile.
+
+        License         : GPLv2
+
+        Copyright       : Intersil Corporation (c) 2014
+*******************************************************************************/
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/i2c.h>
+#include <linux/err.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/trigger.h>
+#include <linux/iio/trigger_consumer.h>
+#include <linux/iio/triggered_buffer.h>
+#include <linux/input/isl_iio.h>
+
+struct isl_iio {
+	struct i2c_client *client;
+	const struct isl_iio_desc *desc;
+	struct iio_trigger *timer_trig;
+	struct iio_trigger *irq_trig;
+	struct hrtimer timer;
+	ktime_t period;
+	/* one scan as pushed to the buffer, the timestamp 8-byte aligned */
+	u8 scan[ALIGN(ISL_IIO_MAX_CHANNELS * sizeof(u16), sizeof(s64)) +
+			sizeof(s64)] __aligned(8);
+};
+
+/*
+ * @fn          isl_iio_trigger_handler
+ *
+ * @brief       Bottom half of both triggers. Reads one sample and pushes
+ *              the enabled channels with the time the trigger fired.
+ *
+ * @return      IRQ_HANDLED
+ */
+static irqreturn_t isl_iio_trigger_handler(int irq, void *p)
+{
+	struct iio_poll_func *pf = p;
+	struct iio_dev *indio_dev = pf->indio_dev;
+	struct isl_iio *iio = iio_priv(indio_dev);
+	unsigned int num = iio->desc->num_channels - 1;
+	u16 *chans = (u16 *)iio->scan;
+	u16 vals[ISL_IIO_MAX_CHANNELS];
+	int bit, i = 0;
+
+	if (iio->desc->read_sample(iio->client, vals) < 0)
+		goto done;
+
+	for_each_set_bit(bit, indio_dev->active_scan_mask, num)
+		chans[i++] = vals[bit];
+	if (indio_dev->scan_timestamp)
+		*(s64 *)(iio->scan + ALIGN(i * sizeof(u16), sizeof(s64))) =
+							pf->timestamp;
+	iio_push_to_buffer(indio_dev->buffer, iio->scan);
+done:
+	iio_trigger_notify_done(indio_dev->trig);
+	return IRQ_HANDLED;
+}
+
+static int isl_iio_read_raw(struct iio_dev *indio_dev,
+				struct iio_chan_spec const *chan,
+				int *val, int *val2, long mask)
+{
+	struct isl_iio *iio = iio_priv(indio_dev);
+	u16 vals[ISL_IIO_MAX_CHANNELS];
+	u64 uhz;
+	u32 rem;
+	int ret;
+
+	switch (mask) {
+	case IIO_CHAN_INFO_RAW:
+		/* the bus belongs to the trigger while buffering */
+		mutex_lock(&indio_dev->mlock);
+		if (iio_buffer_enabled(indio_dev))
+			ret = -EBUSY;
+		else
+			ret = iio->desc->read_sample(iio->client, vals);
+		mutex_unlock(&indio_dev->mlock);
+		if (ret < 0)
+			return ret;
+		*val = vals[chan->scan_index];
+		return IIO_VAL_INT;
+	case IIO_CHAN_INFO_SAMP_FREQ:
+		uhz = div64_u64(NSEC_PER_SEC * (u64)USEC_PER_SEC,
+					ktime_to_ns(iio->period));
+		*val = div_u64_rem(uhz, USEC_PER_SEC, &rem);
+		*val2 = rem;
+		return IIO_VAL_INT_PLUS_MICRO;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int isl_iio_write_raw(struct iio_dev *indio_dev,
+				struct iio_chan_spec const *chan,
+				int val, int val2, long mask)
+{
+	struct isl_iio *iio = iio_priv(indio_dev);
+	u64 uhz, ns;
+
+	if (mask != IIO_CHAN_INFO_SAMP_FREQ)
+		return -EINVAL;
+	if (val < 0 || val2 < 0)
+		return -EINVAL;
+
+	uhz = (u64)val * USEC_PER_SEC + val2;
+	if (!uhz)
+		return -EINVAL;
+	ns = div64_u64(NSEC_PER_SEC * (u64)USEC_PER_SEC, uhz);
+	if (!ns)
+		return -EINVAL;
+
+	/* a running timer picks the new period up when it next fires */
+	iio->period = ns_to_ktime(ns);
+	return 0;
+}
+
+static const struct iio_info isl_iio_info = {
+	.driver_module	= THIS_MODULE,
+	.read_raw	= isl_iio_read_raw,
+	.write_raw	= isl_iio_write_raw,
+};
+
+static enum hrtimer_restart isl_iio_timer_fn(struct hrtimer *timer)
+{
+	struct isl_iio *iio = container_of(timer, struct isl_iio, timer);
+
+	hrtimer_forward_now(timer, iio->period);
+	iio_trigger_poll(iio->timer_trig, iio_get_time_ns());
+	return HRTIMER_RESTART;
+}
+
+static int isl_iio_timer_set_state(struct iio_trigger *trig, bool state)
+{
+	struct isl_iio *iio = trig->private_data;
+
+	if (state)
+		hrtimer_start(&iio->timer, iio->period, HRTIMER_MODE_REL);
+	else
+		hrtimer_cancel(&iio->timer);
+	return 0;
+}
+
+static const struct iio_trigger_ops isl_iio_timer_ops = {
+	.owner			= THIS_MODULE,
+	.set_trigger_state	= isl_iio_timer_set_state,
+};
+
+/* the interrupt trigger is fired by the driver, nothing to switch */
+static const struct iio_trigger_ops isl_iio_irq_ops = {
+	.owner			= THIS_MODULE,
+};
+
+static struct iio_trigger *isl_iio_trigger(struct i2c_client *client,
+				struct iio_dev *indio_dev, const char *kind,
+				const struct iio_trigger_ops *ops)
+{
+	struct iio_trigger *trig;
+	int ret;
+
+	trig = iio_trigger_alloc("%s-%s%d", indio_dev->name, kind,
+					indio_dev->id);
+	if (!trig)
+		return ERR_PTR(-ENOMEM);
+	trig->dev.parent = &client->dev;
+	trig->ops = ops;
+	trig->private_data = iio_priv(indio_dev);
+
+	ret = iio_trigger_register(trig);
+	if (ret < 0) {
+		iio_trigger_free(trig);
+		return ERR_PTR(ret);
+	}
+	return trig;
+}
+
+static void isl_iio_trigger_remove(struct iio_trigger *trig)
+{
+	if (!trig)
+		return;
+	iio_trigger_unregister(trig);
+	iio_trigger_free(trig);
+}
+
+/*
+ * @fn          isl_iio_init
+ *
+ * @brief       Registers the IIO device of a part with a triggered
+ *              buffer, its hrtimer trigger (the default) and, with
+ *              irq_trigger, a trigger fired through isl_iio_irq().
+ *              The driver releases it all with isl_iio_remove().
+ *
+ * @return      Returns the IIO device on success otherwise an ERR_PTR
+ */
+struct iio_dev *isl_iio_init(struct i2c_client *client,
+				const struct isl_iio_desc *desc,
+				bool irq_trigger)
+{
+	struct iio_dev *indio_dev;
+	struct isl_iio *iio;
+	int ret;
+
+	if (desc->num_channels < 2 ||
+			desc->num_channels - 1 > ISL_IIO_MAX_CHANNELS)
+		return ERR_PTR(-EINVAL);
+
+	indio_dev = iio_device_alloc(sizeof(*iio));
+	if (!indio_dev)
+		return ERR_PTR(-ENOMEM);
+
+	iio = iio_priv(indio_dev);
+	iio->client = client;
+	iio->desc = desc;
+	iio->period = ms_to_ktime(desc->default_period_ms);
+	hrtimer_init(&iio->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	iio->timer.function = isl_iio_timer_fn;
+
+	indio_dev->dev.parent = &client->dev;
+	indio_dev->name = desc->name;
+	indio_dev->channels = desc->channels;
+	indio_dev->num_channels = desc->num_channels;
+	indio_dev->info = &isl_iio_info;
+	indio_dev->modes = INDIO_DIRECT_MODE;
+
+	iio->timer_trig = isl_iio_trigger(client, indio_dev, "hrtimer",
+						&isl_iio_timer_ops);
+	if (IS_ERR(iio->timer_trig)) {
+		ret = PTR_ERR(iio->timer_trig);
+		iio->timer_trig = NULL;
+		goto err_free;
+	}
+
+	if (irq_trigger) {
+		iio->irq_trig = isl_iio_trigger(client, indio_dev, "dev",
+							&isl_iio_irq_ops);
+		if (IS_ERR(iio->irq_trig)) {
+			ret = PTR_ERR(iio->irq_trig);
+			iio->irq_trig = NULL;
+			goto err_trig;
+		}
+	}
+
+	/* the top half stamps each scan as the trigger fires */
+	ret = iio_triggered_buffer_setup(indio_dev, iio_pollfunc_store_time,
+					isl_iio_trigger_handler, NULL);
+	if (ret < 0)
+		goto err_trig;
+
+	/* the hrtimer trigger works without any interrupt wiring */
+	indio_dev->trig = iio->timer_trig;
+
+	ret = iio_device_register(indio_dev);
+	if (ret < 0)
+		goto err_buffer;
+	return indio_dev;
+
+err_buffer:
+	indio_dev->trig = NULL;
+	iio_triggered_buffer_cleanup(indio_dev);
+err_trig:
+	isl_iio_trigger_remove(iio->irq_trig);
+	isl_iio_trigger_remove(iio->timer_trig);
+err_free:
+	iio_device_free(indio_dev);
+	return ERR_PTR(ret);
+}
+EXPORT_SYMBOL(isl_iio_init);
+
+/*
+ * @fn          isl_iio_remove
+ *
+ * @brief       Unregisters the IIO device of a part and frees its buffer
+ *              and triggers. Call from the driver's remove once its
+ *              interrupt is freed. Does nothing without an IIO device.
+ *
+ * @return      void
+ */
+void isl_iio_remove(struct iio_dev *indio_dev)
+{
+	struct isl_iio *iio;
+
+	if (!indio_dev)
+		return;
+	iio = iio_priv(indio_dev);
+
+	iio_device_unregister(indio_dev);
+	/* a buffer may still be running, these kernels leave it be */
+	hrtimer_cancel(&iio->timer);
+	indio_dev->trig = NULL;
+	iio_triggered_buffer_cleanup(indio_dev);
+	isl_iio_trigger_remove(iio->irq_trig);
+	isl_iio_trigger_remove(iio->timer_trig);
+	iio_device_free(indio_dev);
+}
+EXPORT_SYMBOL(isl_iio_remove);
+
+/*
+ * @fn          isl_iio_irq
+ *
+ * @brief       Fires the interrupt trigger of a part. Call from the hard
+ *              interrupt handler so the scan timestamp is the interrupt
+ *              time. Does nothing without an IIO device.
+ *
+ * @return      void
+ */
+void isl_iio_irq(struct iio_dev *indio_dev)
+{
+	struct isl_iio *iio;
+
+	if (!indio_dev)
+		return;
+	iio = iio_priv(indio_dev);
+	if (iio->irq_trig)
+		iio_trigger_poll(iio->irq_trig, iio_get_time_ns());
+}
+EXPORT_SYMBOL(isl_iio_irq);
+
+MODULE_AUTHOR("Intersil Corporation");
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("IIO front end shared by the ISL sensor drivers");
@@ -0,0 +1,56 @@
+/******************************************************************************
+        File            : isl_iio.h
+
+        Description     : IIO front end shared by the ISL sensor drivers
+
+        License         : GPLv2
+
+        Copyright       : Intersil Corporation (c) 2014
+*******************************************************************************/
+
+#ifndef _ISL_IIO_H_
+#define _ISL_IIO_H_
+
+#include <linux/i2c.h>
+#include <linux/iio/iio.h>
+
+/* data channels of one scan, the timestamp not counted */
+#define ISL_IIO_MAX_CHANNELS	4
+
+/*
+ * IIO view of one part.
+ *
+ * channels ends with an IIO_CHAN_SOFT_TIMESTAMP. The scan_index of every
+ * other channel is its position in the array filled by read_sample(),
+ * which should fetch the whole sample in one bus burst. Enabling the
+ * conversions stays with the part's own controls.
+ *
+ * Light is IIO_LIGHT, the colours and IR are IIO_INTENSITY with a
+ * modifier, proximity IIO_PROXIMITY. None of the parts has a clear
+ * (unfiltered) photodiode, so no part lists IIO_MOD_LIGHT_CLEAR.
+ */
+struct isl_iio_desc {
+	const char *name;
+	const struct iio_chan_spec *channels;
+	unsigned int num_channels;
+	unsigned int default_period_ms;
+	int (*read_sample)(struct i2c_client *client, u16 *vals);
+};
+
+#define ISL_IIO_CHANNEL(_type, _mod, _index, _bits) {			\
+	.type = (_type),						\
+	.modified = ((_mod) != 0),					\
+	.channel2 = (_mod),						\
+	.info_mask = IIO_CHAN_INFO_RAW_SEPARATE_BIT |			\
+		IIO_CHAN_INFO_SAMP_FREQ_SHARED_BIT,			\
+	.scan_index = (_index),						\
+	.scan_type = IIO_ST('u', (_bits), 16, 0),			\
+}
+
+struct iio_dev *isl_iio_init(struct i2c_client *client,
+				const struct isl_iio_desc *desc,
+				bool irq_trigger);
+void isl_iio_remove(struct iio_dev *indio_dev);
+void isl_iio_irq(struct iio_dev *indio_dev);
+
+#endif